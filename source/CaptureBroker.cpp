@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CaptureBroker.h"
+#include "PickerScheduler.h"
+#include "gtk/Zoomed.h"
+#include <algorithm>
+#include <vector>
+
+using namespace math;
+using namespace std;
+
+struct CaptureConsumer{
+	struct CaptureBroker *broker;
+	CaptureThreadFrameCallback callback;
+	void *data;
+	bool active;
+	float refresh_rate;
+	bool zoomed_enabled;
+	CaptureZoomedView zoomed;
+};
+
+struct CaptureBroker{
+	struct ScreenReader *screen_reader;
+	struct Sampler *sampler;
+	PickerScheduler *scheduler; /**< Main loop timer, used when capture thread is not supported */
+	CaptureThread *thread;
+	bool thread_checked; /**< Capture thread creation was attempted. Done on first start, as it needs a display */
+	vector<CaptureConsumer*> consumers;
+	float refresh_rate; /**< Refresh rate of running capture. Zero when stopped */
+	uint64_t sequence;
+	CaptureBrokerStatistics statistics;
+};
+
+static void capture_broker_deliver(const CaptureFrame *frame, CaptureBroker *broker)
+{
+	broker->statistics.frames++;
+	for (auto consumer: broker->consumers){
+		if (!consumer->active) continue;
+		broker->statistics.deliveries++;
+		consumer->callback(frame, consumer->data);
+	}
+}
+
+/**
+ * Capture sampler area and zoomed view areas of given consumers in main loop.
+ * @return False if capture failed or frame did not change since the previous one.
+ */
+static bool capture_broker_read(CaptureBroker *broker, const vector<CaptureConsumer*> &consumers, PickerScheduler *scheduler, CaptureFrame *frame)
+{
+	GdkScreen *screen;
+	GdkModifierType state;
+	int x, y;
+	gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
+	int monitor = gdk_screen_get_monitor_at_point(screen, x, y);
+	GdkRectangle monitor_geometry;
+	gdk_screen_get_monitor_geometry(screen, monitor, &monitor_geometry);
+	Vec2<int> pointer(x, y);
+	Rect2<int> screen_rect(monitor_geometry.x, monitor_geometry.y, monitor_geometry.x + monitor_geometry.width, monitor_geometry.y + monitor_geometry.height);
+	Rect2<int> sampler_rect, zoomed_rect, final_rect;
+	screen_reader_reset_rect(broker->screen_reader);
+	screen_reader_set_screen_rect(broker->screen_reader, screen_rect);
+	sampler_get_screen_rect(broker->sampler, pointer, screen_rect, &sampler_rect);
+	screen_reader_add_rect(broker->screen_reader, screen, sampler_rect);
+	for (auto consumer: consumers){
+		Rect2<int> view_rect;
+		gtk_zoomed_calculate_screen_rect(consumer->zoomed.width_height, consumer->zoomed.zoom, pointer, screen_rect, &view_rect);
+		zoomed_rect += view_rect;
+	}
+	if (!zoomed_rect.isEmpty())
+		screen_reader_add_rect(broker->screen_reader, screen, zoomed_rect);
+	uint32_t generation = screen_reader_get_generation(broker->screen_reader);
+	screen_reader_update_pixbuf(broker->screen_reader, &final_rect);
+	if (screen_reader_get_generation(broker->screen_reader) == generation)
+		return false;
+	if (scheduler && !picker_scheduler_update(scheduler, pointer, screen_reader_get_hash(broker->screen_reader)))
+		return false;
+	frame->sequence = ++broker->sequence;
+	frame->capture_time = g_get_monotonic_time();
+	frame->pointer = pointer;
+	frame->screen_rect = screen_rect;
+	Vec2<int> offset(sampler_rect.getX() - final_rect.getX(), sampler_rect.getY() - final_rect.getY());
+	sampler_get_color_sample(broker->sampler, pointer, screen_rect, offset, &frame->color);
+	// screen reader pixbuf starts at the top left corner of the captured area, so it can be passed as is
+	frame->zoomed_rect = zoomed_rect.isEmpty() ? Rect2<int>() : final_rect;
+	frame->zoomed = screen_reader_get_pixbuf(broker->screen_reader);
+	return true;
+}
+
+static vector<CaptureConsumer*> capture_broker_get_zoomed_consumers(CaptureBroker *broker)
+{
+	vector<CaptureConsumer*> consumers;
+	for (auto consumer: broker->consumers){
+		if (consumer->active && consumer->zoomed_enabled)
+			consumers.push_back(consumer);
+	}
+	return consumers;
+}
+
+static void capture_broker_tick(PickerScheduler *scheduler, CaptureBroker *broker)
+{
+	CaptureFrame frame;
+	if (!capture_broker_read(broker, capture_broker_get_zoomed_consumers(broker), scheduler, &frame))
+		return;
+	capture_broker_deliver(&frame, broker);
+}
+
+/**
+ * Start, stop or update running capture after consumer changes.
+ */
+static void capture_broker_update(CaptureBroker *broker)
+{
+	float refresh_rate = 0;
+	for (auto consumer: broker->consumers){
+		if (consumer->active)
+			refresh_rate = std::max(refresh_rate, consumer->refresh_rate);
+	}
+	if (refresh_rate <= 0){
+		if (broker->thread)
+			capture_thread_stop(broker->thread);
+		picker_scheduler_stop(broker->scheduler);
+		broker->refresh_rate = 0;
+		return;
+	}
+	if (!broker->thread_checked){
+		broker->thread = capture_thread_new(gdk_screen_get_default(), (CaptureThreadFrameCallback)capture_broker_deliver, broker);
+		broker->thread_checked = true;
+	}
+	if (broker->thread){
+		vector<CaptureZoomedView> views;
+		for (auto consumer: capture_broker_get_zoomed_consumers(broker))
+			views.push_back(consumer->zoomed);
+		capture_thread_set_zoomed(broker->thread, views.data(), views.size());
+		if (broker->refresh_rate != refresh_rate){
+			capture_thread_set_sampler(broker->thread, sampler_get_oversample(broker->sampler), sampler_get_falloff(broker->sampler));
+			capture_thread_start(broker->thread, refresh_rate);
+		}
+	}else{
+		if (broker->refresh_rate != refresh_rate)
+			picker_scheduler_start(broker->scheduler, refresh_rate);
+		else
+			picker_scheduler_wake(broker->scheduler);
+	}
+	broker->refresh_rate = refresh_rate;
+}
+
+struct CaptureBroker* capture_broker_new(struct ScreenReader *screen_reader, struct Sampler *sampler)
+{
+	CaptureBroker *broker = new CaptureBroker;
+	broker->screen_reader = screen_reader;
+	broker->sampler = sampler;
+	broker->scheduler = picker_scheduler_new((PickerSchedulerTick)capture_broker_tick, broker);
+	broker->thread = nullptr;
+	broker->thread_checked = false;
+	broker->refresh_rate = 0;
+	broker->sequence = 0;
+	broker->statistics = CaptureBrokerStatistics();
+	return broker;
+}
+
+struct CaptureConsumer* capture_broker_add_consumer(struct CaptureBroker *broker, CaptureThreadFrameCallback callback, void *data)
+{
+	CaptureConsumer *consumer = new CaptureConsumer;
+	consumer->broker = broker;
+	consumer->callback = callback;
+	consumer->data = data;
+	consumer->active = false;
+	consumer->refresh_rate = 0;
+	consumer->zoomed_enabled = false;
+	consumer->zoomed.zoom = 0;
+	consumer->zoomed.width_height = 0;
+	broker->consumers.push_back(consumer);
+	return consumer;
+}
+
+void capture_broker_set_zoomed(struct CaptureConsumer *consumer, bool enabled, float zoom, int32_t width_height)
+{
+	consumer->zoomed_enabled = enabled;
+	consumer->zoomed.zoom = zoom;
+	consumer->zoomed.width_height = width_height;
+	if (consumer->active)
+		capture_broker_update(consumer->broker);
+}
+
+void capture_broker_start(struct CaptureConsumer *consumer, float refresh_rate)
+{
+	consumer->active = true;
+	consumer->refresh_rate = refresh_rate;
+	capture_broker_update(consumer->broker);
+}
+
+void capture_broker_stop(struct CaptureConsumer *consumer)
+{
+	if (!consumer->active) return;
+	consumer->active = false;
+	capture_broker_update(consumer->broker);
+}
+
+void capture_broker_wake(struct CaptureBroker *broker)
+{
+	if (broker->thread)
+		capture_thread_wake(broker->thread);
+	picker_scheduler_wake(broker->scheduler);
+}
+
+void capture_broker_update_sampler(struct CaptureBroker *broker)
+{
+	if (broker->thread)
+		capture_thread_set_sampler(broker->thread, sampler_get_oversample(broker->sampler), sampler_get_falloff(broker->sampler));
+	picker_scheduler_wake(broker->scheduler);
+}
+
+bool capture_broker_capture(struct CaptureConsumer *consumer, bool zoomed, CaptureFrame *frame)
+{
+	CaptureBroker *broker = consumer->broker;
+	broker->statistics.captures++;
+	vector<CaptureConsumer*> consumers;
+	if (zoomed)
+		consumers.push_back(consumer);
+	return capture_broker_read(broker, consumers, nullptr, frame);
+}
+
+void capture_broker_remove_consumer(struct CaptureConsumer *consumer)
+{
+	CaptureBroker *broker = consumer->broker;
+	capture_broker_stop(consumer);
+	broker->consumers.erase(std::remove(broker->consumers.begin(), broker->consumers.end(), consumer), broker->consumers.end());
+	delete consumer;
+}
+
+void capture_broker_get_statistics(struct CaptureBroker *broker, CaptureBrokerStatistics *statistics)
+{
+	*statistics = broker->statistics;
+}
+
+void capture_broker_destroy(struct CaptureBroker *broker)
+{
+	if (broker->thread)
+		capture_thread_destroy(broker->thread);
+	picker_scheduler_destroy(broker->scheduler);
+	delete broker;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_CAPTURE_BROKER_H_
+#define GPICK_CAPTURE_BROKER_H_
+
+#include "CaptureThread.h"
+#include "ScreenReader.h"
+#include "Sampler.h"
+#include <stdint.h>
+
+/** \file source/CaptureBroker.h
+ * \brief Shared screen capture for all pickers.
+ *
+ * Each picker registers as a consumer. While any consumer is active, broker captures the union of sampler area and areas of all
+ * zoomed views once per frame and delivers the same frame to every active consumer. Capture runs in a capture thread when it is
+ * supported, otherwise in main loop with a single timer.
+ */
+
+struct CaptureBroker;
+struct CaptureConsumer;
+
+/** \struct CaptureBrokerStatistics
+ * \brief Capture broker frame counters.
+ */
+typedef struct CaptureBrokerStatistics{
+	uint64_t frames; /**< Frames captured for active consumers */
+	uint64_t deliveries; /**< Frames delivered to consumers. Exceeds frames when several consumers share captures */
+	uint64_t captures; /**< Synchronous captures requested by consumers */
+}CaptureBrokerStatistics;
+
+/**
+ * Create capture broker.
+ * @param[in] screen_reader Screen reader used for captures in main loop.
+ * @param[in] sampler Sampler used for captures in main loop. Its settings are copied into capture thread.
+ * @return New capture broker.
+ */
+struct CaptureBroker* capture_broker_new(struct ScreenReader *screen_reader, struct Sampler *sampler);
+
+/**
+ * Register capture consumer. Consumer is inactive until capture_broker_start is called.
+ * @param[in] broker Capture broker.
+ * @param[in] callback Function called in main loop for each frame. Must not add or remove consumers.
+ * @param[in] data User data passed to callback.
+ * @return New capture consumer.
+ */
+struct CaptureConsumer* capture_broker_add_consumer(struct CaptureBroker *broker, CaptureThreadFrameCallback callback, void *data);
+
+/**
+ * Set zoomed view of a consumer. Frames contain pixels of zoomed view area while zoomed view is enabled.
+ * @param[in] consumer Capture consumer.
+ * @param[in] enabled Enable zoomed view.
+ * @param[in] zoom Zoom level.
+ * @param[in] width_height Zoomed view size.
+ */
+void capture_broker_set_zoomed(struct CaptureConsumer *consumer, bool enabled, float zoom, int32_t width_height);
+
+/**
+ * Start delivering frames to consumer. Broker captures at the highest refresh rate of active consumers.
+ * @param[in] consumer Capture consumer.
+ * @param[in] refresh_rate Refresh rate in frames per second.
+ */
+void capture_broker_start(struct CaptureConsumer *consumer, float refresh_rate);
+
+/**
+ * Stop delivering frames to consumer. Capture stops when no consumers are active.
+ * @param[in] consumer Capture consumer.
+ */
+void capture_broker_stop(struct CaptureConsumer *consumer);
+
+/**
+ * Force delivery of the next frame and return to full refresh rate.
+ * @param[in] broker Capture broker.
+ */
+void capture_broker_wake(struct CaptureBroker *broker);
+
+/**
+ * Apply changed sampler settings to capture thread.
+ * @param[in] broker Capture broker.
+ */
+void capture_broker_update_sampler(struct CaptureBroker *broker);
+
+/**
+ * Capture immediately in main loop. Frame is not delivered to any consumer.
+ * @param[in] consumer Capture consumer.
+ * @param[in] zoomed Capture consumer zoomed view area too.
+ * @param[out] frame Captured frame. Zoomed pixels stay valid until the next capture.
+ * @return True on success.
+ */
+bool capture_broker_capture(struct CaptureConsumer *consumer, bool zoomed, CaptureFrame *frame);
+
+/**
+ * Stop and unregister capture consumer.
+ * @param[in] consumer Capture consumer.
+ */
+void capture_broker_remove_consumer(struct CaptureConsumer *consumer);
+
+/**
+ * Get frame counters.
+ * @param[in] broker Capture broker.
+ * @param[out] statistics Frame counters.
+ */
+void capture_broker_get_statistics(struct CaptureBroker *broker, CaptureBrokerStatistics *statistics);
+
+/**
+ * Destroy capture broker. All consumers must be removed before.
+ * @param[in] broker Capture broker.
+ */
+void capture_broker_destroy(struct CaptureBroker *broker);
+
+#endif /* GPICK_CAPTURE_BROKER_H_ */
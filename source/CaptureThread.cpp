@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CaptureThread.h"
+#include "ScreenReader.h"
+#include "ScreenSource.h"
+#include "PickerScheduler.h"
+#include "TripleBuffer.h"
+#include "gtk/Zoomed.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef HAVE_X11
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#endif
+#ifdef HAVE_XSHM
+#include "ScreenSourceShm.h"
+#endif
+
+using namespace math;
+using namespace std;
+
+#ifdef HAVE_X11
+/** \struct CaptureThreadSource
+ * \brief Screen source, which reads root window through display connection owned by capture thread.
+ */
+typedef struct CaptureThreadSource{
+	ScreenSource source;
+	Display *display;
+	int screen;
+	Window root;
+	int error_code; /**< Code of the last X error of display connection */
+#ifdef HAVE_XSHM
+	ScreenSourceShm shm;
+#endif
+}CaptureThreadSource;
+/** Source, whose display connection is used by the current thread. X errors of that connection are recorded instead of being passed to GDK error handler, which ends the program */
+static thread_local CaptureThreadSource *capture_thread_current_source = nullptr;
+static XErrorHandler capture_thread_previous_error_handler = nullptr;
+static int capture_thread_error_handler(Display *display, XErrorEvent *event)
+{
+	CaptureThreadSource *source = capture_thread_current_source;
+	if (source && source->display == display){
+		source->error_code = event->error_code;
+		return 0;
+	}
+	if (capture_thread_previous_error_handler)
+		return capture_thread_previous_error_handler(display, event);
+	return 0;
+}
+static bool capture_thread_source_is_supported_image(const XImage *image)
+{
+	const uint32_t byte_order_probe = 1;
+	int native_byte_order = (*reinterpret_cast<const uint8_t*>(&byte_order_probe) == 1) ? LSBFirst : MSBFirst;
+	return image->bits_per_pixel == 32 && image->byte_order == native_byte_order && image->red_mask == 0xff0000 && image->green_mask == 0xff00 && image->blue_mask == 0xff;
+}
+static bool capture_thread_source_read(ScreenSource *screen_source, GdkScreen *screen, int left, int top, int width, int height, GdkPixbuf *pixbuf)
+{
+	CaptureThreadSource *source = reinterpret_cast<CaptureThreadSource*>(screen_source);
+	guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
+	int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+	// X server fails to read areas outside of the root window, so only the visible part is read and the rest is black. Root window
+	// size is queried before each read, as screen can be resized at any time. If it shrinks after the query, read fails with an X error
+	// recorded by capture_thread_error_handler, and the frame is dropped
+	Window root;
+	int root_x, root_y;
+	unsigned int root_width, root_height, border_width, depth;
+	if (!XGetGeometry(source->display, source->root, &root, &root_x, &root_y, &root_width, &root_height, &border_width, &depth)) return false;
+	int copy_left = std::max(left, 0), copy_top = std::max(top, 0);
+	int copy_right = std::min(left + width, int(root_width)), copy_bottom = std::min(top + height, int(root_height));
+	if (copy_left != left || copy_top != top || copy_right != left + width || copy_bottom != top + height){
+		for (int y = 0; y < height; y++)
+			memset(pixels + y * rowstride, 0, width * 3);
+	}
+	if (copy_left >= copy_right || copy_top >= copy_bottom) return true;
+#ifdef HAVE_XSHM
+	if (screen_source_shm_read(&source->shm, source->display, source->root, DefaultVisual(source->display, source->screen), DefaultDepth(source->display, source->screen), copy_left, copy_top, copy_right - copy_left, copy_bottom - copy_top, pixbuf, copy_left - left, copy_top - top))
+		return true;
+#endif
+	XImage *image = XGetImage(source->display, source->root, copy_left, copy_top, copy_right - copy_left, copy_bottom - copy_top, AllPlanes, ZPixmap);
+	if (!image) return false;
+	for (int y = 0; y < copy_bottom - copy_top; y++){
+		const uint32_t *row = reinterpret_cast<const uint32_t*>(image->data + y * image->bytes_per_line);
+		guchar *destination = pixels + (copy_top - top + y) * rowstride + (copy_left - left) * 3;
+		for (int x = 0; x < copy_right - copy_left; x++){
+			uint32_t pixel = row[x];
+			destination[0] = pixel >> 16;
+			destination[1] = pixel >> 8;
+			destination[2] = pixel;
+			destination += 3;
+		}
+	}
+	XDestroyImage(image);
+	return true;
+}
+static void capture_thread_source_destroy(ScreenSource *screen_source)
+{
+	CaptureThreadSource *source = reinterpret_cast<CaptureThreadSource*>(screen_source);
+	capture_thread_current_source = source;
+#ifdef HAVE_XSHM
+	screen_source_shm_release(&source->shm);
+#endif
+	XCloseDisplay(source->display);
+	capture_thread_current_source = nullptr;
+	delete source;
+}
+/**
+ * Open a separate display connection for capture thread. Xlib connections must not be shared between threads without locking, and GDK connection is used by main loop.
+ * @return New screen source or nullptr if root window can not be read as 32-bit RGB.
+ */
+static CaptureThreadSource* capture_thread_source_new(GdkScreen *screen)
+{
+	Display *display = XOpenDisplay(gdk_display_get_name(gdk_screen_get_display(screen)));
+	if (!display) return nullptr;
+	// error handler is process wide, so it is installed once and passes errors of other connections to GDK error handler
+	static bool error_handler_installed = false;
+	if (!error_handler_installed){
+		capture_thread_previous_error_handler = XSetErrorHandler(capture_thread_error_handler);
+		error_handler_installed = true;
+	}
+	int screen_number = gdk_screen_get_number(screen);
+	CaptureThreadSource *source = new CaptureThreadSource;
+	source->source.read = capture_thread_source_read;
+	source->source.destroy = capture_thread_source_destroy;
+	source->display = display;
+	source->screen = screen_number;
+	source->root = RootWindow(display, screen_number);
+	source->error_code = Success;
+	capture_thread_current_source = source;
+	XImage *probe = XGetImage(display, source->root, 0, 0, 1, 1, AllPlanes, ZPixmap);
+	bool supported = probe && capture_thread_source_is_supported_image(probe);
+	if (probe) XDestroyImage(probe);
+#ifdef HAVE_XSHM
+	// GPICK_SCREEN_READER=gdk disables MIT-SHM here too, so capture thread reads with XGetImage. Probe read attaches the segment,
+	// so that MIT-SHM is disabled before capture thread starts if it does not work
+	screen_source_shm_init(&source->shm, false);
+	source->shm.error_code = &source->error_code;
+	const char *backend = getenv("GPICK_SCREEN_READER");
+	source->shm.disabled = backend && strcmp(backend, "gdk") == 0;
+	if (supported){
+		GdkPixbuf *probe_pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, 1, 1);
+		screen_source_shm_read(&source->shm, display, source->root, DefaultVisual(display, screen_number), DefaultDepth(display, screen_number), 0, 0, 1, 1, probe_pixbuf, 0, 0);
+		g_object_unref(probe_pixbuf);
+	}
+#endif
+	capture_thread_current_source = nullptr;
+	if (!supported){
+		capture_thread_source_destroy(&source->source);
+		return nullptr;
+	}
+	return source;
+}
+#endif
+
+/** \struct CaptureThreadSettings
+ * \brief Parameters set by main loop and read by capture thread.
+ */
+typedef struct CaptureThreadSettings{
+	int oversample;
+	enum SamplerFalloff falloff;
+	vector<CaptureZoomedView> zoomed_views;
+	vector<Rect2<int>> monitors;
+}CaptureThreadSettings;
+
+struct CaptureThread{
+	CaptureThreadFrameCallback callback;
+	void *data;
+	GdkScreen *screen;
+#ifdef HAVE_X11
+	CaptureThreadSource *source; /**< Owned by screen_reader */
+#endif
+	ScreenReader *screen_reader;
+	Sampler *sampler;
+	PickerScheduler *scheduler;
+	TripleBuffer<CaptureFrame> frames;
+	uint64_t sequence;
+	thread worker;
+	mutex settings_mutex;
+	condition_variable condition;
+	CaptureThreadSettings settings; /**< Protected by settings_mutex */
+	bool settings_changed; /**< Protected by settings_mutex */
+	bool running; /**< Protected by settings_mutex */
+	bool wake; /**< Protected by settings_mutex */
+	atomic<bool> deliver_pending;
+	int64_t interval; /**< Refresh interval in microseconds */
+	atomic<uint64_t> captured, skipped, published, dropped;
+	uint64_t delivered, late;
+};
+
+static gboolean capture_thread_deliver(CaptureThread *thread)
+{
+	thread->deliver_pending = false;
+	if (!thread->frames.update()) return false;
+	const CaptureFrame &frame = thread->frames.front();
+	thread->delivered++;
+	if (g_get_monotonic_time() - frame.capture_time > thread->interval)
+		thread->late++;
+	thread->callback(&frame, thread->data);
+	return false;
+}
+
+static Rect2<int> capture_thread_get_screen_rect(const CaptureThreadSettings &settings, const Vec2<int> &pointer)
+{
+	for (auto &monitor: settings.monitors){
+		if (pointer.x >= monitor.getLeft() && pointer.x < monitor.getRight() && pointer.y >= monitor.getTop() && pointer.y < monitor.getBottom())
+			return monitor;
+	}
+	return settings.monitors.empty() ? Rect2<int>(0, 0, 1, 1) : settings.monitors.front();
+}
+
+static void capture_thread_capture(CaptureThread *thread, const CaptureThreadSettings &settings)
+{
+#ifdef HAVE_X11
+	CaptureThreadSource *source = thread->source;
+	Window root, child;
+	int x, y, window_x, window_y;
+	unsigned int mask;
+	if (!XQueryPointer(source->display, source->root, &root, &child, &x, &y, &window_x, &window_y, &mask))
+		return; // pointer is on another screen
+	Vec2<int> pointer(x, y);
+	Rect2<int> screen_rect = capture_thread_get_screen_rect(settings, pointer);
+	Rect2<int> sampler_rect, zoomed_rect, final_rect;
+	screen_reader_reset_rect(thread->screen_reader);
+	screen_reader_set_screen_rect(thread->screen_reader, screen_rect);
+	sampler_get_screen_rect(thread->sampler, pointer, screen_rect, &sampler_rect);
+	screen_reader_add_rect(thread->screen_reader, nullptr, sampler_rect);
+	for (auto &view: settings.zoomed_views){
+		Rect2<int> view_rect;
+		gtk_zoomed_calculate_screen_rect(view.width_height, view.zoom, pointer, screen_rect, &view_rect);
+		zoomed_rect += view_rect;
+	}
+	if (!zoomed_rect.isEmpty())
+		screen_reader_add_rect(thread->screen_reader, nullptr, zoomed_rect);
+	uint32_t generation = screen_reader_get_generation(thread->screen_reader);
+	screen_reader_update_pixbuf(thread->screen_reader, &final_rect);
+	if (screen_reader_get_generation(thread->screen_reader) == generation) return;
+	thread->captured++;
+	if (!picker_scheduler_update(thread->scheduler, pointer, screen_reader_get_hash(thread->screen_reader))){
+		thread->skipped++;
+		return;
+	}
+	CaptureFrame &frame = thread->frames.back();
+	frame.sequence = ++thread->sequence;
+	frame.capture_time = g_get_monotonic_time();
+	frame.pointer = pointer;
+	frame.screen_rect = screen_rect;
+	Vec2<int> offset(sampler_rect.getX() - final_rect.getX(), sampler_rect.getY() - final_rect.getY());
+	sampler_get_color_sample(thread->sampler, pointer, screen_rect, offset, &frame.color);
+	if (!zoomed_rect.isEmpty()){
+		int width = zoomed_rect.getWidth(), height = zoomed_rect.getHeight();
+		if (!frame.zoomed || gdk_pixbuf_get_width(frame.zoomed) < width || gdk_pixbuf_get_height(frame.zoomed) < height){
+			if (frame.zoomed) g_object_unref(frame.zoomed);
+			int size = std::max(width, height);
+			frame.zoomed = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, size, size);
+		}
+		GdkPixbuf *pixbuf = screen_reader_get_pixbuf(thread->screen_reader);
+		int rowstride = gdk_pixbuf_get_rowstride(pixbuf), zoomed_rowstride = gdk_pixbuf_get_rowstride(frame.zoomed);
+		const guchar *pixels = gdk_pixbuf_get_pixels(pixbuf) + (zoomed_rect.getY() - final_rect.getY()) * rowstride + (zoomed_rect.getX() - final_rect.getX()) * 3;
+		guchar *zoomed_pixels = gdk_pixbuf_get_pixels(frame.zoomed);
+		for (int y = 0; y < height; y++)
+			memcpy(zoomed_pixels + y * zoomed_rowstride, pixels + y * rowstride, width * 3);
+		frame.zoomed_rect = zoomed_rect;
+	}else{
+		frame.zoomed_rect = Rect2<int>();
+	}
+	if (thread->frames.publish())
+		thread->dropped++;
+	thread->published++;
+	if (!thread->deliver_pending.exchange(true))
+		g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, (GSourceFunc)capture_thread_deliver, thread, (GDestroyNotify)nullptr);
+#endif
+}
+
+static void capture_thread_run(CaptureThread *thread)
+{
+	CaptureThreadSettings settings;
+#ifdef HAVE_X11
+	capture_thread_current_source = thread->source;
+#endif
+	unique_lock<mutex> lock(thread->settings_mutex);
+	while (thread->running){
+		bool wake = thread->wake;
+		thread->wake = false;
+		bool settings_changed = thread->settings_changed;
+		if (settings_changed){
+			settings = thread->settings;
+			thread->settings_changed = false;
+		}
+		lock.unlock();
+		if (settings_changed){
+			sampler_set_oversample(thread->sampler, settings.oversample);
+			sampler_set_falloff(thread->sampler, settings.falloff);
+		}
+		if (wake || settings_changed)
+			picker_scheduler_wake(thread->scheduler);
+		capture_thread_capture(thread, settings);
+		PickerSchedulerStatistics statistics;
+		picker_scheduler_get_statistics(thread->scheduler, &statistics);
+		lock.lock();
+		thread->condition.wait_for(lock, chrono::milliseconds(statistics.interval), [thread]{
+			return !thread->running || thread->wake;
+		});
+	}
+#ifdef HAVE_X11
+	capture_thread_current_source = nullptr;
+#endif
+}
+
+struct CaptureThread* capture_thread_new(GdkScreen *screen, CaptureThreadFrameCallback callback, void *data)
+{
+#ifdef HAVE_X11
+	const char *enabled = getenv("GPICK_CAPTURE_THREAD");
+	if (enabled && strcmp(enabled, "0") == 0) return nullptr;
+	CaptureThreadSource *source = capture_thread_source_new(screen);
+	if (!source) return nullptr;
+	CaptureThread *thread = new CaptureThread;
+	thread->callback = callback;
+	thread->data = data;
+	thread->screen = screen;
+	thread->source = source;
+	thread->screen_reader = screen_reader_new_with_source(&source->source);
+	thread->sampler = sampler_new(thread->screen_reader);
+	thread->scheduler = picker_scheduler_new(nullptr, nullptr);
+	for (int i = 0; i < 3; i++){
+		thread->frames.slot(i).zoomed = nullptr;
+		thread->frames.slot(i).zoomed_rect = Rect2<int>();
+	}
+	thread->sequence = 0;
+	thread->settings.oversample = 0;
+	thread->settings.falloff = NONE;
+	thread->settings_changed = true;
+	thread->running = false;
+	thread->wake = false;
+	thread->deliver_pending = false;
+	thread->interval = 1000000 / 30;
+	thread->captured = thread->skipped = thread->published = thread->dropped = 0;
+	thread->delivered = thread->late = 0;
+	return thread;
+#else
+	return nullptr;
+#endif
+}
+
+void capture_thread_set_sampler(struct CaptureThread *thread, int oversample, enum SamplerFalloff falloff)
+{
+	lock_guard<mutex> lock(thread->settings_mutex);
+	thread->settings.oversample = oversample;
+	thread->settings.falloff = falloff;
+	thread->settings_changed = true;
+	thread->wake = true;
+	thread->condition.notify_one();
+}
+
+void capture_thread_set_zoomed(struct CaptureThread *thread, const CaptureZoomedView *views, size_t count)
+{
+	lock_guard<mutex> lock(thread->settings_mutex);
+	thread->settings.zoomed_views.assign(views, views + count);
+	thread->settings_changed = true;
+	thread->wake = true;
+	thread->condition.notify_one();
+}
+
+void capture_thread_start(struct CaptureThread *thread, float refresh_rate)
+{
+	capture_thread_stop(thread);
+	vector<Rect2<int>> monitors;
+	for (int i = 0, count = gdk_screen_get_n_monitors(thread->screen); i < count; i++){
+		GdkRectangle geometry;
+		gdk_screen_get_monitor_geometry(thread->screen, i, &geometry);
+		monitors.push_back(Rect2<int>(geometry.x, geometry.y, geometry.x + geometry.width, geometry.y + geometry.height));
+	}
+	// scheduler has no timer, it only decides which frames are published and how long capture thread sleeps
+	picker_scheduler_start(thread->scheduler, refresh_rate);
+	thread->interval = int64_t(1000000 / refresh_rate);
+	{
+		lock_guard<mutex> lock(thread->settings_mutex);
+		thread->settings.monitors = monitors;
+		thread->settings_changed = true;
+		thread->running = true;
+	}
+	thread->worker = std::thread(capture_thread_run, thread);
+}
+
+void capture_thread_stop(struct CaptureThread *thread)
+{
+	if (!thread->worker.joinable()) return;
+	{
+		lock_guard<mutex> lock(thread->settings_mutex);
+		thread->running = false;
+		thread->condition.notify_one();
+	}
+	thread->worker.join();
+	g_source_remove_by_user_data(thread);
+	thread->deliver_pending = false;
+	thread->frames.update(); // discard undelivered frame
+}
+
+void capture_thread_wake(struct CaptureThread *thread)
+{
+	lock_guard<mutex> lock(thread->settings_mutex);
+	thread->wake = true;
+	thread->condition.notify_one();
+}
+
+void capture_thread_get_statistics(struct CaptureThread *thread, CaptureThreadStatistics *statistics)
+{
+	statistics->captured = thread->captured;
+	statistics->skipped = thread->skipped;
+	statistics->published = thread->published;
+	statistics->delivered = thread->delivered;
+	statistics->dropped = thread->dropped;
+	statistics->late = thread->late;
+}
+
+bool capture_frame_update_zoomed(const CaptureFrame *frame, GtkZoomed *zoomed)
+{
+	if (frame->zoomed_rect.isEmpty() || !frame->zoomed) return false;
+	Vec2<int> pointer = frame->pointer;
+	Rect2<int> screen_rect = frame->screen_rect, zoomed_rect;
+	gtk_zoomed_get_screen_rect(zoomed, pointer, screen_rect, &zoomed_rect);
+	if (!zoomed_rect.isInside(frame->zoomed_rect)) return false;
+	Vec2<int> offset(zoomed_rect.getX() - frame->zoomed_rect.getX(), zoomed_rect.getY() - frame->zoomed_rect.getY());
+	gtk_zoomed_update(zoomed, pointer, screen_rect, offset, frame->zoomed);
+	return true;
+}
+
+void capture_thread_destroy(struct CaptureThread *thread)
+{
+	capture_thread_stop(thread);
+	for (int i = 0; i < 3; i++){
+		if (thread->frames.slot(i).zoomed)
+			g_object_unref(thread->frames.slot(i).zoomed);
+	}
+	picker_scheduler_destroy(thread->scheduler);
+	sampler_destroy(thread->sampler);
+	screen_reader_destroy(thread->screen_reader);
+	delete thread;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_CAPTURE_THREAD_H_
+#define GPICK_CAPTURE_THREAD_H_
+
+#include "Color.h"
+#include "Rect2.h"
+#include "Vector2.h"
+#include "Sampler.h"
+#include "gtk/Zoomed.h"
+#include <gdk/gdk.h>
+#include <stdint.h>
+
+/** \file source/CaptureThread.h
+ * \brief Screen capture and sampling in a dedicated thread.
+ *
+ * Capture thread queries pointer position, reads screen and samples color through its own display connection, so slow
+ * X server round-trips do not block GTK main loop. Frames are passed to main loop through a lock-free triple buffer and
+ * delivered by an idle handler. Only available when gpick is built with X11 support, and reads through MIT-SHM when Xext is available too.
+ */
+
+/** \struct CaptureFrame
+ * \brief Result of a single capture.
+ */
+typedef struct CaptureFrame{
+	uint64_t sequence; /**< Sequence number of published frames */
+	int64_t capture_time; /**< Monotonic capture time in microseconds */
+	math::Vec2<int> pointer; /**< Pointer position */
+	math::Rect2<int> screen_rect; /**< Geometry of the monitor containing pointer */
+	math::Rect2<int> zoomed_rect; /**< Screen area copied into zoomed pixbuf. Covers areas of all zoomed views */
+	Color color; /**< Sampled color */
+	GdkPixbuf *zoomed; /**< Pixels of zoomed_rect, starting at the top left corner. Only valid when zoomed_rect is not empty */
+}CaptureFrame;
+
+/** \struct CaptureZoomedView
+ * \brief Parameters of a zoomed view, which shows captured pixels.
+ */
+typedef struct CaptureZoomedView{
+	float zoom; /**< Zoom level */
+	int32_t width_height; /**< Zoomed view size */
+}CaptureZoomedView;
+
+/** \struct CaptureThreadStatistics
+ * \brief Capture thread frame counters.
+ */
+typedef struct CaptureThreadStatistics{
+	uint64_t captured; /**< Screen captures made */
+	uint64_t skipped; /**< Captures, which were not published because pointer and screen did not change */
+	uint64_t published; /**< Frames published to main loop */
+	uint64_t delivered; /**< Frames delivered to frame callback */
+	uint64_t dropped; /**< Published frames replaced by newer ones before main loop picked them up */
+	uint64_t late; /**< Frames delivered more than one refresh interval after capture */
+}CaptureThreadStatistics;
+
+struct CaptureThread;
+
+/**
+ * Function called in main loop for each delivered frame.
+ * @param[in] frame Captured frame. Stays valid until the function returns.
+ * @param[in] data User data.
+ */
+typedef void (*CaptureThreadFrameCallback)(const CaptureFrame *frame, void *data);
+
+/**
+ * Create capture thread for a screen. Thread is not started.
+ * @param[in] screen Screen to capture.
+ * @param[in] callback Function called in main loop for each new frame.
+ * @param[in] data User data passed to callback.
+ * @return New capture thread or nullptr if capture thread is not supported, or was disabled by setting GPICK_CAPTURE_THREAD=0.
+ */
+struct CaptureThread* capture_thread_new(GdkScreen *screen, CaptureThreadFrameCallback callback, void *data);
+
+/**
+ * Set sampling parameters used by capture thread.
+ * @param[in] thread Capture thread.
+ * @param[in] oversample Sampler oversample.
+ * @param[in] falloff Sampler falloff.
+ */
+void capture_thread_set_sampler(struct CaptureThread *thread, int oversample, enum SamplerFalloff falloff);
+
+/**
+ * Set zoomed views, which are updated from captured frames. Frame zoomed area covers areas of all views.
+ * @param[in] thread Capture thread.
+ * @param[in] views Zoomed view parameters.
+ * @param[in] count Number of zoomed views. Zoomed area is not captured when zero.
+ */
+void capture_thread_set_zoomed(struct CaptureThread *thread, const CaptureZoomedView *views, size_t count);
+
+/**
+ * Start capturing. Updates monitor geometry, as it can only be queried in main loop.
+ * @param[in] thread Capture thread.
+ * @param[in] refresh_rate Refresh rate in frames per second.
+ */
+void capture_thread_start(struct CaptureThread *thread, float refresh_rate);
+
+/**
+ * Stop capturing and wait for thread to finish. Frames, which were not delivered yet, are discarded.
+ * @param[in] thread Capture thread.
+ */
+void capture_thread_stop(struct CaptureThread *thread);
+
+/**
+ * Force publishing of the next frame and return to full refresh rate.
+ * @param[in] thread Capture thread.
+ */
+void capture_thread_wake(struct CaptureThread *thread);
+
+/**
+ * Get frame counters.
+ * @param[in] thread Capture thread.
+ * @param[out] statistics Frame counters.
+ */
+void capture_thread_get_statistics(struct CaptureThread *thread, CaptureThreadStatistics *statistics);
+
+/**
+ * Update zoomed view from frame pixels. Zoom level or view size might have changed after the frame was captured, so view is
+ * only updated when the area it shows is contained in frame zoomed area.
+ * @param[in] frame Captured frame.
+ * @param[in] zoomed Zoomed view.
+ * @return True if zoomed view was updated.
+ */
+bool capture_frame_update_zoomed(const CaptureFrame *frame, GtkZoomed *zoomed);
+
+/**
+ * Stop and destroy capture thread.
+ * @param[in] thread Capture thread.
+ */
+void capture_thread_destroy(struct CaptureThread *thread);
+
+#endif /* GPICK_CAPTURE_THREAD_H_ */
@@ -18,7 +18,12 @@
 
 #include "Color.h"
 #include <math.h>
+#include <string.h>
+#include <stdint.h>
 #include "MathUtil.h"
+#include "ColorBatch.h"
+#include "simd/Dispatch.h"
+#include "simd/Kernels.h"
 
 #include <iostream>
 using namespace std;
@@ -38,22 +43,160 @@ static vector3 references[][2] = {
 	{{{{100.966, 100.000,  64.370}}}, {{{103.866, 100.000,  65.627}}}},
 };
 
-static matrix3x3 sRGB_transformation;
-static matrix3x3 sRGB_transformation_inverted;
+// Same values as D65 and D50 entries for 2 degree observer in references table
+static constexpr double d65_reference_white[3] = {95.047, 100.000, 108.883};
+static constexpr double d50_reference_white[3] = {96.422, 100.000, 82.521};
 
-static matrix3x3 d65_d50_adaptation_matrix;
-static matrix3x3 d50_d65_adaptation_matrix;
+// Compile time versions of matrix3x3 functions. Product of a and b is a * b, when applied to column vector
+static constexpr matrix3x3 constant_matrix_multiply(const matrix3x3 &a, const matrix3x3 &b)
+{
+	matrix3x3 result{};
+	for (int i = 0; i < 3; i++){
+		for (int j = 0; j < 3; j++){
+			for (int k = 0; k < 3; k++){
+				result.m[i][j] += a.m[i][k] * b.m[k][j];
+			}
+		}
+	}
+	return result;
+}
 
+static constexpr matrix3x3 constant_matrix_inverse(const matrix3x3 &a)
+{
+	matrix3x3 result{};
+	for (int i = 0; i < 3; i++){
+		for (int j = 0; j < 3; j++){
+			int i1 = (i + 1) % 3, i2 = (i + 2) % 3, j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+			result.m[j][i] = a.m[i1][j1] * a.m[i2][j2] - a.m[i1][j2] * a.m[i2][j1];
+		}
+	}
+	double determinant = a.m[0][0] * result.m[0][0] + a.m[0][1] * result.m[1][0] + a.m[0][2] * result.m[2][0];
+	for (int i = 0; i < 3; i++){
+		for (int j = 0; j < 3; j++){
+			result.m[i][j] /= determinant;
+		}
+	}
+	return result;
+}
 
-void color_init()
+static constexpr matrix3x3 constant_working_space_matrix(double xr, double yr, double xg, double yg, double xb, double yb, const double reference_white[3])
 {
-	// constants used below are sRGB working space red, green and blue primaries for D65 reference white
-	color_get_working_space_matrix(0.6400, 0.3300, 0.3000, 0.6000, 0.1500, 0.0600, color_get_reference(REFERENCE_ILLUMINANT_D65, REFERENCE_OBSERVER_2), &sRGB_transformation);
-	matrix3x3_inverse(&sRGB_transformation, &sRGB_transformation_inverted);
+	matrix3x3 primaries{{
+		{xr / yr, xg / yg, xb / yb},
+		{1, 1, 1},
+		{(1 - xr - yr) / yr, (1 - xg - yg) / yg, (1 - xb - yb) / yb},
+	}};
+	matrix3x3 inverted = constant_matrix_inverse(primaries);
+	double scale[3] = {};
+	for (int i = 0; i < 3; i++){
+		for (int j = 0; j < 3; j++){
+			scale[i] += inverted.m[i][j] * reference_white[j];
+		}
+	}
+	for (int i = 0; i < 3; i++){
+		for (int j = 0; j < 3; j++){
+			primaries.m[i][j] *= scale[j];
+		}
+	}
+	return primaries;
+}
+
+static constexpr matrix3x3 constant_adaptation_matrix(const double source_reference_white[3], const double destination_reference_white[3])
+{
+	// Bradford matrix and its inverse, with the same precision as in color_get_chromatic_adaptation_matrix
+	matrix3x3 Ma{{
+		{ 0.8951,  0.2664, -0.1614},
+		{-0.7502,  1.7135,  0.0367},
+		{ 0.0389, -0.0685,  1.0296},
+	}};
+	matrix3x3 Ma_inv{{
+		{ 0.986993, -0.147054, 0.159963},
+		{ 0.432305,  0.518360, 0.049291},
+		{-0.008529,  0.040043, 0.968487},
+	}};
+	matrix3x3 M{};
+	for (int i = 0; i < 3; i++){
+		double source = 0, destination = 0;
+		for (int j = 0; j < 3; j++){
+			source += Ma.m[i][j] * source_reference_white[j];
+			destination += Ma.m[i][j] * destination_reference_white[j];
+		}
+		M.m[i][i] = destination / source;
+	}
+	return constant_matrix_multiply(Ma_inv, constant_matrix_multiply(M, Ma));
+}
+
+// sRGB working space red, green and blue primaries for D65 reference white
+static constexpr matrix3x3 sRGB_transformation = constant_working_space_matrix(0.6400, 0.3300, 0.3000, 0.6000, 0.1500, 0.0600, d65_reference_white);
+static constexpr matrix3x3 sRGB_transformation_inverted = constant_matrix_inverse(sRGB_transformation);
 
-	color_get_chromatic_adaptation_matrix(color_get_reference(REFERENCE_ILLUMINANT_D65, REFERENCE_OBSERVER_2), color_get_reference(REFERENCE_ILLUMINANT_D50, REFERENCE_OBSERVER_2), &d65_d50_adaptation_matrix);
-	color_get_chromatic_adaptation_matrix(color_get_reference(REFERENCE_ILLUMINANT_D50, REFERENCE_OBSERVER_2), color_get_reference(REFERENCE_ILLUMINANT_D65, REFERENCE_OBSERVER_2), &d50_d65_adaptation_matrix);
+static constexpr matrix3x3 d65_d50_adaptation_matrix = constant_adaptation_matrix(d65_reference_white, d50_reference_white);
+static constexpr matrix3x3 d50_d65_adaptation_matrix = constant_adaptation_matrix(d50_reference_white, d65_reference_white);
 
+// sRGB to XYZ transformation and D65 to D50 adaptation folded into one matrix
+static constexpr matrix3x3 sRGB_d50_transformation = constant_matrix_multiply(d65_d50_adaptation_matrix, sRGB_transformation);
+static constexpr matrix3x3 sRGB_d50_transformation_inverted = constant_matrix_inverse(sRGB_d50_transformation);
+
+// Encode table is indexed by square root of linear value, which spreads entries evenly over the steep part of the curve
+#define TRANSFER_ENCODE_TABLE_SIZE 1024
+
+static ColorTransferMode transfer_mode = COLOR_TRANSFER_FAST;
+static float transfer_decode_table[256];
+static float transfer_encode_table[TRANSFER_ENCODE_TABLE_SIZE + 1];
+
+static inline float transfer_decode_exact(float value)
+{
+	if (value > 0.04045)
+		return pow((value + 0.055) / 1.055, 2.4);
+	else
+		return value / 12.92;
+}
+
+static inline float transfer_encode_exact(float value)
+{
+	if (value > 0.0031308)
+		return 1.055 * pow(value, 1 / 2.4) - 0.055;
+	else
+		return value * 12.92;
+}
+
+static inline float transfer_decode(float value)
+{
+	if (transfer_mode == COLOR_TRANSFER_FAST){
+		float scaled = value * 255;
+		int index = int(scaled + 0.5f);
+		if (index >= 0 && index <= 255 && fabs(scaled - index) < 1e-4f)
+			return transfer_decode_table[index];
+	}
+	return transfer_decode_exact(value);
+}
+
+static inline float transfer_encode(float value)
+{
+	if (transfer_mode == COLOR_TRANSFER_FAST && value > 0.0031308f && value <= 1.0f){
+		float position = sqrt(value) * TRANSFER_ENCODE_TABLE_SIZE;
+		int index = int(position);
+		if (index >= TRANSFER_ENCODE_TABLE_SIZE)
+			return transfer_encode_table[TRANSFER_ENCODE_TABLE_SIZE];
+		float fraction = position - index;
+		return transfer_encode_table[index] + (transfer_encode_table[index + 1] - transfer_encode_table[index]) * fraction;
+	}
+	return transfer_encode_exact(value);
+}
+
+
+void color_init()
+{
+	dispatch_init();
+	for (int i = 0; i < 256; i++){
+		transfer_decode_table[i] = transfer_decode_exact(i / 255.0f);
+	}
+	for (int i = 0; i <= TRANSFER_ENCODE_TABLE_SIZE; i++){
+		double root = i / double(TRANSFER_ENCODE_TABLE_SIZE);
+		transfer_encode_table[i] = transfer_encode_exact(root * root);
+	}
+	color_batch_init();
+	kernels_init();
 }
 
 
@@ -143,25 +286,7 @@ void color_hsv_to_rgb(const Color* a, Color* b)
 
 void color_rgb_to_xyz(const Color* a, Color* b, const matrix3x3* transformation)
 {
-	float R=a->rgb.red, G=a->rgb.green, B=a->rgb.blue;
-
-	if (R>0.04045){
-		R=pow(((R+0.055)/1.055),2.4);
-	}else{
-		R=R/12.92;
-	}
-
-	if (G>0.04045){
-		G=pow(((G+0.055)/1.055),2.4);
-	}else{
-		G=G/12.92;
-	}
-
-	if (B>0.04045){
-		B=pow(((B+0.055)/1.055),2.4);
-	}else{
-		B=B/12.92;
-	}
+	float R = transfer_decode(a->rgb.red), G = transfer_decode(a->rgb.green), B = transfer_decode(a->rgb.blue);
 
 	vector3 rgb;
 	rgb.x = R;
@@ -181,25 +306,9 @@ void color_xyz_to_rgb(const Color* a, Color* b, const matrix3x3* transformation_
 	float R,G,B;
 
 	vector3_multiply_matrix3x3((vector3*)a, transformation_inverted, &rgb);
-	R=rgb.x;
-	G=rgb.y;
-	B=rgb.z;
-
-	if (R>0.0031308){
-		R=1.055*(pow(R,1/2.4f))-0.055;
-	}else{
-		R=12.92*R;
-	}
-	if (G>0.0031308){
-		G=1.055*(pow(G,1/2.4f))-0.055;
-	}else{
-		G=12.92*G;
-	}
-	if(B>0.0031308){
-		B=1.055*(pow(B,1/2.4f))-0.055;
-	}else{
-		B=12.92*B;
-	}
+	R = transfer_encode(rgb.x);
+	G = transfer_encode(rgb.y);
+	B = transfer_encode(rgb.z);
 
 	b->rgb.red=R;
 	b->rgb.green=G;
@@ -394,13 +503,61 @@ void color_hsl_to_rgb(const Color* a, Color* b)
 	}
 }
 
-void color_lab_to_lch(const Color* a, Color* b)
+#define Kk (24389.0 / 27.0)
+
+/**
+ * Cube root of positive normal value. Initial estimate from exponent bits is refined by two Halley iterations, giving full float precision.
+ */
+static inline float cube_root(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	bits = bits / 3 + 709921077;
+	float estimate;
+	memcpy(&estimate, &bits, sizeof(estimate));
+	double y = estimate;
+	for (int i = 0; i < 2; i++){
+		double y3 = y * y * y;
+		y = y * (y3 + 2 * value) / (2 * y3 + value);
+	}
+	return y;
+}
+
+static inline float lab_function(float value)
+{
+	if (value > EPSILON)
+		return cube_root(value);
+	else
+		return (Kk * value + 16.0f) / 116.0f;
+}
+
+static inline void xyz_to_lab(float x, float y, float z, float white_x, float white_y, float white_z, float &L, float &A, float &B)
+{
+	float X = lab_function(x / white_x);
+	float Y = lab_function(y / white_y);
+	float Z = lab_function(z / white_z);
+	L = (116 * Y) - 16;
+	A = 500 * (X - Y);
+	B = 200 * (Y - Z);
+}
+
+static inline void rgb_to_lab_d50(const Color* a, float &L, float &A, float &B)
+{
+	float R = transfer_decode(a->rgb.red), G = transfer_decode(a->rgb.green), Bl = transfer_decode(a->rgb.blue);
+	const matrix3x3 &m = sRGB_d50_transformation;
+	float x = R * m.m[0][0] + G * m.m[0][1] + Bl * m.m[0][2];
+	float y = R * m.m[1][0] + G * m.m[1][1] + Bl * m.m[1][2];
+	float z = R * m.m[2][0] + G * m.m[2][1] + Bl * m.m[2][2];
+	xyz_to_lab(x, y, z, d50_reference_white[0], d50_reference_white[1], d50_reference_white[2], L, A, B);
+}
+
+static inline void lab_to_lch(float L, float A, float B, Color* b)
 {
 	double H;
-	if (a->lab.a == 0 && a->lab.b == 0){
+	if (A == 0 && B == 0){
 		H = 0;
 	}else{
-		H = atan2(a->lab.b, a->lab.a);
+		H = atan2(B, A);
 	}
 
 	H *= 180.0 / PI;
@@ -408,11 +565,16 @@ void color_lab_to_lch(const Color* a, Color* b)
 	if (H < 0) H += 360;
 	if (H >= 360) H -= 360;
 
-	b->lch.L = a->lab.L;
-	b->lch.C = sqrt(a->lab.a * a->lab.a + a->lab.b * a->lab.b);
+	b->lch.L = L;
+	b->lch.C = sqrt(A * A + B * B);
 	b->lch.h = H;
 }
 
+void color_lab_to_lch(const Color* a, Color* b)
+{
+	lab_to_lch(a->lab.L, a->lab.a, a->lab.b, b);
+}
+
 void color_lch_to_lab(const Color* a, Color* b)
 {
 	b->lab.L = a->lch.L;
@@ -422,16 +584,16 @@ void color_lch_to_lab(const Color* a, Color* b)
 
 void color_rgb_to_lch_d50(const Color* a, Color* b)
 {
-	Color c;
-	color_rgb_to_lab(a, &c, color_get_reference(REFERENCE_ILLUMINANT_D50, REFERENCE_OBSERVER_2), &sRGB_transformation, &d65_d50_adaptation_matrix);
-	color_lab_to_lch(&c, b);
+	float L, A, B;
+	rgb_to_lab_d50(a, L, A, B);
+	lab_to_lch(L, A, B, b);
 }
 
 void color_lch_to_rgb_d50(const Color* a, Color* b)
 {
 	Color c;
 	color_lch_to_lab(a, &c);
-	color_lab_to_rgb(&c, b, color_get_reference(REFERENCE_ILLUMINANT_D50, REFERENCE_OBSERVER_2), &sRGB_transformation_inverted, &d50_d65_adaptation_matrix);
+	color_lab_to_rgb_d50(&c, b);
 }
 
 void color_rgb_to_lch(const Color* a, Color* b, const vector3* reference_white, const matrix3x3* transformation, const matrix3x3* adaptation_matrix)
@@ -450,44 +612,27 @@ void color_lch_to_rgb(const Color* a, Color* b, const vector3* reference_white,
 
 void color_rgb_to_lab_d50(const Color* a, Color* b)
 {
-	color_rgb_to_lab(a, b, color_get_reference(REFERENCE_ILLUMINANT_D50, REFERENCE_OBSERVER_2), &sRGB_transformation, &d65_d50_adaptation_matrix);
+	float L, A, B;
+	rgb_to_lab_d50(a, L, A, B);
+	b->lab.L = L;
+	b->lab.a = A;
+	b->lab.b = B;
 }
 
 void color_lab_to_rgb_d50(const Color* a, Color* b)
 {
-	color_lab_to_rgb(a, b, color_get_reference(REFERENCE_ILLUMINANT_D50, REFERENCE_OBSERVER_2), &sRGB_transformation_inverted, &d50_d65_adaptation_matrix);
+	Color c;
+	color_lab_to_xyz(a, &c, color_get_reference(REFERENCE_ILLUMINANT_D50, REFERENCE_OBSERVER_2));
+	color_xyz_to_rgb(&c, b, &sRGB_d50_transformation_inverted);
 }
 
-#define Kk (24389.0 / 27.0)
-
 void color_xyz_to_lab(const Color* a, Color* b, const vector3* reference_white)
 {
-	float X,Y,Z;
-
-	X = a->xyz.x / reference_white->x; //95.047f;
-	Y = a->xyz.y / reference_white->y; //100.000f;
-	Z = a->xyz.z / reference_white->z; //108.883f;
-
-	if (X>EPSILON){
-		X=pow(X,1.0f/3.0f);
-	}else{
-		X=(Kk*X+16.0f)/116.0f;
-	}
-	if (Y>EPSILON){
-		Y=pow(Y,1.0f/3.0f);
-	}else{
-		Y=(Kk*Y+16.0f)/116.0f;
-	}
-	if (Z>EPSILON){
-		Z=pow(Z,1.0f/3.0f);
-	}else{
-		Z=(Kk*Z+16.0f)/116.0f;
-	}
-
-	b->lab.L=(116*Y)-16;
-	b->lab.a=500*(X-Y);
-	b->lab.b=200*(Y-Z);
-
+	float L, A, B;
+	xyz_to_lab(a->xyz.x, a->xyz.y, a->xyz.z, reference_white->x, reference_white->y, reference_white->z, L, A, B);
+	b->lab.L = L;
+	b->lab.a = A;
+	b->lab.b = B;
 }
 
 void color_lab_to_xyz(const Color* a, Color* b, const vector3* reference_white)
@@ -691,39 +836,26 @@ void color_hsv_to_hsl(const Color *a, Color *b)
 
 void color_rgb_get_linear(const Color* a, Color* b)
 {
-	if (a->rgb.red > 0.04045f)
-		b->rgb.red = pow((a->rgb.red + 0.055f) / 1.055f, 2.4f);
-	else
-		b->rgb.red = a->rgb.red / 12.92f;
-
-	if (a->rgb.green > 0.04045f)
-		b->rgb.green = pow((a->rgb.green + 0.055f) / 1.055f, 2.4f);
-	else
-		b->rgb.green = a->rgb.green / 12.92f;
-
-	if (a->rgb.blue > 0.04045f)
-		b->rgb.blue = pow((a->rgb.blue + 0.055f) / 1.055f, 2.4f);
-	else
-		b->rgb.blue = a->rgb.blue / 12.92f;
-
+	b->rgb.red = transfer_decode(a->rgb.red);
+	b->rgb.green = transfer_decode(a->rgb.green);
+	b->rgb.blue = transfer_decode(a->rgb.blue);
 }
 
 void color_linear_get_rgb(const Color* a, Color* b)
 {
-	if (a->rgb.red > 0.0031308f)
-		b->rgb.red = (1.055f * pow(a->rgb.red, 1.0f / 2.4f)) - 0.055f;
-	else
-		b->rgb.red = a->rgb.red * 12.92f;
+	b->rgb.red = transfer_encode(a->rgb.red);
+	b->rgb.green = transfer_encode(a->rgb.green);
+	b->rgb.blue = transfer_encode(a->rgb.blue);
+}
 
-	if (a->rgb.green > 0.0031308f)
-		b->rgb.green = (1.055f * pow(a->rgb.green, 1.0f / 2.4f)) - 0.055f;
-	else
-		b->rgb.green = a->rgb.green * 12.92f;
+void color_set_transfer_mode(ColorTransferMode mode)
+{
+	transfer_mode = mode;
+}
 
-	if (a->rgb.blue > 0.0031308f)
-		b->rgb.blue = (1.055f * pow(a->rgb.blue, 1.0f / 2.4f)) - 0.055f;
-	else
-		b->rgb.blue = a->rgb.blue * 12.92f;
+ColorTransferMode color_get_transfer_mode()
+{
+	return transfer_mode;
 }
 
 const matrix3x3* color_get_sRGB_transformation_matrix()
@@ -736,6 +868,16 @@ const matrix3x3* color_get_inverted_sRGB_transformation_matrix()
 	return &sRGB_transformation_inverted;
 }
 
+const matrix3x3* color_get_sRGB_d50_transformation_matrix()
+{
+	return &sRGB_d50_transformation;
+}
+
+const matrix3x3* color_get_inverted_sRGB_d50_transformation_matrix()
+{
+	return &sRGB_d50_transformation_inverted;
+}
+
 const matrix3x3* color_get_d65_d50_adaptation_matrix()
 {
 	return &d65_d50_adaptation_matrix;
@@ -816,14 +958,16 @@ float color_distance(const Color* a, const Color* b)
 
 float color_distance_lch(const Color* a, const Color* b)
 {
-	Color al, bl;
-	color_lab_to_lch(a, &al);
-	color_lab_to_lch(b, &bl);
-	return sqrt(
-		pow((bl.lch.L - al.lch.L) / 1, 2) +
-		pow((bl.lch.C - al.lch.C) / (1 + 0.045 * al.lch.C), 2) +
-		pow((pow(a->lab.a - b->lab.a, 2) + pow(a->lab.b - b->lab.b, 2) - (bl.lch.C - al.lch.C)) / (1 + 0.015 * al.lch.C), 2)
-	);
+	// only chroma is needed from LCH color space, so hue angle calculation is skipped
+	float a_chroma = sqrt(a->lab.a * a->lab.a + a->lab.b * a->lab.b);
+	float b_chroma = sqrt(b->lab.a * b->lab.a + b->lab.b * b->lab.b);
+	float dl = b->lab.L - a->lab.L;
+	float dc = b_chroma - a_chroma;
+	float da = a->lab.a - b->lab.a;
+	float db = a->lab.b - b->lab.b;
+	double chroma = dc / (1 + 0.045 * a_chroma);
+	double hue = (double(da) * da + double(db) * db - dc) / (1 + 0.015 * a_chroma);
+	return sqrt(double(dl) * dl + chroma * chroma + hue * hue);
 }
 bool color_equal(const Color* a, const Color* b)
 {
@@ -104,12 +104,33 @@ enum ReferenceObserver {
 	REFERENCE_OBSERVER_10 = 1,
 };
 
+/** \enum ColorTransferMode
+ * \brief sRGB transfer function evaluation modes.
+ */
+enum ColorTransferMode {
+	COLOR_TRANSFER_EXACT = 0, /**< Always evaluate transfer functions with pow */
+	COLOR_TRANSFER_FAST = 1, /**< Use exact table for 8-bit values and interpolated table for linear to sRGB direction. Maximum error is about 1e-6 */
+};
+
 
 /**
  * Initialize things needed for color conversion functions. Must be called before using any other functions.
  */
 void color_init();
 
+/**
+ * Select how sRGB transfer functions are evaluated by color_rgb_to_xyz, color_xyz_to_rgb, color_rgb_get_linear, color_linear_get_rgb and functions using them.
+ * Fast mode is used by default, exact mode is intended for reference testing.
+ * @param[in] mode Transfer function evaluation mode.
+ */
+void color_set_transfer_mode(ColorTransferMode mode);
+
+/**
+ * Get current sRGB transfer function evaluation mode.
+ * @return Transfer function evaluation mode.
+ */
+ColorTransferMode color_get_transfer_mode();
+
 /**
  * Convert RGB color space to HSL color space.
  * @param[in] a Source color in RGB color space.
@@ -449,6 +470,18 @@ const matrix3x3* color_get_sRGB_transformation_matrix();
  */
 const matrix3x3* color_get_inverted_sRGB_transformation_matrix();
 
+/**
+ * Get sRGB working space matrix combined with D65 to D50 chromatic adaptation matrix.
+ * @return Constant reference to combined matrix.
+ */
+const matrix3x3* color_get_sRGB_d50_transformation_matrix();
+
+/**
+ * Get inverted sRGB working space matrix combined with D50 to D65 chromatic adaptation matrix.
+ * @return Constant reference to combined inverted matrix.
+ */
+const matrix3x3* color_get_inverted_sRGB_d50_transformation_matrix();
+
 /**
  * Get D65 to D50 chromatic adaptation matrix.
  * @return Constant reference to chromatic adaptation matrix.
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ColorBatch.h"
+#include "MathUtil.h"
+#include "simd/Kernels.h"
+
+static ColorKernelParameters parameters;
+
+static void matrix_to_parameter(const matrix3x3* matrix, float *result)
+{
+	for (int i = 0; i < 3; i++){
+		for (int j = 0; j < 3; j++){
+			result[i * 3 + j] = matrix->m[i][j];
+		}
+	}
+}
+
+void color_batch_init()
+{
+	matrix_to_parameter(color_get_sRGB_transformation_matrix(), parameters.rgb_to_xyz);
+	matrix_to_parameter(color_get_inverted_sRGB_transformation_matrix(), parameters.xyz_to_rgb);
+	matrix_to_parameter(color_get_sRGB_d50_transformation_matrix(), parameters.rgb_to_xyz_d50);
+	matrix_to_parameter(color_get_inverted_sRGB_d50_transformation_matrix(), parameters.xyz_d50_to_rgb);
+	const vector3* white = color_get_reference(REFERENCE_ILLUMINANT_D50, REFERENCE_OBSERVER_2);
+	parameters.white_d50[0] = white->x;
+	parameters.white_d50[1] = white->y;
+	parameters.white_d50[2] = white->z;
+}
+
+static inline const ColorKernels* kernels()
+{
+	return kernels_color();
+}
+
+ColorSpan* color_span_new(size_t count)
+{
+	ColorSpan* span = new ColorSpan;
+	float *data = new float[count * 3];
+	for (int i = 0; i < 3; i++){
+		span->component[i] = data + count * i;
+	}
+	span->count = count;
+	return span;
+}
+
+void color_span_destroy(ColorSpan* span)
+{
+	delete [] span->component[0];
+	delete span;
+}
+
+void color_span_load(const Color* colors, size_t count, ColorSpan* span)
+{
+	for (size_t i = 0; i < count; i++){
+		span->component[0][i] = colors[i].ma[0];
+		span->component[1][i] = colors[i].ma[1];
+		span->component[2][i] = colors[i].ma[2];
+	}
+}
+
+void color_span_store(const ColorSpan* span, Color* colors)
+{
+	for (size_t i = 0; i < span->count; i++){
+		colors[i].ma[0] = span->component[0][i];
+		colors[i].ma[1] = span->component[1][i];
+		colors[i].ma[2] = span->component[2][i];
+		colors[i].ma[3] = 0;
+	}
+}
+
+const char* color_batch_get_instruction_set()
+{
+	return kernels()->name;
+}
+
+void color_batch_rgb_to_hsv(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->rgb_to_hsv(a, b, &parameters);
+}
+
+void color_batch_hsv_to_rgb(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->hsv_to_rgb(a, b, &parameters);
+}
+
+void color_batch_rgb_to_hsl(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->rgb_to_hsl(a, b, &parameters);
+}
+
+void color_batch_hsl_to_rgb(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->hsl_to_rgb(a, b, &parameters);
+}
+
+void color_batch_rgb_to_xyz(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->rgb_to_xyz(a, b, &parameters);
+}
+
+void color_batch_xyz_to_rgb(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->xyz_to_rgb(a, b, &parameters);
+}
+
+void color_batch_rgb_to_lab_d50(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->rgb_to_lab_d50(a, b, &parameters);
+}
+
+void color_batch_lab_to_rgb_d50(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->lab_to_rgb_d50(a, b, &parameters);
+}
+
+void color_batch_rgb_to_lch_d50(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->rgb_to_lch_d50(a, b, &parameters);
+}
+
+void color_batch_lch_to_rgb_d50(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->lch_to_rgb_d50(a, b, &parameters);
+}
+
+void color_batch_rgb_get_linear(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->rgb_get_linear(a, b, &parameters);
+}
+
+void color_batch_linear_get_rgb(const ColorSpan* a, ColorSpan* b)
+{
+	kernels()->linear_get_rgb(a, b, &parameters);
+}
+
+void color_batch_distance(const ColorSpan* a, const Color* b, float* distances)
+{
+	kernels()->distance(a, b->ma, distances);
+}
+
+void color_batch_distance_lch(const ColorSpan* a, const Color* b, float* distances)
+{
+	kernels()->distance_lch(a, b->ma, distances);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_COLOR_BATCH_H_
+#define GPICK_COLOR_BATCH_H_
+
+#include "Color.h"
+#include <cstddef>
+
+/** \file source/ColorBatch.h
+ * \brief Functions to convert spans of colors stored as separate component arrays from one color space to another.
+ *
+ * Batch functions produce the same results as single color functions declared in Color.h (within floating point rounding),
+ * but process several colors at once using the best SIMD instruction set available. Single color functions remain the reference implementation.
+ * Source and destination spans can be the same span.
+ */
+
+/** \struct ColorSpan
+ * \brief Structure-of-arrays view of colors. Each color component is stored in a separate array.
+ */
+typedef struct ColorSpan{
+	float *component[3]; /**< Component arrays, for example red, green and blue arrays for colors in RGB color space */
+	size_t count; /**< Number of colors */
+}ColorSpan;
+
+/**
+ * Create new ColorSpan structure with allocated component arrays.
+ * @param[in] count Number of colors.
+ * @return ColorSpan structure with unspecified values.
+ */
+ColorSpan* color_span_new(size_t count);
+
+/**
+ * Free memory associated with ColorSpan structure created by color_span_new.
+ * @param[in] span ColorSpan to be freed.
+ */
+void color_span_destroy(ColorSpan* span);
+
+/**
+ * Copy first three components of colors into span.
+ * @param[in] colors Source colors.
+ * @param[in] count Number of source colors. Must not be larger than span size.
+ * @param[out] span Destination span.
+ */
+void color_span_load(const Color* colors, size_t count, ColorSpan* span);
+
+/**
+ * Copy span values into colors. Fourth color component is set to zero.
+ * @param[in] span Source span.
+ * @param[out] colors Destination colors. Must have space for span->count colors.
+ */
+void color_span_store(const ColorSpan* span, Color* colors);
+
+/**
+ * Prepare parameters of batch kernels. Called by color_init().
+ */
+void color_batch_init();
+
+/**
+ * Get name of instruction set used by batch conversion functions.
+ * @return Instruction set name.
+ */
+const char* color_batch_get_instruction_set();
+
+/**
+ * Convert span of colors from RGB color space to HSV color space.
+ * @param[in] a Source colors in RGB color space.
+ * @param[out] b Destination colors in HSV color space.
+ */
+void color_batch_rgb_to_hsv(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from HSV color space to RGB color space.
+ * @param[in] a Source colors in HSV color space.
+ * @param[out] b Destination colors in RGB color space.
+ */
+void color_batch_hsv_to_rgb(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from RGB color space to HSL color space.
+ * @param[in] a Source colors in RGB color space.
+ * @param[out] b Destination colors in HSL color space.
+ */
+void color_batch_rgb_to_hsl(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from HSL color space to RGB color space.
+ * @param[in] a Source colors in HSL color space.
+ * @param[out] b Destination colors in RGB color space.
+ */
+void color_batch_hsl_to_rgb(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from RGB color space to XYZ color space using sRGB transformation matrix.
+ * @param[in] a Source colors in RGB color space.
+ * @param[out] b Destination colors in XYZ color space.
+ */
+void color_batch_rgb_to_xyz(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from XYZ color space to RGB color space using inverted sRGB transformation matrix.
+ * @param[in] a Source colors in XYZ color space.
+ * @param[out] b Destination colors in RGB color space.
+ */
+void color_batch_xyz_to_rgb(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from RGB color space to Lab color space. Batch version of color_rgb_to_lab_d50.
+ * @param[in] a Source colors in RGB color space.
+ * @param[out] b Destination colors in Lab color space.
+ */
+void color_batch_rgb_to_lab_d50(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from Lab color space to RGB color space. Batch version of color_lab_to_rgb_d50.
+ * @param[in] a Source colors in Lab color space.
+ * @param[out] b Destination colors in RGB color space.
+ */
+void color_batch_lab_to_rgb_d50(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from RGB color space to LCH color space. Batch version of color_rgb_to_lch_d50.
+ * @param[in] a Source colors in RGB color space.
+ * @param[out] b Destination colors in LCH color space.
+ */
+void color_batch_rgb_to_lch_d50(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Convert span of colors from LCH color space to RGB color space. Batch version of color_lch_to_rgb_d50.
+ * @param[in] a Source colors in LCH color space.
+ * @param[out] b Destination colors in RGB color space.
+ */
+void color_batch_lch_to_rgb_d50(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Transform span of RGB colors to linear RGB colors.
+ * @param[in] a Colors in RGB color space.
+ * @param[out] b Linear colors in RGB color space.
+ */
+void color_batch_rgb_get_linear(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Transform span of linear RGB colors to RGB colors.
+ * @param[in] a Linear colors in RGB color space.
+ * @param[out] b Colors in RGB color space.
+ */
+void color_batch_linear_get_rgb(const ColorSpan* a, ColorSpan* b);
+
+/**
+ * Calculate distances between span of colors and one color. Batch version of color_distance.
+ * @param[in] a Colors in RGB color space.
+ * @param[in] b Color in RGB color space.
+ * @param[out] distances Distances. Must have space for a->count values.
+ */
+void color_batch_distance(const ColorSpan* a, const Color* b, float* distances);
+
+/**
+ * Calculate distances between span of colors and one color. Batch version of color_distance_lch, colors in span are used as first argument.
+ * @param[in] a Colors in Lab color space.
+ * @param[in] b Color in Lab color space.
+ * @param[out] distances Distances. Must have space for a->count values.
+ */
+void color_batch_distance_lch(const ColorSpan* a, const Color* b, float* distances);
+
+#endif /* GPICK_COLOR_BATCH_H_ */
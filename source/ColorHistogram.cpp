@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ColorHistogram.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Smallest number of pixels counted by each color_histogram_add_image thread
+#define MIN_PIXELS_PER_THREAD (256 * 1024)
+
+struct ColorHistogram{
+	vector<ColorHistogramBin> bins;
+	uint64_t pixel_count;
+};
+
+ColorHistogram* color_histogram_new(){
+	ColorHistogram *histogram = new ColorHistogram;
+	histogram->bins.resize(COLOR_HISTOGRAM_SIZE);
+	histogram->pixel_count = 0;
+	return histogram;
+}
+
+void color_histogram_add_rows(ColorHistogram *histogram, const uint8_t *pixels, int width, int height, int rowstride, int channels){
+	ColorHistogramBin *bins = &histogram->bins.front();
+	for (int y = 0; y < height; y++){
+		const uint8_t *pixel = pixels + size_t(rowstride) * y;
+		for (int x = 0; x < width; x++, pixel += channels){
+			uint32_t red = pixel[0], green = pixel[1], blue = pixel[2];
+			ColorHistogramBin &bin = bins[(red >> 3) << 10 | (green >> 3) << 5 | (blue >> 3)];
+			bin.count++;
+			bin.sum[0] += red;
+			bin.sum[1] += green;
+			bin.sum[2] += blue;
+			bin.sum_squares += red * red + green * green + blue * blue;
+		}
+	}
+	histogram->pixel_count += uint64_t(width) * height;
+}
+
+void color_histogram_add_image(ColorHistogram *histogram, const uint8_t *pixels, int width, int height, int rowstride, int channels){
+	if (width <= 0 || height <= 0) return;
+	uint64_t pixel_count = uint64_t(width) * height;
+	size_t thread_count = std::min<uint64_t>(std::min<uint64_t>(std::max(thread::hardware_concurrency(), 1u), (pixel_count + MIN_PIXELS_PER_THREAD - 1) / MIN_PIXELS_PER_THREAD), height);
+	auto band_start = [height, thread_count](size_t band){
+		return int(uint64_t(height) * band / thread_count);
+	};
+	vector<ColorHistogram*> band_histograms(thread_count, nullptr);
+	vector<thread> threads;
+	for (size_t i = 1; i < thread_count; i++){
+		band_histograms[i] = color_histogram_new();
+		threads.emplace_back(color_histogram_add_rows, band_histograms[i], pixels + size_t(rowstride) * band_start(i), width, band_start(i + 1) - band_start(i), rowstride, channels);
+	}
+	color_histogram_add_rows(histogram, pixels, width, band_start(1), rowstride, channels);
+	for (size_t i = 1; i < thread_count; i++){
+		threads[i - 1].join();
+		color_histogram_merge(histogram, band_histograms[i]);
+		color_histogram_destroy(band_histograms[i]);
+	}
+}
+
+void color_histogram_add_bin(ColorHistogram *histogram, int index, const ColorHistogramBin *bin){
+	ColorHistogramBin &target = histogram->bins[index];
+	target.count += bin->count;
+	for (int j = 0; j < 3; j++)
+		target.sum[j] += bin->sum[j];
+	target.sum_squares += bin->sum_squares;
+	histogram->pixel_count += bin->count;
+}
+
+void color_histogram_merge(ColorHistogram *histogram, const ColorHistogram *other){
+	for (int i = 0; i < COLOR_HISTOGRAM_SIZE; i++){
+		ColorHistogramBin &bin = histogram->bins[i];
+		const ColorHistogramBin &other_bin = other->bins[i];
+		bin.count += other_bin.count;
+		for (int j = 0; j < 3; j++)
+			bin.sum[j] += other_bin.sum[j];
+		bin.sum_squares += other_bin.sum_squares;
+	}
+	histogram->pixel_count += other->pixel_count;
+}
+
+const ColorHistogramBin* color_histogram_get_bins(const ColorHistogram *histogram){
+	return &histogram->bins.front();
+}
+
+uint64_t color_histogram_get_pixel_count(const ColorHistogram *histogram){
+	return histogram->pixel_count;
+}
+
+void color_histogram_destroy(ColorHistogram *histogram){
+	delete histogram;
+}
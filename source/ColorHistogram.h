@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_COLOR_HISTOGRAM_H_
+#define GPICK_COLOR_HISTOGRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** \file source/ColorHistogram.h
+ * \brief Dense histogram of 8 bit RGB pixels with 5 bits per channel.
+ *
+ * Each bin keeps pixel count, component sums and sum of squared components, so mean colors and variances of bins
+ * and bin groups can be calculated without the pixels. Bin index is (red >> 3) << 10 | (green >> 3) << 5 | (blue >> 3).
+ */
+
+/** Number of bits of each color component used to select a bin */
+const int COLOR_HISTOGRAM_BITS = 5;
+/** Number of bins */
+const int COLOR_HISTOGRAM_SIZE = 1 << (COLOR_HISTOGRAM_BITS * 3);
+
+/** \struct ColorHistogramBin
+ * \brief Sums of pixels in a single histogram bin. Component values are in 0 - 255 range.
+ */
+typedef struct ColorHistogramBin{
+	uint64_t count; /**< Number of pixels */
+	uint64_t sum[3]; /**< Sums of red, green and blue components */
+	uint64_t sum_squares; /**< Sum of squared red, green and blue components */
+}ColorHistogramBin;
+
+struct ColorHistogram;
+
+/**
+ * Create empty histogram.
+ * @return New histogram.
+ */
+struct ColorHistogram* color_histogram_new();
+
+/**
+ * Add pixel rows to histogram in the calling thread.
+ * @param[in] histogram Histogram.
+ * @param[in] pixels First pixel of the first row. Pixels start with 8 bit red, green and blue components.
+ * @param[in] width Number of pixels in each row.
+ * @param[in] height Number of rows.
+ * @param[in] rowstride Distance between rows in bytes.
+ * @param[in] channels Number of bytes in each pixel.
+ */
+void color_histogram_add_rows(struct ColorHistogram *histogram, const uint8_t *pixels, int width, int height, int rowstride, int channels);
+
+/**
+ * Add image to histogram. Image is split into row bands, which are counted into separate histograms using multiple threads and merged.
+ * @param[in] histogram Histogram.
+ * @param[in] pixels First pixel of the first row. Pixels start with 8 bit red, green and blue components.
+ * @param[in] width Image width.
+ * @param[in] height Image height.
+ * @param[in] rowstride Distance between rows in bytes.
+ * @param[in] channels Number of bytes in each pixel.
+ */
+void color_histogram_add_image(struct ColorHistogram *histogram, const uint8_t *pixels, int width, int height, int rowstride, int channels);
+
+/**
+ * Add pixel sums of a single bin to histogram.
+ * @param[in] histogram Histogram.
+ * @param[in] index Bin index.
+ * @param[in] bin Pixel sums to add.
+ */
+void color_histogram_add_bin(struct ColorHistogram *histogram, int index, const ColorHistogramBin *bin);
+
+/**
+ * Add all bins of other histogram to histogram.
+ * @param[in] histogram Histogram.
+ * @param[in] other Histogram to add.
+ */
+void color_histogram_merge(struct ColorHistogram *histogram, const struct ColorHistogram *other);
+
+/**
+ * Get histogram bins.
+ * @param[in] histogram Histogram.
+ * @return Array of COLOR_HISTOGRAM_SIZE bins.
+ */
+const ColorHistogramBin* color_histogram_get_bins(const struct ColorHistogram *histogram);
+
+/**
+ * Get number of pixels added to histogram.
+ * @param[in] histogram Histogram.
+ * @return Number of pixels.
+ */
+uint64_t color_histogram_get_pixel_count(const struct ColorHistogram *histogram);
+
+/**
+ * Destroy histogram.
+ * @param[in] histogram Histogram.
+ */
+void color_histogram_destroy(struct ColorHistogram *histogram);
+
+#endif /* GPICK_COLOR_HISTOGRAM_H_ */
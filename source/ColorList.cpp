@@ -19,6 +19,7 @@
 #include "ColorList.h"
 #include "ColorObject.h"
 #include "dynv/DynvSystem.h"
+#include "NameSearch.h"
 #include <algorithm>
 using namespace std;
 
@@ -37,6 +38,8 @@ ColorList* color_list_new(struct dynvHandlerMap* handler_map)
 	color_list->on_delete_selected = nullptr;
 	color_list->on_get_positions = nullptr;
 	color_list->userdata = nullptr;
+	color_list->name_search = nullptr;
+	color_list->name_search_dirty = true;
 	return color_list;
 }
 ColorList* color_list_new_with_one_color(ColorList *template_color_list, const Color *color)
@@ -53,6 +56,7 @@ void color_list_destroy(ColorList* color_list)
 	}
 	color_list->colors.clear();
 	if (color_list->params) dynv_system_release(color_list->params);
+	if (color_list->name_search) name_search_destroy(color_list->name_search);
 	delete color_list;
 }
 ColorObject* color_list_new_color_object(ColorList* color_list, const Color *color)
@@ -74,6 +78,7 @@ ColorObject* color_list_add_color(ColorList *color_list, const Color *color)
 int color_list_add_color_object(ColorList *color_list, ColorObject *color_object, int add_to_palette)
 {
 	color_list->colors.push_back(color_object->reference());
+	color_list->name_search_dirty = true;
 	if (add_to_palette && color_list->on_insert)
 		color_list->on_insert(color_list, color_object);
 	return 0;
@@ -84,6 +89,7 @@ int color_list_remove_color_object(ColorList *color_list, ColorObject *color_obj
 	if (i != color_list->colors.end()){
 		if (color_list->on_delete) color_list->on_delete(color_list, color_object);
 		color_list->colors.erase(i);
+		color_list->name_search_dirty = true;
 		color_object->release();
 		return 0;
 	}else return -1;
@@ -95,6 +101,7 @@ int color_list_remove_selected(ColorList *color_list)
 		if ((*i)->isSelected()){
 			(*i)->release();
 			i = color_list->colors.erase(i);
+			color_list->name_search_dirty = true;
 		}else ++i;
 	}
 	color_list->on_delete_selected(color_list);
@@ -115,6 +122,7 @@ int color_list_remove_all(ColorList *color_list)
 		}
 	}
 	color_list->colors.clear();
+	color_list->name_search_dirty = true;
 	return 0;
 }
 size_t color_list_get_count(ColorList *color_list)
@@ -136,3 +144,41 @@ int color_list_get_positions(ColorList *color_list)
 	}
 	return 0;
 }
+/**
+ * Check if name index has to be rebuilt. Color objects are renamed without notifying color list, so indexed names are compared with current ones.
+ */
+static bool color_list_name_search_changed(ColorList *color_list)
+{
+	if (color_list->name_search_dirty || !color_list->name_search) return true;
+	for (size_t i = 0; i < color_list->name_search_colors.size(); i++){
+		if (color_list->name_search_colors[i]->getName() != color_list->name_search_names[i])
+			return true;
+	}
+	return false;
+}
+static void color_list_name_search_build(ColorList *color_list)
+{
+	if (color_list->name_search) name_search_destroy(color_list->name_search);
+	color_list->name_search = name_search_new();
+	color_list->name_search_colors.assign(color_list->colors.begin(), color_list->colors.end());
+	color_list->name_search_names.clear();
+	for (auto color_object: color_list->name_search_colors)
+		color_list->name_search_names.push_back(color_object->getName());
+	// names are not copied by name search, so they are added only when vector no longer grows
+	for (size_t i = 0; i < color_list->name_search_names.size(); i++)
+		name_search_add(color_list->name_search, color_list->name_search_names[i].c_str(), i);
+	name_search_build(color_list->name_search);
+	color_list->name_search_dirty = false;
+}
+size_t color_list_find_by_name(ColorList *color_list, const char *query, size_t max_matches, std::vector<ColorObject*> &matches)
+{
+	if (color_list_name_search_changed(color_list))
+		color_list_name_search_build(color_list);
+	vector<NameSearchMatch> name_matches(max_matches);
+	size_t count = name_search_find(color_list->name_search, query, max_matches, name_matches.data());
+	matches.clear();
+	for (size_t i = 0; i < count; i++){
+		matches.push_back(color_list->name_search_colors[name_matches[i].id]);
+	}
+	return count;
+}
@@ -21,8 +21,11 @@
 
 class ColorObject;
 struct dynvSystem;
+struct NameSearch;
 #include "Color.h"
 #include <list>
+#include <vector>
+#include <string>
 #include <cstddef>
 
 class ColorList
@@ -38,6 +41,10 @@ class ColorList
 		int (*on_clear)(ColorList *color_list);
 		int (*on_get_positions)(ColorList *color_list);
 		void* userdata;
+		NameSearch *name_search; /**< Name index used by color_list_find_by_name, built on first search */
+		std::vector<ColorObject*> name_search_colors; /**< Indexed color objects, which are not referenced */
+		std::vector<std::string> name_search_names; /**< Names of color objects when they were indexed */
+		bool name_search_dirty; /**< Colors were added or removed after name index was built */
 };
 
 ColorList* color_list_new(struct dynvHandlerMap *handler_map);
@@ -51,5 +58,14 @@ int color_list_remove_selected(ColorList *color_list);
 int color_list_remove_all(ColorList *color_list);
 size_t color_list_get_count(ColorList *color_list);
 int color_list_get_positions(ColorList *color_list);
+/**
+ * Find color objects by name using prefix and fuzzy matching. Name index is kept between searches and rebuilt when colors are added, removed or renamed.
+ * @param[in] color_list Color list.
+ * @param[in] query Search query.
+ * @param[in] max_matches Maximum number of matches.
+ * @param[out] matches Receives matching color objects sorted by match score. Color objects are not referenced.
+ * @return Number of matches.
+ */
+size_t color_list_find_by_name(ColorList *color_list, const char *query, size_t max_matches, std::vector<ColorObject*> &matches);
 
 #endif /* GPICK_COLOR_LIST_H_ */
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ColorOctree.h"
+#include <algorithm>
+#include <limits>
+using namespace std;
+
+/** \struct ColorOctreeNode
+ * \brief Node is a cube in color space with color information.
+ */
+typedef struct ColorOctreeNode{
+	uint32_t n_pixels_in; /**< Number of colors in current node */
+	float color[3]; /**< Sum of color values */
+	float distance; /**< Squared distances from node center of colors in node and its children */
+	uint32_t child[8]; /**< Indexes of child nodes. Zero when child does not exist, as root node can not be a child */
+	uint32_t parent; /**< Index of parent node */
+}ColorOctreeNode;
+
+struct ColorOctree{
+	vector<ColorOctreeNode> nodes; /**< Nodes, parent nodes are always stored before their children */
+	uint32_t max_depth;
+	bool prepared;
+	vector<float> collapse; /**< Pruning threshold at which node is merged into its parent */
+	vector<float> appear; /**< Pruning threshold at which node starts holding colors */
+	vector<float> sorted_collapse;
+	vector<float> sorted_appear;
+	vector<uint32_t> subtree_pixels;
+	vector<double> subtree_color;
+	vector<uint32_t> stack;
+};
+
+static void color_octree_add_node(ColorOctree *octree, uint32_t parent){
+	ColorOctreeNode node;
+	node.n_pixels_in = 0;
+	node.color[0] = node.color[1] = node.color[2] = 0;
+	node.distance = 0;
+	for (int i = 0; i < 8; i++)
+		node.child[i] = 0;
+	node.parent = parent;
+	octree->nodes.push_back(node);
+}
+
+ColorOctree* color_octree_new(uint32_t max_depth){
+	ColorOctree *octree = new ColorOctree;
+	octree->max_depth = max_depth;
+	octree->prepared = false;
+	color_octree_add_node(octree, 0);
+	return octree;
+}
+
+/**
+ * Get child node containing a value and move position to the corner of the child node cube. Child node is created when it does not exist.
+ * @param[in] octree Octree.
+ * @param[in] index Node index.
+ * @param[in] value Color component values.
+ * @param[in,out] position Corner of the node cube.
+ * @param[in] half_size Half of the node cube size.
+ * @return Child node index.
+ */
+static uint32_t color_octree_get_child(ColorOctree *octree, uint32_t index, const float value[3], float position[3], float half_size){
+	int child = 0;
+	for (int i = 0; i < 3; i++){
+		if (value[i] - position[i] >= half_size){
+			position[i] += half_size;
+			child |= 1 << i;
+		}
+	}
+	if (!octree->nodes[index].child[child]){
+		octree->nodes[index].child[child] = octree->nodes.size();
+		color_octree_add_node(octree, index);
+	}
+	return octree->nodes[index].child[child];
+}
+
+void color_octree_add(ColorOctree *octree, const Color *color){
+	float position[3] = {0, 0, 0}, size = 1;
+	const float value[3] = {color->rgb.red, color->rgb.green, color->rgb.blue};
+	uint32_t index = 0;
+	for (uint32_t depth = octree->max_depth; ; depth--){
+		float half_size = size / 2;
+		ColorOctreeNode &node = octree->nodes[index];
+		for (int i = 0; i < 3; i++)
+			node.distance += (value[i] - (position[i] + half_size)) * (value[i] - (position[i] + half_size));
+		if (!depth){
+			node.n_pixels_in++;
+			for (int i = 0; i < 3; i++)
+				node.color[i] += value[i];
+			break;
+		}
+		index = color_octree_get_child(octree, index, value, position, half_size);
+		size = half_size;
+	}
+	octree->prepared = false;
+}
+
+void color_octree_add_group(ColorOctree *octree, uint32_t count, const double sum[3], double sum_squares){
+	if (!count) return;
+	float position[3] = {0, 0, 0}, size = 1;
+	const float value[3] = {float(sum[0] / count), float(sum[1] / count), float(sum[2] / count)};
+	uint32_t index = 0;
+	for (uint32_t depth = octree->max_depth; ; depth--){
+		float half_size = size / 2;
+		ColorOctreeNode &node = octree->nodes[index];
+		// sum of (value - center) ^ 2 expanded into sums of values and squared values
+		double distance = sum_squares;
+		for (int i = 0; i < 3; i++){
+			double center = position[i] + half_size;
+			distance += center * (center * count - 2 * sum[i]);
+		}
+		node.distance += max(distance, 0.0);
+		if (!depth){
+			node.n_pixels_in += count;
+			for (int i = 0; i < 3; i++)
+				node.color[i] += sum[i];
+			break;
+		}
+		index = color_octree_get_child(octree, index, value, position, half_size);
+		size = half_size;
+	}
+	octree->prepared = false;
+}
+
+/**
+ * Calculate pruning thresholds and color sums of every subtree.
+ *
+ * Pruning with a threshold merges every node, which has a distance not larger than the threshold, together with its children into its parent node.
+ * Node distances do not change when merging, so the state of the tree depends only on the threshold: a node exists while the
+ * threshold is lower than the smallest distance on its path from root, and holds colors from the threshold at which its first child is merged.
+ * @param[in] octree Octree.
+ */
+static void color_octree_prepare(ColorOctree *octree){
+	if (octree->prepared) return;
+	size_t count = octree->nodes.size();
+	const float infinity = numeric_limits<float>::infinity();
+	octree->collapse.resize(count);
+	octree->appear.resize(count);
+	octree->subtree_pixels.resize(count);
+	octree->subtree_color.resize(count * 3);
+	for (size_t i = 0; i < count; i++){
+		const ColorOctreeNode &node = octree->nodes[i];
+		octree->collapse[i] = i ? min(octree->collapse[node.parent], node.distance) : node.distance;
+		octree->appear[i] = node.n_pixels_in ? -infinity : infinity;
+		octree->subtree_pixels[i] = node.n_pixels_in;
+		for (int j = 0; j < 3; j++)
+			octree->subtree_color[i * 3 + j] = node.color[j];
+	}
+	for (size_t i = count - 1; i > 0; i--){
+		uint32_t parent = octree->nodes[i].parent;
+		octree->appear[parent] = min(octree->appear[parent], octree->collapse[i]);
+		octree->subtree_pixels[parent] += octree->subtree_pixels[i];
+		for (int j = 0; j < 3; j++)
+			octree->subtree_color[parent * 3 + j] += octree->subtree_color[i * 3 + j];
+	}
+	octree->sorted_collapse = octree->collapse;
+	sort(octree->sorted_collapse.begin(), octree->sorted_collapse.end());
+	octree->sorted_appear.clear();
+	for (size_t i = 0; i < count; i++){
+		if (octree->appear[i] != infinity) octree->sorted_appear.push_back(octree->appear[i]);
+	}
+	sort(octree->sorted_appear.begin(), octree->sorted_appear.end());
+	octree->prepared = true;
+}
+
+/**
+ * Find the lowest pruning threshold, which leaves at most specified number of colors. Same thresholds are reached as when increasing the threshold to the smallest remaining node distance until the color count is low enough.
+ * @param[in] octree Prepared octree.
+ * @param[in] colors Maximum number of colors.
+ * @return Pruning threshold.
+ */
+static float color_octree_find_threshold(ColorOctree *octree, uint32_t colors){
+	const vector<float> &appear = octree->sorted_appear, &collapse = octree->sorted_collapse;
+	size_t appeared = 0, collapsed = 0;
+	float threshold = -numeric_limits<float>::infinity();
+	for (;;){
+		while (appeared < appear.size() && appear[appeared] <= threshold) appeared++;
+		while (collapsed < collapse.size() && collapse[collapsed] <= threshold) collapsed++;
+		if (appeared <= collapsed + colors || collapsed == collapse.size()) return threshold;
+		threshold = collapse[collapsed];
+	}
+}
+
+/**
+ * Get nodes remaining after pruning in depth first order.
+ * @param[in] octree Prepared octree.
+ * @param[in] threshold Pruning threshold.
+ * @param[out] nodes Indexes of remaining nodes.
+ */
+static void color_octree_get_remaining(ColorOctree *octree, float threshold, vector<uint32_t> &nodes){
+	nodes.clear();
+	vector<uint32_t> &stack = octree->stack;
+	stack.clear();
+	if (octree->collapse[0] > threshold) stack.push_back(0);
+	while (!stack.empty()){
+		uint32_t index = stack.back();
+		stack.pop_back();
+		nodes.push_back(index);
+		const ColorOctreeNode &node = octree->nodes[index];
+		for (int i = 7; i >= 0; i--){
+			if (node.child[i] && octree->collapse[node.child[i]] > threshold) stack.push_back(node.child[i]);
+		}
+	}
+}
+
+/**
+ * Get colors of a remaining node together with colors of merged children.
+ * @param[in] octree Prepared octree.
+ * @param[in] index Node index.
+ * @param[in] threshold Pruning threshold.
+ * @param[out] color Sum of color values.
+ * @return Number of colors.
+ */
+static uint32_t color_octree_get_merged(ColorOctree *octree, uint32_t index, float threshold, double color[3]){
+	const ColorOctreeNode &node = octree->nodes[index];
+	uint32_t pixels = node.n_pixels_in;
+	for (int j = 0; j < 3; j++)
+		color[j] = node.color[j];
+	for (int i = 0; i < 8; i++){
+		uint32_t child = node.child[i];
+		if (!child || octree->collapse[child] > threshold) continue;
+		pixels += octree->subtree_pixels[child];
+		for (int j = 0; j < 3; j++)
+			color[j] += octree->subtree_color[child * 3 + j];
+	}
+	return pixels;
+}
+
+void color_octree_reduce(ColorOctree *octree, uint32_t colors){
+	color_octree_prepare(octree);
+	float threshold = color_octree_find_threshold(octree, colors);
+	vector<uint32_t> remaining;
+	color_octree_get_remaining(octree, threshold, remaining);
+	vector<ColorOctreeNode> nodes;
+	nodes.reserve(max<size_t>(remaining.size(), 1));
+	vector<uint32_t> new_index(octree->nodes.size());
+	for (auto index: remaining){
+		const ColorOctreeNode &node = octree->nodes[index];
+		ColorOctreeNode new_node = node;
+		double color[3];
+		new_node.n_pixels_in = color_octree_get_merged(octree, index, threshold, color);
+		for (int j = 0; j < 3; j++)
+			new_node.color[j] = color[j];
+		for (int i = 0; i < 8; i++)
+			new_node.child[i] = 0;
+		new_index[index] = nodes.size();
+		if (index){
+			new_node.parent = new_index[node.parent];
+			ColorOctreeNode &parent = nodes[new_node.parent];
+			for (int i = 0; i < 8; i++){
+				if (octree->nodes[node.parent].child[i] == index) parent.child[i] = nodes.size();
+			}
+		}
+		nodes.push_back(new_node);
+	}
+	octree->nodes.swap(nodes);
+	// all colors are lost when root node is merged
+	if (octree->nodes.empty()) color_octree_add_node(octree, 0);
+	octree->prepared = false;
+}
+
+void color_octree_get_colors(ColorOctree *octree, uint32_t colors, vector<Color> &result){
+	result.clear();
+	color_octree_prepare(octree);
+	float threshold = color_octree_find_threshold(octree, colors);
+	vector<uint32_t> remaining;
+	color_octree_get_remaining(octree, threshold, remaining);
+	for (auto index: remaining){
+		double color[3];
+		uint32_t pixels = color_octree_get_merged(octree, index, threshold, color);
+		if (!pixels) continue;
+		Color c;
+		c.rgb.red = color[0] / pixels;
+		c.rgb.green = color[1] / pixels;
+		c.rgb.blue = color[2] / pixels;
+		result.push_back(c);
+	}
+}
+
+size_t color_octree_get_node_count(ColorOctree *octree){
+	return octree->nodes.size();
+}
+
+void color_octree_destroy(ColorOctree *octree){
+	delete octree;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_COLOR_OCTREE_H_
+#define GPICK_COLOR_OCTREE_H_
+
+#include "Color.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/** \file source/ColorOctree.h
+ * \brief Octree color quantizer used to extract palettes from images.
+ *
+ * Nodes are stored in a single contiguous array and reference their children by index. Reducing the tree to a color
+ * count does not modify it, so the same tree can be queried for different color counts without copying it.
+ */
+
+struct ColorOctree;
+
+/**
+ * Create empty octree.
+ * @param[in] max_depth Depth of leaf nodes. Colors are split into 8 ^ max_depth cubes.
+ * @return New octree.
+ */
+struct ColorOctree* color_octree_new(uint32_t max_depth);
+
+/**
+ * Add color to octree.
+ * @param[in] octree Octree.
+ * @param[in] color Color in RGB color space.
+ */
+void color_octree_add(struct ColorOctree *octree, const Color *color);
+
+/**
+ * Add a group of colors to octree. All colors of the group have to belong to the same leaf node.
+ * @param[in] octree Octree.
+ * @param[in] count Number of colors.
+ * @param[in] sum Sums of red, green and blue components.
+ * @param[in] sum_squares Sum of squared red, green and blue components.
+ */
+void color_octree_add_group(struct ColorOctree *octree, uint32_t count, const double sum[3], double sum_squares);
+
+/**
+ * Permanently merge nodes until the tree contains at most specified number of colors. Remaining nodes are moved into a new, compact node array.
+ * @param[in] octree Octree.
+ * @param[in] colors Maximum number of colors.
+ */
+void color_octree_reduce(struct ColorOctree *octree, uint32_t colors);
+
+/**
+ * Get colors of the tree reduced to specified number of colors. Octree is not modified.
+ * @param[in] octree Octree.
+ * @param[in] colors Maximum number of colors.
+ * @param[out] result Colors in RGB color space, ordered by position in the tree.
+ */
+void color_octree_get_colors(struct ColorOctree *octree, uint32_t colors, std::vector<Color> &result);
+
+/**
+ * Get number of nodes in the tree.
+ * @param[in] octree Octree.
+ * @return Number of nodes.
+ */
+size_t color_octree_get_node_count(struct ColorOctree *octree);
+
+/**
+ * Destroy octree.
+ * @param[in] octree Octree.
+ */
+void color_octree_destroy(struct ColorOctree *octree);
+
+#endif /* GPICK_COLOR_OCTREE_H_ */
@@ -43,6 +43,7 @@
 #include "Internationalisation.h"
 #include "color_names/ColorNames.h"
 #include "Sampler.h"
+#include "CaptureBroker.h"
 #include <gdk/gdkkeysyms.h>
 #include <math.h>
 #ifdef _MSC_VER
@@ -83,7 +84,7 @@ typedef struct ColorPickerArgs{
 	GtkWidget *contrastCheck;
 	GtkWidget *contrastCheckMsg;
 	GtkWidget *pick_button;
-	guint timeout_source_id;
+	CaptureConsumer *capture;
 	FloatingPicker floating_picker;
 	struct dynvSystem *params;
 	struct dynvSystem *global_params;
@@ -112,46 +113,40 @@ static void updateMainColorNow(ColorPickerArgs* args)
 	}
 }
 
-static gboolean updateMainColor( gpointer data ){
-	ColorPickerArgs* args=(ColorPickerArgs*)data;
-	GdkScreen *screen;
-	GdkModifierType state;
-	int x, y;
-	gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
-	int monitor = gdk_screen_get_monitor_at_point(screen, x, y);
-	GdkRectangle monitor_geometry;
-	gdk_screen_get_monitor_geometry(screen, monitor, &monitor_geometry);
-	Vec2<int> pointer(x,y);
-	Rect2<int> screen_rect(monitor_geometry.x, monitor_geometry.y, monitor_geometry.x + monitor_geometry.width, monitor_geometry.y + monitor_geometry.height);
-	auto screen_reader = args->gs->getScreenReader();
-	screen_reader_reset_rect(screen_reader);
-	Rect2<int> sampler_rect, zoomed_rect, final_rect;
-	sampler_get_screen_rect(args->gs->getSampler(), pointer, screen_rect, &sampler_rect);
-	screen_reader_add_rect(screen_reader, screen, sampler_rect);
-	bool zoomed_enabled = dynv_get_bool_wd(args->params, "zoomed_enabled", true);
-	if (zoomed_enabled){
-		gtk_zoomed_get_screen_rect(GTK_ZOOMED(args->zoomed_display), pointer, screen_rect, &zoomed_rect);
-		screen_reader_add_rect(screen_reader, screen, zoomed_rect);
-	}
-	screen_reader_update_pixbuf(screen_reader, &final_rect);
-	Vec2<int> offset;
-	offset = Vec2<int>(sampler_rect.getX() - final_rect.getX(), sampler_rect.getY() - final_rect.getY());
-	Color c;
-	sampler_get_color_sample(args->gs->getSampler(), pointer, screen_rect, offset, &c);
+static void setMainColor(ColorPickerArgs* args, Color &c)
+{
 	string text;
 	converter_get_text(c, ConverterArrayType::display, args->gs, text);
 	gtk_color_set_color(GTK_COLOR(args->color_code), &c, text.c_str());
 	gtk_swatch_set_main_color(GTK_SWATCH(args->swatch_display), &c);
-	if (zoomed_enabled){
-		offset = Vec2<int>(zoomed_rect.getX()-final_rect.getX(), zoomed_rect.getY()-final_rect.getY());
-		gtk_zoomed_update(GTK_ZOOMED(args->zoomed_display), pointer, screen_rect, offset, screen_reader_get_pixbuf(screen_reader));
-	}
+}
+static void updateMainColorCaptured(const CaptureFrame *frame, ColorPickerArgs* args)
+{
+	Color c = frame->color;
+	setMainColor(args, c);
+	if (dynv_get_bool_wd(args->params, "zoomed_enabled", true))
+		capture_frame_update_zoomed(frame, GTK_ZOOMED(args->zoomed_display));
+}
+static gboolean updateMainColor( gpointer data ){
+	ColorPickerArgs* args=(ColorPickerArgs*)data;
+	CaptureFrame frame;
+	if (capture_broker_capture(args->capture, dynv_get_bool_wd(args->params, "zoomed_enabled", true), &frame))
+		updateMainColorCaptured(&frame, args);
 	return TRUE;
 }
-static gboolean updateMainColorTimer(ColorPickerArgs* args)
+static void updateCaptureZoomed(ColorPickerArgs* args)
 {
-	updateMainColor(args);
-	return true;
+	capture_broker_set_zoomed(args->capture, dynv_get_bool_wd(args->params, "zoomed_enabled", true), gtk_zoomed_get_zoom(GTK_ZOOMED(args->zoomed_display)), gtk_zoomed_get_size(GTK_ZOOMED(args->zoomed_display)));
+	capture_broker_wake(args->gs->getCaptureBroker());
+}
+static void startPicking(ColorPickerArgs* args)
+{
+	updateCaptureZoomed(args);
+	capture_broker_start(args->capture, dynv_get_float_wd(args->global_params, "refresh_rate", 30));
+}
+static void stopPicking(ColorPickerArgs* args)
+{
+	capture_broker_stop(args->capture);
 }
 static void updateComponentText(ColorPickerArgs *args, GtkColorComponent *component, const char *type)
 {
@@ -169,6 +164,22 @@ static void updateComponentText(ColorPickerArgs *args, GtkColorComponent *compon
 	}
 	gtk_color_component_set_text(component, text);
 }
+static void updateColorName(ColorPickerArgs *args, const Color *color)
+{
+	// color names are loaded in background, so name stays empty until they are ready instead of blocking
+	if (!args->gs->isColorNamesReady()){
+		gtk_entry_set_text(GTK_ENTRY(args->color_name), "");
+		return;
+	}
+	string color_name = color_names_get(args->gs->getColorNames(), color, true);
+	gtk_entry_set_text(GTK_ENTRY(args->color_name), color_name.c_str());
+}
+static void onColorNamesReady(ColorPickerArgs *args)
+{
+	Color c;
+	gtk_swatch_get_active_color(GTK_SWATCH(args->swatch_display), &c);
+	updateColorName(args, &c);
+}
 static void updateDisplays(ColorPickerArgs *args, GtkWidget *except_widget)
 {
 	updateMainColorNow(args);
@@ -186,8 +197,7 @@ static void updateDisplays(ColorPickerArgs *args, GtkWidget *except_widget)
 	updateComponentText(args, GTK_COLOR_COMPONENT(args->cmyk_control), "cmyk");
 	updateComponentText(args, GTK_COLOR_COMPONENT(args->lab_control), "lab");
 	updateComponentText(args, GTK_COLOR_COMPONENT(args->lch_control), "lch");
-	string color_name = color_names_get(args->gs->getColorNames(), &c, true);
-	gtk_entry_set_text(GTK_ENTRY(args->color_name), color_name.c_str());
+	updateColorName(args, &c);
 	gtk_color_get_color(GTK_COLOR(args->contrastCheck), &c2);
 	gtk_color_set_text_color(GTK_COLOR(args->contrastCheck), &c);
 	stringstream ss;
@@ -490,11 +500,13 @@ int color_picker_key_up(ColorSource* color_source, GdkEventKey *event){
 static void on_oversample_value_changed(GtkRange *slider, gpointer data){
 	ColorPickerArgs* args=(ColorPickerArgs*)data;
 	sampler_set_oversample(args->gs->getSampler(), (int)gtk_range_get_value(GTK_RANGE(slider)));
+	capture_broker_update_sampler(args->gs->getCaptureBroker());
 }
 
 static void on_zoom_value_changed(GtkRange *slider, gpointer data){
 	ColorPickerArgs* args=(ColorPickerArgs*)data;
 	gtk_zoomed_set_zoom(GTK_ZOOMED(args->zoomed_display), gtk_range_get_value(GTK_RANGE(slider)));
+	updateCaptureZoomed(args);
 }
 
 static void color_component_change_value(GtkWidget *widget, Color* c, ColorPickerArgs* args){
@@ -650,6 +662,7 @@ static void on_oversample_falloff_changed(GtkWidget *widget, gpointer data) {
 
 		ColorPickerArgs* args = (ColorPickerArgs*)data;
 		sampler_set_falloff(args->gs->getSampler(), (enum SamplerFalloff) falloff_id);
+		capture_broker_update_sampler(args->gs->getCaptureBroker());
 
 	}
 }
@@ -737,6 +750,8 @@ static int source_destroy(ColorPickerArgs *args)
 	gtk_color_get_color(GTK_COLOR(args->contrastCheck), &c);
 	dynv_set_color(args->params, "contrast.color", &c);
 
+	capture_broker_remove_consumer(args->capture);
+	args->gs->removeColorNamesReadyCallback((GlobalState::ColorNamesReadyCallback)onColorNamesReady, args);
 	gtk_widget_destroy(args->main);
 
 	dynv_system_release(args->params);
@@ -783,10 +798,7 @@ static int source_set_color(ColorPickerArgs *args, ColorObject* color_object)
 }
 static int source_activate(ColorPickerArgs *args)
 {
-	if (args->timeout_source_id > 0) {
-		g_source_remove(args->timeout_source_id);
-		args->timeout_source_id = 0;
-	}
+	stopPicking(args);
 	struct{
 		GtkWidget *widget;
 		const char *setting;
@@ -823,13 +835,12 @@ static int source_activate(ColorPickerArgs *args)
 	gtk_color_set_transformation_chain(GTK_COLOR(args->color_code), chain);
 	gtk_color_set_transformation_chain(GTK_COLOR(args->contrastCheck), chain);
 
+	gtk_zoomed_set_size(GTK_ZOOMED(args->zoomed_display), dynv_get_int32_wd(args->params, "zoom_size", 150));
+
 	if (dynv_get_bool_wd(args->params, "zoomed_enabled", true)){
-		float refresh_rate = dynv_get_float_wd(args->global_params, "refresh_rate", 30);
-		args->timeout_source_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, 1000/refresh_rate, (GSourceFunc)updateMainColorTimer, args, (GDestroyNotify)nullptr);
+		startPicking(args);
 	}
 
-	gtk_zoomed_set_size(GTK_ZOOMED(args->zoomed_display), dynv_get_int32_wd(args->params, "zoom_size", 150));
-
 	gtk_statusbar_push(GTK_STATUSBAR(args->statusbar), gtk_statusbar_get_context_id(GTK_STATUSBAR(args->statusbar), "focus_swatch"), _("Click on swatch area to begin adding colors to palette"));
 
 	return 0;
@@ -839,10 +850,7 @@ static int source_deactivate(ColorPickerArgs *args){
 
 	gtk_statusbar_pop(GTK_STATUSBAR(args->statusbar), gtk_statusbar_get_context_id(GTK_STATUSBAR(args->statusbar), "focus_swatch"));
 
-	if (args->timeout_source_id > 0){
-		g_source_remove(args->timeout_source_id);
-		args->timeout_source_id = 0;
-	}
+	stopPicking(args);
 	return 0;
 }
 
@@ -898,20 +906,12 @@ static void on_zoomed_activate(GtkWidget *widget, ColorPickerArgs *args){
 		gtk_zoomed_set_fade(GTK_ZOOMED(args->zoomed_display), true);
 		dynv_set_bool(args->params, "zoomed_enabled", false);
 
-		if (args->timeout_source_id > 0){
-			g_source_remove(args->timeout_source_id);
-			args->timeout_source_id = 0;
-		}
+		stopPicking(args);
 	}else{
 		gtk_zoomed_set_fade(GTK_ZOOMED(args->zoomed_display), false);
 		dynv_set_bool(args->params, "zoomed_enabled", true);
 
-		if (args->timeout_source_id > 0){
-			g_source_remove(args->timeout_source_id);
-			args->timeout_source_id = 0;
-		}
-		float refresh_rate = dynv_get_float_wd(args->global_params, "refresh_rate", 30);
-		args->timeout_source_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, 1000/refresh_rate, (GSourceFunc)updateMainColorTimer, args, (GDestroyNotify)nullptr);
+		startPicking(args);
 	}
 	return;
 }
@@ -934,7 +934,7 @@ static ColorSource* source_implement(ColorSource *source, GlobalState *gs, struc
 	args->source.deactivate = (int (*)(ColorSource *source))source_deactivate;
 
 	args->gs = gs;
-	args->timeout_source_id = 0;
+	args->capture = capture_broker_add_consumer(gs->getCaptureBroker(), (CaptureThreadFrameCallback)updateMainColorCaptured, args);
 
 	GtkWidget *vbox, *widget, *expander, *table, *main_hbox, *scrolled;
 	int table_y;
@@ -1185,6 +1185,7 @@ static ColorSource* source_implement(ColorSource *source, GlobalState *gs, struc
 
 					table_y++;
 	updateDisplays(args, 0);
+	gs->addColorNamesReadyCallback((GlobalState::ColorNamesReadyCallback)onColorNamesReady, args);
 	args->main = main_hbox;
 	gtk_widget_show_all(main_hbox);
 	args->source.widget = main_hbox;
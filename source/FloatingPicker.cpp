@@ -31,6 +31,7 @@
 #include "ToolColorNaming.h"
 #include "ScreenReader.h"
 #include "Sampler.h"
+#include "CaptureBroker.h"
 #include "color_names/ColorNames.h"
 #include <gdk/gdkkeysyms.h>
 #include <string>
@@ -43,7 +44,7 @@ typedef struct FloatingPickerArgs
 	GtkWidget* window;
 	GtkWidget* zoomed;
 	GtkWidget* color_widget;
-	guint timeout_source_id;
+	CaptureConsumer *capture;
 	ColorSource *color_source;
 	Converter *converter;
 	GlobalState* gs;
@@ -76,42 +77,18 @@ class PickerColorNameAssigner: public ToolColorNameAssigner
 			return m_stream.str();
 		}
 };
-static void get_color_sample(FloatingPickerArgs *args, bool update_widgets, Color* c)
+static bool get_color_sample(FloatingPickerArgs *args, Color* c)
 {
-	GdkScreen *screen;
-	GdkModifierType state;
-	int x, y;
-	gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
-	int monitor = gdk_screen_get_monitor_at_point(screen, x, y);
-	GdkRectangle monitor_geometry;
-	gdk_screen_get_monitor_geometry(screen, monitor, &monitor_geometry);
-	Vec2<int> pointer(x,y);
-	Rect2<int> screen_rect(monitor_geometry.x, monitor_geometry.y, monitor_geometry.x + monitor_geometry.width, monitor_geometry.y + monitor_geometry.height);
-	auto screen_reader = args->gs->getScreenReader();
-	screen_reader_reset_rect(screen_reader);
-	Rect2<int> sampler_rect, zoomed_rect, final_rect;
-	sampler_get_screen_rect(args->gs->getSampler(), pointer, screen_rect, &sampler_rect);
-	screen_reader_add_rect(screen_reader, screen, sampler_rect);
-	if (update_widgets){
-		gtk_zoomed_get_screen_rect(GTK_ZOOMED(args->zoomed), pointer, screen_rect, &zoomed_rect);
-		screen_reader_add_rect(screen_reader, screen, zoomed_rect);
-	}
-	screen_reader_update_pixbuf(screen_reader, &final_rect);
-	Vec2<int> offset;
-	offset = Vec2<int>(sampler_rect.getX() - final_rect.getX(), sampler_rect.getY() - final_rect.getY());
-	sampler_get_color_sample(args->gs->getSampler(), pointer, screen_rect, offset, c);
-	if (update_widgets){
-		offset = Vec2<int>(zoomed_rect.getX() - final_rect.getX(), zoomed_rect.getY() - final_rect.getY());
-		gtk_zoomed_update(GTK_ZOOMED(args->zoomed), pointer, screen_rect, offset, screen_reader_get_pixbuf(screen_reader));
-	}
+	CaptureFrame frame;
+	color_zero(c);
+	if (!capture_broker_capture(args->capture, false, &frame))
+		return false;
+	*c = frame.color;
+	return true;
 }
-static gboolean update_display(FloatingPickerArgs *args)
+static void update_window_position(FloatingPickerArgs *args, GdkScreen *screen, int x, int y)
 {
-	GdkScreen *screen;
-	GdkModifierType state;
-	int x, y;
 	int width, height;
-	gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
 	width = gdk_screen_get_width(screen);
 	height = gdk_screen_get_height(screen);
 	gint sx, sy;
@@ -130,8 +107,9 @@ static gboolean update_display(FloatingPickerArgs *args)
 		gtk_window_set_screen(GTK_WINDOW(args->window), screen);
 	}
 	gtk_window_move(GTK_WINDOW(args->window), x, y);
-	Color c;
-	get_color_sample(args, true, &c);
+}
+static void update_color_widget(FloatingPickerArgs *args, Color &c)
+{
 	string text;
 	if (args->converter != nullptr){
 		auto color_object = color_list_new_color_object(args->gs->getColorList(), &c);
@@ -141,7 +119,30 @@ static gboolean update_display(FloatingPickerArgs *args)
 		converter_get_text(c, ConverterArrayType::display, args->gs, text);
 	}
 	gtk_color_set_color(GTK_COLOR(args->color_widget), &c, text.c_str());
-	return true;
+}
+static void update_display_captured(const CaptureFrame *frame, FloatingPickerArgs *args)
+{
+	update_window_position(args, gtk_window_get_screen(GTK_WINDOW(args->window)), frame->pointer.x, frame->pointer.y);
+	capture_frame_update_zoomed(frame, GTK_ZOOMED(args->zoomed));
+	Color c = frame->color;
+	update_color_widget(args, c);
+}
+static void update_display(FloatingPickerArgs *args)
+{
+	GdkScreen *screen;
+	GdkModifierType state;
+	int x, y;
+	gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
+	update_window_position(args, screen, x, y);
+	CaptureFrame frame;
+	if (!capture_broker_capture(args->capture, true, &frame))
+		return;
+	update_display_captured(&frame, args);
+}
+static void update_capture_zoomed(FloatingPickerArgs *args)
+{
+	capture_broker_set_zoomed(args->capture, true, gtk_zoomed_get_zoom(GTK_ZOOMED(args->zoomed)), gtk_zoomed_get_size(GTK_ZOOMED(args->zoomed)));
+	capture_broker_wake(args->gs->getCaptureBroker());
 }
 void floating_picker_activate(FloatingPickerArgs *args, bool hide_on_mouse_release, bool single_pick_mode, const char *converter_name)
 {
@@ -157,12 +158,13 @@ void floating_picker_activate(FloatingPickerArgs *args, bool hide_on_mouse_relea
 	GdkCursor* cursor;
 	cursor = gdk_cursor_new(GDK_TCROSS);
 	gtk_zoomed_set_zoom(GTK_ZOOMED(args->zoomed), dynv_get_float_wd(args->gs->getSettings(), "gpick.picker.zoom", 2));
+	update_capture_zoomed(args);
 	update_display(args);
 	gtk_widget_show(args->window);
 	gdk_pointer_grab(args->window->window, false, GdkEventMask(GDK_POINTER_MOTION_MASK | GDK_BUTTON_RELEASE_MASK | GDK_BUTTON_PRESS_MASK), nullptr, cursor, GDK_CURRENT_TIME);
 	gdk_keyboard_grab(args->window->window, false, GDK_CURRENT_TIME);
 	float refresh_rate = dynv_get_float_wd(args->gs->getSettings(), "gpick.picker.refresh_rate", 30);
-	args->timeout_source_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, 1000 / refresh_rate, (GSourceFunc)update_display, args, (GDestroyNotify)nullptr);
+	capture_broker_start(args->capture, refresh_rate);
 	gdk_cursor_destroy(cursor);
 #endif
 }
@@ -170,10 +172,7 @@ void floating_picker_deactivate(FloatingPickerArgs *args)
 {
 	gdk_pointer_ungrab(GDK_CURRENT_TIME);
 	gdk_keyboard_ungrab(GDK_CURRENT_TIME);
-	if (args->timeout_source_id > 0){
-		g_source_remove(args->timeout_source_id);
-		args->timeout_source_id = 0;
-	}
+	capture_broker_stop(args->capture);
 	gtk_widget_hide(args->window);
 }
 static gboolean scroll_event_cb(GtkWidget *widget, GdkEventScroll *event, FloatingPickerArgs *args)
@@ -185,8 +184,14 @@ static gboolean scroll_event_cb(GtkWidget *widget, GdkEventScroll *event, Floati
 		zoom -= 1;
 	}
 	gtk_zoomed_set_zoom(GTK_ZOOMED(args->zoomed), zoom);
+	update_capture_zoomed(args);
 	return TRUE;
 }
+static gboolean motion_notify_cb(GtkWidget *widget, GdkEventMotion *event, FloatingPickerArgs *args)
+{
+	capture_broker_wake(args->gs->getCaptureBroker());
+	return FALSE;
+}
 static void finish_picking(FloatingPickerArgs *args)
 {
 	floating_picker_deactivate(args);
@@ -198,7 +203,7 @@ static void complete_picking(FloatingPickerArgs *args)
 {
 	if (args->release_mode || args->click_mode){
 		Color c;
-		get_color_sample(args, false, &c);
+		get_color_sample(args, &c);
 		if (args->perform_custom_pick_action){
 			if (args->custom_pick_action)
 				args->custom_pick_action(args, c);
@@ -224,7 +229,7 @@ static void complete_picking(FloatingPickerArgs *args)
 static void show_copy_menu(int button, int event_time, FloatingPickerArgs *args)
 {
 	Color c;
-	get_color_sample(args, false, &c);
+	get_color_sample(args, &c);
 	GtkWidget *menu;
 	ColorList *color_list = color_list_new_with_one_color(args->gs->getColorList(), &c);
 	menu = CopyMenu::newMenu(*color_list->colors.begin(), args->gs);
@@ -324,12 +329,14 @@ static gboolean key_up_cb(GtkWidget *widget, GdkEventKey *event, FloatingPickerA
 }
 static void destroy_cb(GtkWidget *widget, FloatingPickerArgs *args)
 {
+	capture_broker_remove_consumer(args->capture);
 	delete args;
 }
 FloatingPickerArgs* floating_picker_new(GlobalState *gs)
 {
 	FloatingPickerArgs *args = new FloatingPickerArgs;
 	args->gs = gs;
+	args->capture = capture_broker_add_consumer(gs->getCaptureBroker(), (CaptureThreadFrameCallback)update_display_captured, args);
 	args->window = gtk_window_new(GTK_WINDOW_POPUP);
 	args->color_source = nullptr;
 	args->perform_custom_pick_action = false;
@@ -348,6 +355,7 @@ FloatingPickerArgs* floating_picker_new(GlobalState *gs)
 	gtk_widget_show(args->color_widget);
 	gtk_box_pack_start(GTK_BOX(vbox), args->color_widget, true, true, 0);
 	g_signal_connect(G_OBJECT(args->window), "scroll_event", G_CALLBACK(scroll_event_cb), args);
+	g_signal_connect(G_OBJECT(args->window), "motion-notify-event", G_CALLBACK(motion_notify_cb), args);
 	g_signal_connect(G_OBJECT(args->window), "button-press-event", G_CALLBACK(button_press_cb), args);
 	g_signal_connect(G_OBJECT(args->window), "button-release-event", G_CALLBACK(button_release_cb), args);
 	g_signal_connect(G_OBJECT(args->window), "key_press_event", G_CALLBACK(key_up_cb), args);
@@ -24,6 +24,7 @@
 #include "color_names/DownloadNameFile.h"
 #include "color_names/ColorNames.h"
 #include "Sampler.h"
+#include "CaptureBroker.h"
 #include "ColorList.h"
 #include "layout/LuaBindings.h"
 #include "layout/Layout.h"
@@ -47,14 +48,25 @@ extern "C"{
 }
 #include <fstream>
 #include <iostream>
+#include <future>
+#include <vector>
+#include <utility>
+#include <algorithm>
 using namespace std;
 
 class GlobalState::Impl
 {
 	public:
 		ColorNames *m_color_names;
+		GMappedFile *m_color_names_database;
+		shared_future<void> m_color_names_ready;
+		gint64 m_color_names_load_time;
+		bool m_color_names_waited;
+		bool m_color_names_announced;
+		vector<pair<GlobalState::ColorNamesReadyCallback, void*>> m_color_names_ready_callbacks;
 		Sampler *m_sampler;
 		ScreenReader *m_screen_reader;
+		CaptureBroker *m_capture_broker;
 		ColorList *m_color_list;
 		dynvSystem *m_settings;
 		lua_State *m_lua;
@@ -66,8 +78,13 @@ class GlobalState::Impl
 		ColorSource *m_color_source;
 		Impl():
 			m_color_names(nullptr),
+			m_color_names_database(nullptr),
+			m_color_names_load_time(0),
+			m_color_names_waited(false),
+			m_color_names_announced(false),
 			m_sampler(nullptr),
 			m_screen_reader(nullptr),
+			m_capture_broker(nullptr),
 			m_color_list(nullptr),
 			m_settings(nullptr),
 			m_lua(nullptr),
@@ -91,8 +108,22 @@ class GlobalState::Impl
 				color_list_destroy(m_color_list);
 			if (m_random != nullptr)
 				random_destroy(m_random);
-			if (m_color_names != nullptr)
+			if (m_color_names_ready.valid())
+				m_color_names_ready.wait();
+			g_idle_remove_by_data(this);
+			if (m_color_names != nullptr){
+#ifndef NDEBUG
+				uint64_t lookups, hits;
+				color_names_get_cache_statistics(m_color_names, &lookups, &hits);
+				if (lookups > 0)
+					cerr << "Color names cache: " << hits << " of " << lookups << " lookups (" << 100.0 * hits / lookups << "%) were hits" << endl;
+#endif
 				color_names_destroy(m_color_names);
+			}
+			if (m_color_names_database != nullptr)
+				g_mapped_file_unref(m_color_names_database);
+			if (m_capture_broker != nullptr)
+				capture_broker_destroy(m_capture_broker);
 			if (m_sampler != nullptr)
 				sampler_destroy(m_sampler);
 			if (m_screen_reader != nullptr)
@@ -175,10 +206,52 @@ class GlobalState::Impl
 			g_free(user_init_file);
 			return true;
 		}
+		bool loadColorNamesDatabase(const gchar* filename, uint64_t source_hash)
+		{
+			GMappedFile *mapped_file = g_mapped_file_new(filename, false, nullptr);
+			if (mapped_file == nullptr) return false;
+			if (color_names_load_from_memory(m_color_names, g_mapped_file_get_contents(mapped_file), g_mapped_file_get_length(mapped_file), source_hash) != 0){
+				g_mapped_file_unref(mapped_file);
+				return false;
+			}
+			m_color_names_database = mapped_file;
+			return true;
+		}
+		bool loadPrecompiledColorNames()
+		{
+			gchar* names_file = build_filename("colors.txt");
+			gchar* extra_names_file = build_filename("colors0.txt");
+			const char* source_files[] = {names_file, extra_names_file};
+			uint64_t source_hash;
+			if (color_names_source_hash(source_files, 2, &source_hash) != 0){
+				g_free(names_file);
+				g_free(extra_names_file);
+				return false;
+			}
+			gchar* database_file = build_filename("colors.db");
+			gchar* cache_file = build_config_path("colors.db");
+			if (!loadColorNamesDatabase(database_file, source_hash) && !loadColorNamesDatabase(cache_file, source_hash)){
+				// installed database is missing or stale, so parse text files and cache the result for the next start
+				color_names_load_from_file(m_color_names, names_file);
+				color_names_load_from_file(m_color_names, extra_names_file);
+				gchar* tmp_file = build_config_path("colors.db.tmp");
+				if (color_names_save_database(m_color_names, tmp_file, source_hash) == 0)
+					g_rename(tmp_file, cache_file);
+				else
+					g_remove(tmp_file);
+				g_free(tmp_file);
+			}
+			g_free(database_file);
+			g_free(cache_file);
+			g_free(names_file);
+			g_free(extra_names_file);
+			return true;
+		}
 		bool loadColorNames()
 		{
 			if (m_color_names != nullptr) return false;
 			m_color_names = color_names_new();
+			if (loadPrecompiledColorNames()) return true;
 			gchar* tmp;
 			if (color_names_load_from_file(m_color_names, tmp = build_filename("colors.txt")) != 0){
 				g_free(tmp);
@@ -192,6 +265,54 @@ class GlobalState::Impl
 			g_free(tmp);
 			return true;
 		}
+		void startLoadingColorNames()
+		{
+			m_color_names_ready = async(launch::async, [this]{
+				gint64 start_time = g_get_monotonic_time();
+				loadColorNames();
+				m_color_names_load_time = g_get_monotonic_time() - start_time;
+				g_idle_add((GSourceFunc)onColorNamesLoaded, this);
+			}).share();
+		}
+		static gboolean onColorNamesLoaded(Impl *impl)
+		{
+			// callbacks are called only once
+			impl->m_color_names_announced = true;
+			auto callbacks = std::move(impl->m_color_names_ready_callbacks);
+			impl->m_color_names_ready_callbacks.clear();
+			for (auto &callback: callbacks)
+				callback.first(callback.second);
+			return false;
+		}
+		bool isColorNamesReady()
+		{
+			if (m_color_names_waited || !m_color_names_ready.valid()) return true;
+			return m_color_names_ready.wait_for(chrono::seconds(0)) == future_status::ready;
+		}
+		void addColorNamesReadyCallback(GlobalState::ColorNamesReadyCallback callback, void *userdata)
+		{
+			// names are already loaded if callbacks were called, as both happen in the main thread
+			if (m_color_names_announced || !m_color_names_ready.valid()) return;
+			m_color_names_ready_callbacks.push_back(make_pair(callback, userdata));
+		}
+		void removeColorNamesReadyCallback(GlobalState::ColorNamesReadyCallback callback, void *userdata)
+		{
+			auto &callbacks = m_color_names_ready_callbacks;
+			callbacks.erase(remove(callbacks.begin(), callbacks.end(), make_pair(callback, userdata)), callbacks.end());
+		}
+		ColorNames *getColorNames()
+		{
+			if (!m_color_names_waited && m_color_names_ready.valid()){
+				// only the first use can block, later calls find names already loaded
+				gint64 start_time = g_get_monotonic_time();
+				m_color_names_ready.wait();
+				m_color_names_waited = true;
+#ifndef NDEBUG
+				cerr << "Color names loaded in " << m_color_names_load_time / 1000.0 << " ms, first use waited " << (g_get_monotonic_time() - start_time) / 1000.0 << " ms" << endl;
+#endif
+			}
+			return m_color_names;
+		}
 		bool initializeRandomGenerator()
 		{
 			m_random = random_new("SHR3");
@@ -334,11 +455,12 @@ class GlobalState::Impl
 		bool loadAll()
 		{
 			checkConfigurationDirectory();
+			startLoadingColorNames();
 			checkUserInitFile();
 			m_screen_reader = screen_reader_new();
 			m_sampler = sampler_new(m_screen_reader);
+			m_capture_broker = capture_broker_new(m_screen_reader, m_sampler);
 			initializeRandomGenerator();
-			loadColorNames();
 			loadSettings();
 			createColorList();
 			initializeLua();
@@ -370,7 +492,19 @@ bool GlobalState::writeSettings()
 }
 ColorNames *GlobalState::getColorNames()
 {
-	return m_impl->m_color_names;
+	return m_impl->getColorNames();
+}
+bool GlobalState::isColorNamesReady()
+{
+	return m_impl->isColorNamesReady();
+}
+void GlobalState::addColorNamesReadyCallback(ColorNamesReadyCallback callback, void *userdata)
+{
+	m_impl->addColorNamesReadyCallback(callback, userdata);
+}
+void GlobalState::removeColorNamesReadyCallback(ColorNamesReadyCallback callback, void *userdata)
+{
+	m_impl->removeColorNamesReadyCallback(callback, userdata);
 }
 Sampler *GlobalState::getSampler()
 {
@@ -380,6 +514,10 @@ ScreenReader *GlobalState::getScreenReader()
 {
 	return m_impl->m_screen_reader;
 }
+CaptureBroker *GlobalState::getCaptureBroker()
+{
+	return m_impl->m_capture_broker;
+}
 ColorList *GlobalState::getColorList()
 {
 	return m_impl->m_color_list;
@@ -23,6 +23,7 @@
 struct ColorNames;
 struct Sampler;
 struct ScreenReader;
+struct CaptureBroker;
 class ColorList;
 struct dynvSystem;
 struct lua_State;
@@ -39,14 +40,21 @@ namespace transformation {
 class GlobalState
 {
 	public:
+		typedef void (*ColorNamesReadyCallback)(void *userdata);
 		GlobalState();
 		~GlobalState();
 		bool loadSettings();
 		bool loadAll();
 		bool writeSettings();
 		ColorNames *getColorNames();
+		/** Check if color names are loaded, so getColorNames does not block. */
+		bool isColorNamesReady();
+		/** Call callback once in the main loop when color names finish loading. Nothing is called if they were loaded already. */
+		void addColorNamesReadyCallback(ColorNamesReadyCallback callback, void *userdata);
+		void removeColorNamesReadyCallback(ColorNamesReadyCallback callback, void *userdata);
 		Sampler *getSampler();
 		ScreenReader *getScreenReader();
+		CaptureBroker *getCaptureBroker();
 		ColorList *getColorList();
 		dynvSystem *getSettings();
 		lua_State *getLua();
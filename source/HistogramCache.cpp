@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "HistogramCache.h"
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+using namespace std;
+
+#define CACHE_MAGIC "GPICKHST"
+#define CACHE_VERSION 2
+#define ENTRY_EXTENSION ".hst"
+// Size of file blocks read while hashing and free space kept in (de)compressor output
+#define BLOCK_SIZE (64 * 1024)
+
+/** \struct HistogramCacheHeader
+ * \brief Header of a cache entry. It is followed by zlib compressed indices (uint16_t) of non-empty bins and the bins themselves.
+ * All values are stored in native byte order, so version also includes a byte order mark.
+ */
+typedef struct HistogramCacheHeader{
+	char magic[8];
+	uint32_t version;
+	uint32_t bin_count;
+	uint64_t file_size;
+	int64_t modification_time;
+}HistogramCacheHeader;
+
+/** \struct HistogramCacheEntry
+ * \brief Cache entry file found while evicting entries.
+ */
+typedef struct HistogramCacheEntry{
+	string path;
+	uint64_t size;
+	int64_t modification_time;
+}HistogramCacheEntry;
+
+static uint32_t histogram_cache_version(){
+	return (CACHE_VERSION << 8) | sizeof(ColorHistogramBin);
+}
+
+static gchar* histogram_cache_get_entry_path(const char *directory, const HistogramCacheKey *key){
+	string name = string(key->hash) + ENTRY_EXTENSION;
+	return g_build_filename(directory, name.c_str(), nullptr);
+}
+
+/**
+ * Pass all data through zlib compressor or decompressor.
+ * @param[in] converter Compressor or decompressor.
+ * @param[in] data Input data.
+ * @param[in] size Input data size.
+ * @param[out] result Output data.
+ * @param[in] max_result_size Conversion fails when output grows larger.
+ * @return True on success.
+ */
+static bool histogram_cache_convert(GConverter *converter, const void *data, size_t size, vector<uint8_t> &result, size_t max_result_size){
+	const uint8_t *input = static_cast<const uint8_t*>(data);
+	size_t input_position = 0, output_position = 0;
+	result.clear();
+	for (;;){
+		if (result.size() - output_position < BLOCK_SIZE)
+			result.resize(output_position + std::max<size_t>(size, BLOCK_SIZE));
+		gsize bytes_read = 0, bytes_written = 0;
+		GConverterResult status = g_converter_convert(converter, input + input_position, size - input_position, &result[output_position], result.size() - output_position, G_CONVERTER_INPUT_AT_END, &bytes_read, &bytes_written, nullptr);
+		if (status == G_CONVERTER_ERROR) return false;
+		input_position += bytes_read;
+		output_position += bytes_written;
+		if (output_position > max_result_size) return false;
+		if (status == G_CONVERTER_FINISHED){
+			result.resize(output_position);
+			return true;
+		}
+	}
+}
+
+static bool histogram_cache_parse(const char *data, size_t size, const HistogramCacheKey *key, ColorHistogram *histogram){
+	HistogramCacheHeader header;
+	if (size < sizeof(header)) return false;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != histogram_cache_version()) return false;
+	if (header.file_size != key->size || header.modification_time != key->modification_time) return false;
+	if (header.bin_count > uint32_t(COLOR_HISTOGRAM_SIZE)) return false;
+	size_t indices_size = sizeof(uint16_t) * header.bin_count;
+	size_t payload_size = indices_size + sizeof(ColorHistogramBin) * header.bin_count;
+	vector<uint8_t> payload;
+	GConverter *decompressor = G_CONVERTER(g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_ZLIB));
+	bool result = histogram_cache_convert(decompressor, data + sizeof(header), size - sizeof(header), payload, payload_size);
+	g_object_unref(decompressor);
+	if (!result || payload.size() != payload_size) return false;
+	ColorHistogram *entry_histogram = color_histogram_new();
+	uint16_t previous_index = 0;
+	for (uint32_t i = 0; i < header.bin_count; i++){
+		uint16_t index;
+		ColorHistogramBin bin;
+		memcpy(&index, &payload[sizeof(uint16_t) * i], sizeof(index));
+		memcpy(&bin, &payload[indices_size + sizeof(ColorHistogramBin) * i], sizeof(bin));
+		if (index >= COLOR_HISTOGRAM_SIZE || (i > 0 && index <= previous_index)){
+			color_histogram_destroy(entry_histogram);
+			return false;
+		}
+		previous_index = index;
+		color_histogram_add_bin(entry_histogram, index, &bin);
+	}
+	color_histogram_merge(histogram, entry_histogram);
+	color_histogram_destroy(entry_histogram);
+	return true;
+}
+
+static void histogram_cache_evict(const char *directory, uint64_t max_size){
+	GDir *dir = g_dir_open(directory, 0, nullptr);
+	if (!dir) return;
+	vector<HistogramCacheEntry> entries;
+	uint64_t total_size = 0;
+	const gchar *name;
+	while ((name = g_dir_read_name(dir))){
+		if (!g_str_has_suffix(name, ENTRY_EXTENSION)) continue;
+		gchar *path = g_build_filename(directory, name, nullptr);
+		GStatBuf st;
+		if (g_stat(path, &st) == 0){
+			HistogramCacheEntry entry;
+			entry.path = path;
+			entry.size = st.st_size;
+			entry.modification_time = st.st_mtime;
+			entries.push_back(entry);
+			total_size += entry.size;
+		}
+		g_free(path);
+	}
+	g_dir_close(dir);
+	if (total_size <= max_size) return;
+	sort(entries.begin(), entries.end(), [](const HistogramCacheEntry &a, const HistogramCacheEntry &b){
+		return a.modification_time < b.modification_time;
+	});
+	for (auto &entry: entries){
+		if (total_size <= max_size) break;
+		if (g_remove(entry.path.c_str()) == 0)
+			total_size -= entry.size;
+	}
+}
+
+bool histogram_cache_get_key(const char *filename, HistogramCacheKey *key, const atomic<bool> *cancelled){
+	GStatBuf st;
+	if (g_stat(filename, &st) != 0) return false;
+	FILE *file = g_fopen(filename, "rb");
+	if (!file) return false;
+	GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+	vector<guchar> buffer(BLOCK_SIZE);
+	uint64_t total_size = 0;
+	bool result = true;
+	size_t size;
+	while ((size = fread(&buffer.front(), 1, buffer.size(), file)) > 0){
+		if (cancelled && *cancelled){
+			result = false;
+			break;
+		}
+		g_checksum_update(checksum, &buffer.front(), size);
+		total_size += size;
+	}
+	// file, which changes while it is being read, can not be cached
+	if (ferror(file) || total_size != uint64_t(st.st_size)) result = false;
+	fclose(file);
+	if (result){
+		key->size = total_size;
+		key->modification_time = st.st_mtime;
+		g_strlcpy(key->hash, g_checksum_get_string(checksum), sizeof(key->hash));
+	}
+	g_checksum_free(checksum);
+	return result;
+}
+
+bool histogram_cache_load(const char *directory, const HistogramCacheKey *key, ColorHistogram *histogram){
+	gchar *path = histogram_cache_get_entry_path(directory, key);
+	gchar *contents = nullptr;
+	gsize length = 0;
+	bool result = g_file_get_contents(path, &contents, &length, nullptr) && histogram_cache_parse(contents, length, key, histogram);
+	if (result)
+		g_utime(path, nullptr); // entry was used, so it is evicted last
+	g_free(contents);
+	g_free(path);
+	return result;
+}
+
+bool histogram_cache_store(const char *directory, const HistogramCacheKey *key, const ColorHistogram *histogram, uint64_t max_size){
+	const ColorHistogramBin *bins = color_histogram_get_bins(histogram);
+	vector<uint16_t> indices;
+	for (int i = 0; i < COLOR_HISTOGRAM_SIZE; i++){
+		if (bins[i].count)
+			indices.push_back(i);
+	}
+	size_t indices_size = sizeof(uint16_t) * indices.size();
+	vector<uint8_t> payload(indices_size + sizeof(ColorHistogramBin) * indices.size());
+	for (size_t i = 0; i < indices.size(); i++){
+		memcpy(&payload[sizeof(uint16_t) * i], &indices[i], sizeof(uint16_t));
+		memcpy(&payload[indices_size + sizeof(ColorHistogramBin) * i], &bins[indices[i]], sizeof(ColorHistogramBin));
+	}
+	vector<uint8_t> compressed;
+	GConverter *compressor = G_CONVERTER(g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_ZLIB, -1));
+	bool result = histogram_cache_convert(compressor, payload.data(), payload.size(), compressed, SIZE_MAX);
+	g_object_unref(compressor);
+	if (!result) return false;
+
+	HistogramCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	header.version = histogram_cache_version();
+	header.bin_count = indices.size();
+	header.file_size = key->size;
+	header.modification_time = key->modification_time;
+
+	if (g_mkdir_with_parents(directory, 0700) != 0) return false;
+	gchar *path = histogram_cache_get_entry_path(directory, key);
+	// entry is written under a unique name and renamed, so concurrent readers and writers never see a partial entry.
+	// Unique name has entry extension, so files left by interrupted writes are evicted like any other entry
+	string tmp_name = string(key->hash) + ".XXXXXX" + ENTRY_EXTENSION;
+	gchar *tmp_path = g_build_filename(directory, tmp_name.c_str(), nullptr);
+	int fd = g_mkstemp(tmp_path);
+	FILE *file = nullptr;
+	if (fd != -1){
+		g_close(fd, nullptr);
+		file = g_fopen(tmp_path, "wb");
+	}
+	if (file){
+		result = fwrite(&header, sizeof(header), 1, file) == 1 && (compressed.empty() || fwrite(&compressed.front(), compressed.size(), 1, file) == 1);
+		if (fclose(file) != 0) result = false;
+		if (result) result = g_rename(tmp_path, path) == 0;
+	}else{
+		result = false;
+	}
+	if (!result && fd != -1) g_remove(tmp_path);
+	g_free(tmp_path);
+	g_free(path);
+	if (result)
+		histogram_cache_evict(directory, max_size);
+	return result;
+}
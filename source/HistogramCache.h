@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_HISTOGRAM_CACHE_H_
+#define GPICK_HISTOGRAM_CACHE_H_
+
+#include "ColorHistogram.h"
+#include <atomic>
+#include <stdint.h>
+
+/** \file source/HistogramCache.h
+ * \brief Disk cache of image color histograms.
+ *
+ * Each cache entry is a file in cache directory, named by the hash of image file contents. Entry contains image file size and
+ * modification time, and zlib compressed non-empty histogram bins. Entries are evicted oldest first by their modification time,
+ * which is updated each time an entry is loaded. Entries are written to temporary files with the same extension and renamed,
+ * so temporary files left by interrupted writes are evicted too. Functions do not keep any state, so they can be called from any thread.
+ */
+
+/** \struct HistogramCacheKey
+ * \brief Identity of an image file.
+ */
+typedef struct HistogramCacheKey{
+	uint64_t size; /**< File size in bytes */
+	int64_t modification_time; /**< File modification time in seconds */
+	char hash[65]; /**< Hexadecimal SHA-256 of file contents */
+}HistogramCacheKey;
+
+/**
+ * Read image file and calculate its cache key.
+ * @param[in] filename Image file name.
+ * @param[out] key Cache key.
+ * @param[in] cancelled Reading stops between file blocks when set. Can be nullptr.
+ * @return True on success.
+ */
+bool histogram_cache_get_key(const char *filename, HistogramCacheKey *key, const std::atomic<bool> *cancelled);
+
+/**
+ * Load histogram of an image from cache. Histogram must have been stored from image_histogram_load result.
+ * @param[in] directory Cache directory.
+ * @param[in] key Image cache key.
+ * @param[in] histogram Histogram to add cached bins to.
+ * @return True if cache has a valid entry for the key. Histogram is not modified otherwise.
+ */
+bool histogram_cache_load(const char *directory, const HistogramCacheKey *key, struct ColorHistogram *histogram);
+
+/**
+ * Store histogram of an image in cache and evict oldest entries until total size of entries fits into max_size. Cache directory is created if it does not exist.
+ * @param[in] directory Cache directory.
+ * @param[in] key Image cache key.
+ * @param[in] histogram Histogram returned by image_histogram_load.
+ * @param[in] max_size Maximum total size of cache entries in bytes.
+ * @return True on success.
+ */
+bool histogram_cache_store(const char *directory, const HistogramCacheKey *key, const struct ColorHistogram *histogram, uint64_t max_size);
+
+#endif /* GPICK_HISTOGRAM_CACHE_H_ */
@@ -0,0 +1,503 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ImageHistogram.h"
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib/gstdio.h>
+#ifdef HAVE_LIBPNG
+#include <png.h>
+#endif
+#ifdef HAVE_LIBTIFF
+#include <tiffio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Size of file blocks written into image decoder
+#define READ_BLOCK_SIZE (64 * 1024)
+
+typedef enum ImageHistogramFormat{
+	IMAGE_HISTOGRAM_FORMAT_OTHER,
+	IMAGE_HISTOGRAM_FORMAT_PNG,
+	IMAGE_HISTOGRAM_FORMAT_TIFF,
+}ImageHistogramFormat;
+
+typedef struct ImageHistogramLoad{
+	const char *filename;
+	FILE *file;
+	const atomic<bool> *cancelled;
+	ColorHistogram *histogram; /**< Rows counted while decoding */
+	const ImageHistogramPreview *preview;
+	ColorHistogram *preview_histogram; /**< Subsampled rows counted while decoding, or nullptr when preview is not needed */
+}ImageHistogramLoad;
+
+/**
+ * Write function of an incremental decoder.
+ * @return True on success.
+ */
+typedef bool (*ImageHistogramWrite)(void *decoder, const guchar *data, size_t size, GError **error);
+
+static bool image_histogram_is_cancelled(const ImageHistogramLoad *load){
+	return load->cancelled && *load->cancelled;
+}
+
+/**
+ * Add rows to histogram. Decoders call it as soon as rows are decoded and do not keep the rows afterwards.
+ * Pixels in rows and columns, which are multiples of preview stride, are also added to preview histogram.
+ * @param[in] left Image column of the first pixel in each row.
+ * @param[in] top Image row of the first row.
+ */
+static void image_histogram_count_rows(ImageHistogramLoad *load, const guchar *pixels, int left, int top, int width, int height, int rowstride, int channels){
+	color_histogram_add_rows(load->histogram, pixels, width, height, rowstride, channels);
+	if (!load->preview_histogram) return;
+	int stride = load->preview->stride;
+	int first_column = (stride - left % stride) % stride;
+	if (first_column >= width) return;
+	int columns = (width - first_column + stride - 1) / stride;
+	bool updated = false;
+	for (int y = (stride - top % stride) % stride; y < height; y += stride){
+		color_histogram_add_rows(load->preview_histogram, pixels + size_t(rowstride) * y + size_t(first_column) * channels, columns, 1, 0, channels * stride);
+		updated = true;
+	}
+	if (updated)
+		load->preview->update(load->preview_histogram, load->preview->userdata);
+}
+
+/**
+ * Write the whole file into incremental decoder in small blocks.
+ * @return True on success. False without error when cancelled.
+ */
+static bool image_histogram_feed(ImageHistogramLoad *load, ImageHistogramWrite write, void *decoder, GError **error){
+	guchar buffer[READ_BLOCK_SIZE];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), load->file)) > 0){
+		if (image_histogram_is_cancelled(load)) return false;
+		if (!write(decoder, buffer, size, error)) return false;
+	}
+	if (ferror(load->file)){
+		g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_IO, "%s: %s", load->filename, g_strerror(EIO));
+		return false;
+	}
+	return true;
+}
+
+static ImageHistogramFormat image_histogram_detect_format(FILE *file){
+	guchar signature[8];
+	size_t size = fread(signature, 1, sizeof(signature), file);
+	rewind(file);
+	if (size < sizeof(signature)) return IMAGE_HISTOGRAM_FORMAT_OTHER;
+#ifdef HAVE_LIBPNG
+	if (png_sig_cmp(signature, 0, 8) == 0)
+		return IMAGE_HISTOGRAM_FORMAT_PNG;
+#endif
+#ifdef HAVE_LIBTIFF
+	// classic TIFF and BigTIFF in both byte orders
+	if (memcmp(signature, "II*\0", 4) == 0 || memcmp(signature, "MM\0*", 4) == 0 || memcmp(signature, "II+\0", 4) == 0 || memcmp(signature, "MM\0+", 4) == 0)
+		return IMAGE_HISTOGRAM_FORMAT_TIFF;
+#endif
+	return IMAGE_HISTOGRAM_FORMAT_OTHER;
+}
+
+#ifdef HAVE_LIBPNG
+/** \struct ImageHistogramPng
+ * \brief State of libpng progressive reader.
+ */
+typedef struct ImageHistogramPng{
+	ImageHistogramLoad *load;
+	png_structp png;
+	png_infop info;
+	png_uint_32 width;
+	int channels; /**< Number of bytes in each pixel of decoded rows */
+	bool interlaced;
+	bool finished; /**< End of image was reached */
+	string error_message;
+}ImageHistogramPng;
+
+static void image_histogram_png_error(png_structp png, png_const_charp message){
+	ImageHistogramPng *decoder = static_cast<ImageHistogramPng*>(png_get_error_ptr(png));
+	decoder->error_message = message;
+	png_longjmp(png, 1);
+}
+
+static void image_histogram_png_warning(png_structp png, png_const_charp message){
+}
+
+static void image_histogram_png_info(png_structp png, png_infop info){
+	ImageHistogramPng *decoder = static_cast<ImageHistogramPng*>(png_get_progressive_ptr(png));
+	decoder->width = png_get_image_width(png, info);
+	decoder->interlaced = png_get_interlace_type(png, info) != PNG_INTERLACE_NONE;
+	png_set_expand(png);
+	png_set_strip_16(png);
+	png_set_strip_alpha(png);
+	png_set_gray_to_rgb(png);
+	png_read_update_info(png, info);
+	decoder->channels = png_get_channels(png, info);
+}
+
+static void image_histogram_png_row(png_structp png, png_bytep row, png_uint_32 row_number, int pass){
+	if (!row) return;
+	ImageHistogramPng *decoder = static_cast<ImageHistogramPng*>(png_get_progressive_ptr(png));
+	// interlace handling is not enabled, so each row of an interlaced image contains only pixels of its pass, and every pixel is counted once.
+	// Rows and columns of a pass are used as preview coordinates, which subsamples each pass evenly
+	png_uint_32 width = decoder->interlaced ? PNG_PASS_COLS(decoder->width, pass) : decoder->width;
+	image_histogram_count_rows(decoder->load, row, 0, row_number, width, 1, 0, decoder->channels);
+}
+
+static void image_histogram_png_end(png_structp png, png_infop info){
+	ImageHistogramPng *decoder = static_cast<ImageHistogramPng*>(png_get_progressive_ptr(png));
+	decoder->finished = true;
+}
+
+/**
+ * Pass data to libpng. Errors are reported by longjmp, so this function does not have any objects with destructors.
+ */
+static bool image_histogram_png_process(ImageHistogramPng *decoder, const guchar *data, size_t size){
+	if (setjmp(png_jmpbuf(decoder->png))) return false;
+	png_process_data(decoder->png, decoder->info, const_cast<png_bytep>(data), size);
+	return true;
+}
+
+static bool image_histogram_png_write(void *data, const guchar *buffer, size_t size, GError **error){
+	ImageHistogramPng *decoder = static_cast<ImageHistogramPng*>(data);
+	if (image_histogram_png_process(decoder, buffer, size)) return true;
+	g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_CORRUPT_IMAGE, "%s: %s", decoder->load->filename, decoder->error_message.c_str());
+	return false;
+}
+
+/**
+ * Decode PNG file with libpng progressive reader. Only a single row of decoded pixels is kept in memory.
+ */
+static bool image_histogram_decode_png(ImageHistogramLoad *load, GError **error){
+	ImageHistogramPng decoder;
+	decoder.load = load;
+	decoder.width = 0;
+	decoder.channels = 3;
+	decoder.interlaced = false;
+	decoder.finished = false;
+	decoder.png = png_create_read_struct(PNG_LIBPNG_VER_STRING, &decoder, image_histogram_png_error, image_histogram_png_warning);
+	decoder.info = decoder.png ? png_create_info_struct(decoder.png) : nullptr;
+	if (!decoder.info){
+		png_destroy_read_struct(&decoder.png, nullptr, nullptr);
+		g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_INSUFFICIENT_MEMORY, "%s: %s", load->filename, g_strerror(ENOMEM));
+		return false;
+	}
+	png_set_progressive_read_fn(decoder.png, &decoder, image_histogram_png_info, image_histogram_png_row, image_histogram_png_end);
+	bool result = image_histogram_feed(load, image_histogram_png_write, &decoder, error);
+	if (result && !decoder.finished){
+		g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_CORRUPT_IMAGE, "%s: %s", load->filename, "Premature end of image data");
+		result = false;
+	}
+	png_destroy_read_struct(&decoder.png, &decoder.info, nullptr);
+	return result;
+}
+#endif
+
+#ifdef HAVE_LIBTIFF
+static tmsize_t image_histogram_tiff_read(thandle_t handle, void *data, tmsize_t size){
+	return fread(data, 1, size, static_cast<FILE*>(handle));
+}
+
+static tmsize_t image_histogram_tiff_write(thandle_t handle, void *data, tmsize_t size){
+	return 0;
+}
+
+static toff_t image_histogram_tiff_seek(thandle_t handle, toff_t offset, int whence){
+	FILE *file = static_cast<FILE*>(handle);
+	if (fseeko(file, off_t(offset), whence) != 0) return toff_t(-1);
+	return ftello(file);
+}
+
+static int image_histogram_tiff_close(thandle_t handle){
+	return 0; // file is closed by image_histogram_load_cancellable
+}
+
+static toff_t image_histogram_tiff_size(thandle_t handle){
+	struct stat file_stat;
+	if (fstat(fileno(static_cast<FILE*>(handle)), &file_stat) != 0) return 0;
+	return file_stat.st_size;
+}
+
+/**
+ * Map file into memory. libtiff reads compressed strips directly from the mapping instead of copying whole strips, which can be
+ * as large as the image, into memory.
+ */
+static int image_histogram_tiff_map(thandle_t handle, void **data, toff_t *size){
+	toff_t file_size = image_histogram_tiff_size(handle);
+	if (file_size == 0 || file_size > SIZE_MAX) return 0;
+	void *mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fileno(static_cast<FILE*>(handle)), 0);
+	if (mapping == MAP_FAILED) return 0;
+	*data = mapping;
+	*size = file_size;
+	return 1;
+}
+
+static void image_histogram_tiff_unmap(thandle_t handle, void *data, toff_t size){
+	munmap(data, size);
+}
+
+/**
+ * Check if scanlines contain 8 or 16 bit RGB, grayscale or 8 bit palette samples, which can be converted to RGB without libtiff RGBA interface.
+ */
+static bool image_histogram_tiff_has_plain_scanlines(TIFF *tiff, uint16_t bits, uint16_t samples, uint16_t photometric){
+	uint16_t planar = PLANARCONFIG_CONTIG;
+	TIFFGetFieldDefaulted(tiff, TIFFTAG_PLANARCONFIG, &planar);
+	if (TIFFIsTiled(tiff) || planar != PLANARCONFIG_CONTIG) return false;
+	switch (photometric){
+		case PHOTOMETRIC_RGB:
+			return (bits == 8 || bits == 16) && samples >= 3;
+		case PHOTOMETRIC_MINISBLACK:
+		case PHOTOMETRIC_MINISWHITE:
+			return (bits == 8 || bits == 16) && samples >= 1;
+		case PHOTOMETRIC_PALETTE:
+			return bits == 8 && samples == 1;
+	}
+	return false;
+}
+
+/**
+ * Read image scanline by scanline. Compressed data is decoded as scanlines are read, so only a single scanline of pixels is kept in memory.
+ */
+static bool image_histogram_tiff_read_scanlines(ImageHistogramLoad *load, TIFF *tiff, uint32_t width, uint32_t height, uint16_t bits, uint16_t samples, uint16_t photometric){
+	uint16_t *colormap[3] = {nullptr, nullptr, nullptr};
+	int colormap_shift = 8;
+	if (photometric == PHOTOMETRIC_PALETTE){
+		if (!TIFFGetField(tiff, TIFFTAG_COLORMAP, &colormap[0], &colormap[1], &colormap[2])) return false;
+		// some writers store 8 bit values in colormap
+		colormap_shift = 0;
+		for (int i = 0; i < 256 && colormap_shift == 0; i++){
+			if (colormap[0][i] > 255 || colormap[1][i] > 255 || colormap[2][i] > 255)
+				colormap_shift = 8;
+		}
+	}
+	vector<uint8_t> scanline(TIFFScanlineSize(tiff));
+	vector<guchar> pixels(size_t(width) * 3);
+	// 16 bit samples are in native byte order after reading. They are converted like libtiff RGBA interface does: color samples
+	// are rounded, grayscale samples are truncated to the most significant byte
+	auto sample = [&scanline, bits](size_t index) -> guchar {
+		if (bits == 16) return (reinterpret_cast<const uint16_t*>(scanline.data())[index] + 128) / 257;
+		return scanline[index];
+	};
+	auto gray_sample = [&scanline, bits](size_t index) -> guchar {
+		if (bits == 16) return reinterpret_cast<const uint16_t*>(scanline.data())[index] >> 8;
+		return scanline[index];
+	};
+	for (uint32_t y = 0; y < height; y++){
+		if (image_histogram_is_cancelled(load)) return false;
+		if (TIFFReadScanline(tiff, scanline.data(), y, 0) < 0) return false;
+		guchar *pixel = pixels.data();
+		for (size_t x = 0, index = 0; x < width; x++, index += samples, pixel += 3){
+			switch (photometric){
+				case PHOTOMETRIC_RGB:
+					pixel[0] = sample(index);
+					pixel[1] = sample(index + 1);
+					pixel[2] = sample(index + 2);
+					break;
+				case PHOTOMETRIC_MINISBLACK:
+				case PHOTOMETRIC_MINISWHITE:
+					pixel[0] = pixel[1] = pixel[2] = photometric == PHOTOMETRIC_MINISWHITE ? 255 - gray_sample(index) : gray_sample(index);
+					break;
+				case PHOTOMETRIC_PALETTE:
+					for (int i = 0; i < 3; i++)
+						pixel[i] = colormap[i][scanline[index]] >> colormap_shift;
+					break;
+			}
+		}
+		image_histogram_count_rows(load, pixels.data(), 0, y, width, 1, 0, 3);
+	}
+	return true;
+}
+
+/**
+ * Read image through libtiff RGBA interface, which supports all photometric interpretations, bit depths and planar configurations.
+ * Image is read a tile or a strip at a time, so memory use depends on the tile or strip size.
+ */
+static bool image_histogram_tiff_read_rgba(ImageHistogramLoad *load, TIFF *tiff, uint32_t width, uint32_t height){
+	char message[1024];
+	if (!TIFFRGBAImageOK(tiff, message)) return false;
+	bool tiled = TIFFIsTiled(tiff);
+	uint32_t block_width = width, block_height = height;
+	if (tiled){
+		TIFFGetField(tiff, TIFFTAG_TILEWIDTH, &block_width);
+		TIFFGetField(tiff, TIFFTAG_TILELENGTH, &block_height);
+	}else{
+		TIFFGetFieldDefaulted(tiff, TIFFTAG_ROWSPERSTRIP, &block_height);
+		block_height = std::min(block_height, height);
+	}
+	if (block_width == 0 || block_height == 0) return false;
+	vector<uint32_t> raster(size_t(block_width) * block_height);
+	vector<guchar> pixels(size_t(block_width) * 3);
+	for (uint32_t top = 0; top < height; top += block_height){
+		uint32_t rows = std::min(block_height, height - top);
+		for (uint32_t left = 0; left < width; left += block_width){
+			if (image_histogram_is_cancelled(load)) return false;
+			uint32_t columns = std::min(block_width, width - left);
+			// raster rows are bottom-up, and rows of a partial tile are at the end of the raster
+			uint32_t last_row;
+			if (tiled){
+				if (!TIFFReadRGBATile(tiff, left, top, raster.data())) return false;
+				last_row = block_height - 1;
+			}else{
+				if (!TIFFReadRGBAStrip(tiff, top, raster.data())) return false;
+				last_row = rows - 1;
+			}
+			for (uint32_t y = 0; y < rows; y++){
+				const uint32_t *row = raster.data() + size_t(last_row - y) * block_width;
+				for (uint32_t x = 0; x < columns; x++){
+					pixels[x * 3] = TIFFGetR(row[x]);
+					pixels[x * 3 + 1] = TIFFGetG(row[x]);
+					pixels[x * 3 + 2] = TIFFGetB(row[x]);
+				}
+				image_histogram_count_rows(load, pixels.data(), left, top + y, columns, 1, 0, 3);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Decode the first image of TIFF file with libtiff.
+ */
+static bool image_histogram_decode_tiff(ImageHistogramLoad *load, GError **error){
+	TIFF *tiff = TIFFClientOpen(load->filename, "r", static_cast<thandle_t>(load->file), image_histogram_tiff_read, image_histogram_tiff_write, image_histogram_tiff_seek, image_histogram_tiff_close, image_histogram_tiff_size, image_histogram_tiff_map, image_histogram_tiff_unmap);
+	bool result = false;
+	if (tiff){
+		uint32_t width = 0, height = 0;
+		uint16_t bits = 1, samples = 1, photometric = 0;
+		TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+		TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height);
+		TIFFGetFieldDefaulted(tiff, TIFFTAG_BITSPERSAMPLE, &bits);
+		TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLESPERPIXEL, &samples);
+		bool has_photometric = TIFFGetField(tiff, TIFFTAG_PHOTOMETRIC, &photometric);
+		if (width > 0 && height > 0 && width <= INT_MAX && height <= INT_MAX){
+			if (has_photometric && image_histogram_tiff_has_plain_scanlines(tiff, bits, samples, photometric))
+				result = image_histogram_tiff_read_scanlines(load, tiff, width, height, bits, samples, photometric);
+			else
+				result = image_histogram_tiff_read_rgba(load, tiff, width, height);
+		}
+		TIFFClose(tiff);
+	}
+	if (!result && !image_histogram_is_cancelled(load))
+		g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_CORRUPT_IMAGE, "%s: %s", load->filename, "Failed to load TIFF image");
+	return result;
+}
+#endif
+
+/** \struct ImageHistogramPixbuf
+ * \brief State of GdkPixbufLoader, which decodes formats without a row by row decoder.
+ */
+typedef struct ImageHistogramPixbuf{
+	ImageHistogramLoad *load;
+	GdkPixbufLoader *loader;
+	int counted_rows; /**< Number of rows counted from the top of the image */
+	bool sequential; /**< False when decoder updated rows out of order or more than once */
+}ImageHistogramPixbuf;
+
+static void area_updated_cb(GdkPixbufLoader *loader, gint x, gint y, gint width, gint height, ImageHistogramPixbuf *decoder){
+	if (!decoder->sequential) return;
+	GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+	if (x != 0 || width != gdk_pixbuf_get_width(pixbuf) || y != decoder->counted_rows){
+		decoder->sequential = false;
+		return;
+	}
+	int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+	image_histogram_count_rows(decoder->load, gdk_pixbuf_get_pixels(pixbuf) + size_t(rowstride) * y, 0, y, width, height, rowstride, gdk_pixbuf_get_n_channels(pixbuf));
+	decoder->counted_rows += height;
+}
+
+static bool image_histogram_pixbuf_write(void *data, const guchar *buffer, size_t size, GError **error){
+	ImageHistogramPixbuf *decoder = static_cast<ImageHistogramPixbuf*>(data);
+	return gdk_pixbuf_loader_write(decoder->loader, buffer, size, error);
+}
+
+/**
+ * Decode image with GdkPixbufLoader. Loader keeps the whole decoded image in memory.
+ */
+static bool image_histogram_decode_pixbuf(ImageHistogramLoad *load, GError **error){
+	ImageHistogramPixbuf decoder;
+	decoder.load = load;
+	decoder.loader = gdk_pixbuf_loader_new();
+	decoder.counted_rows = 0;
+	decoder.sequential = true;
+	g_signal_connect(G_OBJECT(decoder.loader), "area-updated", G_CALLBACK(area_updated_cb), &decoder);
+	bool result = image_histogram_feed(load, image_histogram_pixbuf_write, &decoder, error);
+	// closing is required even after a failure, error of the failed write is kept
+	if (!gdk_pixbuf_loader_close(decoder.loader, result ? error : nullptr)) result = false;
+	GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(decoder.loader);
+	if (result && !pixbuf){
+		g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_FAILED, "%s", load->filename);
+		result = false;
+	}
+	if (result && !(decoder.sequential && decoder.counted_rows == gdk_pixbuf_get_height(pixbuf))){
+		// rows were decoded out of order or more than once (interlaced or progressive images, animations), so the whole image is counted again
+		color_histogram_destroy(load->histogram);
+		load->histogram = color_histogram_new();
+		color_histogram_add_image(load->histogram, gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf), gdk_pixbuf_get_rowstride(pixbuf), gdk_pixbuf_get_n_channels(pixbuf));
+	}
+	g_object_unref(decoder.loader);
+	return result;
+}
+
+bool image_histogram_load(const char *filename, ColorHistogram *histogram, GError **error){
+	return image_histogram_load_cancellable(filename, histogram, nullptr, nullptr, error);
+}
+
+bool image_histogram_load_cancellable(const char *filename, ColorHistogram *histogram, const atomic<bool> *cancelled, const ImageHistogramPreview *preview, GError **error){
+	FILE *file = g_fopen(filename, "rb");
+	if (!file){
+		int error_number = errno;
+		g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(error_number), "%s: %s", filename, g_strerror(error_number));
+		return false;
+	}
+	ImageHistogramLoad load;
+	load.filename = filename;
+	load.file = file;
+	load.cancelled = cancelled;
+	load.histogram = color_histogram_new();
+	load.preview = preview;
+	load.preview_histogram = preview && preview->stride > 0 ? color_histogram_new() : nullptr;
+	bool result;
+	switch (image_histogram_detect_format(file)){
+#ifdef HAVE_LIBPNG
+		case IMAGE_HISTOGRAM_FORMAT_PNG:
+			result = image_histogram_decode_png(&load, error);
+			break;
+#endif
+#ifdef HAVE_LIBTIFF
+		case IMAGE_HISTOGRAM_FORMAT_TIFF:
+			result = image_histogram_decode_tiff(&load, error);
+			break;
+#endif
+		default:
+			result = image_histogram_decode_pixbuf(&load, error);
+	}
+	fclose(file);
+	if (result && image_histogram_is_cancelled(&load)) result = false;
+	if (result) color_histogram_merge(histogram, load.histogram);
+	color_histogram_destroy(load.histogram);
+	if (load.preview_histogram) color_histogram_destroy(load.preview_histogram);
+	return result;
+}
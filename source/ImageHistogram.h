@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_IMAGE_HISTOGRAM_H_
+#define GPICK_IMAGE_HISTOGRAM_H_
+
+#include "ColorHistogram.h"
+#include <glib.h>
+#include <atomic>
+
+/** \file source/ImageHistogram.h
+ * \brief Color histogram of an image file, counted while the image is being decoded.
+ *
+ * PNG files are decoded by libpng and TIFF files by libtiff row by row. Each row is counted as soon as it is decoded and
+ * then dropped, so memory use does not depend on image height. TIFF images, which do not have plain 8 or 16 bit RGB, grayscale
+ * or palette scanlines (tiled, planar, YCbCr images and so on), are read a tile or a strip at a time. TIFF files are memory
+ * mapped, so compressed strips are read from the mapping and not copied into memory as a whole. Other formats, and PNG
+ * and TIFF files when gpick is built without these libraries, are decoded by GdkPixbufLoader, which keeps the whole decoded
+ * image in memory. Rows are counted serially in the decoding thread: counting takes a small fraction of decoding time per
+ * pixel, so it is hidden behind the decoder instead of being split into bands for color_histogram_add_image threads.
+ * Images are always counted at full resolution. A subsampled preview histogram can be counted from the same decoded rows,
+ * so an approximate histogram is available while a large image is still being decoded, without decoding the file twice.
+ */
+
+/** \struct ImageHistogramPreview
+ * \brief Preview histogram counted while the image is being decoded.
+ */
+typedef struct ImageHistogramPreview{
+	int stride; /**< Every stride-th pixel of every stride-th row is added to the preview histogram */
+	void (*update)(const struct ColorHistogram *preview, void *userdata); /**< Called in the decoding thread after rows were added to the preview histogram, which is owned by the loader */
+	void *userdata;
+}ImageHistogramPreview;
+
+/**
+ * Decode image file and add its pixels to histogram.
+ * @param[in] filename Image file name.
+ * @param[in] histogram Histogram.
+ * @param[out] error Location for error or nullptr.
+ * @return True on success. Histogram is not modified on failure.
+ */
+bool image_histogram_load(const char *filename, struct ColorHistogram *histogram, GError **error);
+
+/**
+ * Decode image file and add its pixels to histogram. Works like image_histogram_load, but loading can be cancelled from another thread
+ * and a preview histogram is reported while decoding.
+ * @param[in] filename Image file name.
+ * @param[in] histogram Histogram.
+ * @param[in] cancelled Loading stops between file blocks or rows when set. Can be nullptr.
+ * @param[in] preview Preview histogram settings or nullptr.
+ * @param[out] error Location for error or nullptr.
+ * @return True on success. False without error when cancelled. Histogram is not modified on failure.
+ */
+bool image_histogram_load_cancellable(const char *filename, struct ColorHistogram *histogram, const std::atomic<bool> *cancelled, const ImageHistogramPreview *preview, GError **error);
+
+#endif /* GPICK_IMAGE_HISTOGRAM_H_ */
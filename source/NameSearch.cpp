@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "NameSearch.h"
+#include <algorithm>
+#include <string.h>
+using namespace std;
+
+// Minimal score of names, which neither start with the query nor have a word starting with it
+#define MIN_FUZZY_SCORE 0.3f
+
+NameSearch* name_search_new()
+{
+	return new NameSearch;
+}
+void name_search_destroy(NameSearch* name_search)
+{
+	delete name_search;
+}
+void name_search_add(NameSearch* name_search, const char* name, uint32_t id)
+{
+	name_search->names.push_back(name);
+	name_search->ids.push_back(id);
+}
+static bool name_search_is_word_char(unsigned char c)
+{
+	// bytes of multibyte UTF-8 characters are treated as word characters
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+static unsigned char name_search_lower(unsigned char c)
+{
+	return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+/**
+ * Collect distinct lower case trigrams of all words. Each word is padded with two zero characters at the start, so short queries match word prefixes.
+ */
+static void name_search_trigrams(const char* text, vector<uint32_t>& trigrams)
+{
+	trigrams.clear();
+	uint32_t trigram = 0;
+	for (const unsigned char* i = reinterpret_cast<const unsigned char*>(text); *i; i++){
+		if (!name_search_is_word_char(*i)){
+			trigram = 0;
+			continue;
+		}
+		trigram = ((trigram << 8) | name_search_lower(*i)) & 0xffffff;
+		trigrams.push_back(trigram);
+	}
+	sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+void name_search_build(NameSearch* name_search)
+{
+	vector<pair<uint32_t, uint32_t>> pairs;
+	vector<uint32_t> trigrams;
+	name_search->trigram_counts.resize(name_search->names.size());
+	for (size_t i = 0; i < name_search->names.size(); i++){
+		name_search_trigrams(name_search->names[i], trigrams);
+		name_search->trigram_counts[i] = min<size_t>(trigrams.size(), UINT16_MAX);
+		for (auto trigram: trigrams){
+			pairs.push_back(make_pair(trigram, uint32_t(i)));
+		}
+	}
+	sort(pairs.begin(), pairs.end());
+	name_search->trigrams.clear();
+	name_search->posting_start.clear();
+	name_search->postings.resize(pairs.size());
+	for (size_t i = 0; i < pairs.size(); i++){
+		if (i == 0 || pairs[i].first != pairs[i - 1].first){
+			name_search->trigrams.push_back(pairs[i].first);
+			name_search->posting_start.push_back(i);
+		}
+		name_search->postings[i] = pairs[i].second;
+	}
+	name_search->posting_start.push_back(pairs.size());
+}
+/**
+ * Check if text starts with a prefix, ignoring case and treating all non word characters as equal.
+ */
+static bool name_search_starts_with(const unsigned char* text, const unsigned char* prefix)
+{
+	for (; *prefix; text++, prefix++){
+		if (!*text) return false;
+		if (name_search_is_word_char(*text) != name_search_is_word_char(*prefix)) return false;
+		if (name_search_is_word_char(*text) && name_search_lower(*text) != name_search_lower(*prefix)) return false;
+	}
+	return true;
+}
+static float name_search_prefix_score(const char* name, const char* query)
+{
+	const unsigned char* text = reinterpret_cast<const unsigned char*>(name);
+	const unsigned char* prefix = reinterpret_cast<const unsigned char*>(query);
+	if (name_search_starts_with(text, prefix)) return 1.0f;
+	for (const unsigned char* i = text + 1; *i; i++){
+		if (name_search_is_word_char(*i) && !name_search_is_word_char(*(i - 1)) && name_search_starts_with(i, prefix)) return 0.5f;
+	}
+	return 0;
+}
+size_t name_search_find(const NameSearch* name_search, const char* query, size_t max_matches, NameSearchMatch* matches)
+{
+	vector<uint32_t> query_trigrams;
+	name_search_trigrams(query, query_trigrams);
+	if (query_trigrams.empty() || max_matches == 0) return 0;
+	// skip leading non word characters, so that prefix matching uses the same words as trigrams
+	while (*query && !name_search_is_word_char(*query)) query++;
+	vector<uint16_t> shared(name_search->names.size(), 0);
+	vector<uint32_t> candidates;
+	for (auto trigram: query_trigrams){
+		auto i = lower_bound(name_search->trigrams.begin(), name_search->trigrams.end(), trigram);
+		if (i == name_search->trigrams.end() || *i != trigram) continue;
+		size_t position = i - name_search->trigrams.begin();
+		for (uint32_t j = name_search->posting_start[position]; j < name_search->posting_start[position + 1]; j++){
+			uint32_t name_index = name_search->postings[j];
+			if (shared[name_index]++ == 0) candidates.push_back(name_index);
+		}
+	}
+	vector<NameSearchMatch> results;
+	for (auto name_index: candidates){
+		// Dice coefficient of query and name trigram sets
+		float score = 2.0f * shared[name_index] / (query_trigrams.size() + name_search->trigram_counts[name_index]);
+		if (shared[name_index] == query_trigrams.size()){
+			score += name_search_prefix_score(name_search->names[name_index], query);
+		}
+		if (score < MIN_FUZZY_SCORE) continue;
+		NameSearchMatch match;
+		match.id = name_search->ids[name_index];
+		match.name = name_search->names[name_index];
+		match.score = score;
+		results.push_back(match);
+	}
+	size_t count = min(max_matches, results.size());
+	partial_sort(results.begin(), results.begin() + count, results.end(), [](const NameSearchMatch &a, const NameSearchMatch &b){
+		if (a.score != b.score) return a.score > b.score;
+		size_t a_length = strlen(a.name), b_length = strlen(b.name);
+		if (a_length != b_length) return a_length < b_length;
+		return a.id < b.id;
+	});
+	copy(results.begin(), results.begin() + count, matches);
+	return count;
+}
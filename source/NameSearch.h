@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_NAME_SEARCH_H_
+#define GPICK_NAME_SEARCH_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/** \file source/NameSearch.h
+ * \brief Trigram index for prefix and fuzzy name search.
+ */
+
+/** \struct NameSearchMatch
+ * \brief Name found by name_search_find.
+ */
+typedef struct NameSearchMatch{
+	uint32_t id; /**< Identifier given to name_search_add */
+	const char* name; /**< Name given to name_search_add */
+	float score; /**< Match score. Values above one mean that name or one of its words starts with the query */
+}NameSearchMatch;
+/** \struct NameSearch
+ * \brief Trigram index over names. Names are not copied, so they must stay valid while index is used.
+ */
+typedef struct NameSearch{
+	std::vector<const char*> names;
+	std::vector<uint32_t> ids;
+	std::vector<uint16_t> trigram_counts; /**< Number of distinct trigrams of each name */
+	std::vector<uint32_t> trigrams; /**< Sorted distinct trigrams of all names */
+	std::vector<uint32_t> posting_start; /**< Index of the first posting of each trigram. Has one additional element for the end of the last posting list */
+	std::vector<uint32_t> postings; /**< Name indexes grouped by trigram */
+}NameSearch;
+
+NameSearch* name_search_new();
+void name_search_destroy(NameSearch* name_search);
+/**
+ * Add name to the index. Index must be rebuilt by name_search_build before searching.
+ * @param[in] name_search Name search index.
+ * @param[in] name Name, which is not copied.
+ * @param[in] id Identifier returned with matches.
+ */
+void name_search_add(NameSearch* name_search, const char* name, uint32_t id);
+/**
+ * Build trigram index of all added names.
+ * @param[in] name_search Name search index.
+ */
+void name_search_build(NameSearch* name_search);
+/**
+ * Find names matching a query. Matching is case insensitive and tolerates small spelling mistakes.
+ * @param[in] name_search Name search index.
+ * @param[in] query Search query.
+ * @param[in] max_matches Maximum number of matches.
+ * @param[out] matches Array of at least max_matches elements, which receives matches sorted by score.
+ * @return Number of matches.
+ */
+size_t name_search_find(const NameSearch* name_search, const char* query, size_t max_matches, NameSearchMatch* matches);
+
+#endif /* GPICK_NAME_SEARCH_H_ */
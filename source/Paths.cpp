@@ -19,12 +19,10 @@
 #include "Paths.h"
 #include <glib/gstdio.h>
 
-static gchar* get_data_dir()
+static gchar* find_data_dir()
 {
-	static gchar* data_dir = nullptr;
-	if (data_dir) return data_dir;
 	GList *paths = nullptr, *i = nullptr;
-	gchar *tmp;
+	gchar *tmp, *data_dir = nullptr;
 	i = g_list_append(i, (gchar*)"share");
 	paths = i;
 	i = g_list_append(i, (gchar*)g_get_user_data_dir());
@@ -51,6 +49,15 @@ static gchar* get_data_dir()
 	}
 	return data_dir;
 }
+static gchar* get_data_dir()
+{
+	// data directory is also needed by color names loading thread, so initialization must be thread safe
+	static gchar* data_dir = nullptr;
+	if (g_once_init_enter(&data_dir)){
+		g_once_init_leave(&data_dir, find_data_dir());
+	}
+	return data_dir;
+}
 gchar* build_filename(const gchar* filename)
 {
 	if (filename)
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PickerScheduler.h"
+#include <glib.h>
+#include <algorithm>
+
+using namespace math;
+
+struct PickerScheduler{
+	PickerSchedulerTick tick;
+	void *data;
+	guint timeout_source_id;
+	uint32_t timeout_interval; /**< Interval of running timer */
+	uint32_t active_interval; /**< Interval used while pointer or screen contents are changing */
+	uint32_t interval; /**< Requested interval */
+	uint32_t idle_time; /**< Time without changes in milliseconds */
+	bool force;
+	Vec2<int> pointer;
+	uint64_t hash;
+	PickerSchedulerStatistics statistics;
+};
+
+static gboolean picker_scheduler_timeout(PickerScheduler *scheduler);
+
+static void picker_scheduler_set_timer(PickerScheduler *scheduler)
+{
+	if (scheduler->timeout_source_id > 0)
+		g_source_remove(scheduler->timeout_source_id);
+	scheduler->timeout_source_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, scheduler->interval, (GSourceFunc)picker_scheduler_timeout, scheduler, (GDestroyNotify)nullptr);
+	scheduler->timeout_interval = scheduler->interval;
+}
+
+static gboolean picker_scheduler_timeout(PickerScheduler *scheduler)
+{
+	guint timeout_source_id = scheduler->timeout_source_id;
+	scheduler->tick(scheduler, scheduler->data);
+	if (scheduler->timeout_source_id != timeout_source_id)
+		return false; // timer was stopped or restarted by tick function
+	if (scheduler->interval != scheduler->timeout_interval){
+		scheduler->timeout_source_id = 0;
+		picker_scheduler_set_timer(scheduler);
+		return false;
+	}
+	return true;
+}
+
+struct PickerScheduler* picker_scheduler_new(PickerSchedulerTick tick, void *data)
+{
+	PickerScheduler *scheduler = new PickerScheduler;
+	scheduler->tick = tick;
+	scheduler->data = data;
+	scheduler->timeout_source_id = 0;
+	scheduler->timeout_interval = 0;
+	scheduler->active_interval = scheduler->interval = 1000 / 30;
+	scheduler->idle_time = 0;
+	scheduler->force = true;
+	scheduler->hash = 0;
+	scheduler->statistics = PickerSchedulerStatistics();
+	return scheduler;
+}
+
+void picker_scheduler_start(struct PickerScheduler *scheduler, float refresh_rate)
+{
+	scheduler->active_interval = scheduler->interval = std::max(uint32_t(1000 / refresh_rate), uint32_t(1));
+	scheduler->idle_time = 0;
+	scheduler->force = true;
+	if (scheduler->tick)
+		picker_scheduler_set_timer(scheduler);
+}
+
+void picker_scheduler_stop(struct PickerScheduler *scheduler)
+{
+	if (scheduler->timeout_source_id > 0){
+		g_source_remove(scheduler->timeout_source_id);
+		scheduler->timeout_source_id = 0;
+	}
+}
+
+bool picker_scheduler_update(struct PickerScheduler *scheduler, const Vec2<int> &pointer, uint64_t hash)
+{
+	scheduler->statistics.frames++;
+	bool changed = scheduler->force || pointer.x != scheduler->pointer.x || pointer.y != scheduler->pointer.y || hash != scheduler->hash;
+	scheduler->force = false;
+	scheduler->pointer = pointer;
+	scheduler->hash = hash;
+	if (changed){
+		scheduler->statistics.processed++;
+		scheduler->idle_time = 0;
+		scheduler->interval = scheduler->active_interval;
+		return true;
+	}
+	scheduler->statistics.skipped++;
+	scheduler->idle_time += scheduler->interval;
+	if (scheduler->idle_time >= PICKER_SCHEDULER_IDLE_DELAY){
+		scheduler->interval = std::min(scheduler->interval * 2, std::max(scheduler->active_interval, PICKER_SCHEDULER_IDLE_INTERVAL));
+	}
+	return false;
+}
+
+void picker_scheduler_wake(struct PickerScheduler *scheduler)
+{
+	scheduler->force = true;
+	scheduler->idle_time = 0;
+	if (scheduler->interval != scheduler->active_interval){
+		scheduler->interval = scheduler->active_interval;
+		if (scheduler->timeout_source_id > 0)
+			picker_scheduler_set_timer(scheduler);
+	}
+}
+
+void picker_scheduler_get_statistics(struct PickerScheduler *scheduler, PickerSchedulerStatistics *statistics)
+{
+	*statistics = scheduler->statistics;
+	statistics->interval = scheduler->interval;
+}
+
+void picker_scheduler_destroy(struct PickerScheduler *scheduler)
+{
+	picker_scheduler_stop(scheduler);
+	delete scheduler;
+}
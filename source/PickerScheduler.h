@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_PICKER_SCHEDULER_H_
+#define GPICK_PICKER_SCHEDULER_H_
+
+#include "Vector2.h"
+#include <stdint.h>
+
+/** \file source/PickerScheduler.h
+ * \brief Refresh timer of screen pickers, which skips frames while pointer and screen contents stay the same.
+ *
+ * While nothing changes, refresh interval is gradually increased up to PICKER_SCHEDULER_IDLE_INTERVAL. Any change returns it to the configured refresh rate.
+ */
+
+/** Time in milliseconds without changes after which refresh rate starts to decrease. */
+const uint32_t PICKER_SCHEDULER_IDLE_DELAY = 500;
+/** Longest refresh interval in milliseconds used while idle. */
+const uint32_t PICKER_SCHEDULER_IDLE_INTERVAL = 100;
+
+struct PickerScheduler;
+
+/**
+ * Function called by picker scheduler timer.
+ * @param[in] scheduler Picker scheduler.
+ * @param[in] data User data.
+ */
+typedef void (*PickerSchedulerTick)(struct PickerScheduler *scheduler, void *data);
+
+/** \struct PickerSchedulerStatistics
+ * \brief Picker scheduler frame counters.
+ */
+typedef struct PickerSchedulerStatistics{
+	uint64_t frames; /**< Frames checked by picker_scheduler_update */
+	uint64_t processed; /**< Frames which had to be processed */
+	uint64_t skipped; /**< Frames skipped, because pointer and screen did not change */
+	uint32_t interval; /**< Current refresh interval in milliseconds */
+}PickerSchedulerStatistics;
+
+/**
+ * Create picker scheduler.
+ * @param[in] tick Function called on every timer tick. When nullptr, no timer is used and scheduler only decides which frames to process.
+ * @param[in] data User data passed to tick function.
+ * @return New picker scheduler.
+ */
+struct PickerScheduler* picker_scheduler_new(PickerSchedulerTick tick, void *data);
+
+/**
+ * Start or restart refresh timer. Next frame is always processed.
+ * @param[in] scheduler Picker scheduler.
+ * @param[in] refresh_rate Refresh rate in frames per second, used while pointer or screen contents are changing.
+ */
+void picker_scheduler_start(struct PickerScheduler *scheduler, float refresh_rate);
+
+/**
+ * Stop refresh timer.
+ * @param[in] scheduler Picker scheduler.
+ */
+void picker_scheduler_stop(struct PickerScheduler *scheduler);
+
+/**
+ * Decide if a captured frame has to be processed. Must be called once per frame.
+ * @param[in] scheduler Picker scheduler.
+ * @param[in] pointer Pointer position.
+ * @param[in] hash Hash of captured screen pixels.
+ * @return True if frame has changed and has to be processed.
+ */
+bool picker_scheduler_update(struct PickerScheduler *scheduler, const math::Vec2<int> &pointer, uint64_t hash);
+
+/**
+ * Force processing of the next frame and return to full refresh rate immediately. Used when pointer motion is reported or picker settings change.
+ * @param[in] scheduler Picker scheduler.
+ */
+void picker_scheduler_wake(struct PickerScheduler *scheduler);
+
+/**
+ * Get frame counters.
+ * @param[in] scheduler Picker scheduler.
+ * @param[out] statistics Frame counters.
+ */
+void picker_scheduler_get_statistics(struct PickerScheduler *scheduler, PickerSchedulerStatistics *statistics);
+
+/**
+ * Stop refresh timer and destroy picker scheduler.
+ * @param[in] scheduler Picker scheduler.
+ */
+void picker_scheduler_destroy(struct PickerScheduler *scheduler);
+
+#endif /* GPICK_PICKER_SCHEDULER_H_ */
@@ -0,0 +1,567 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Quantizer.h"
+#include "ColorOctree.h"
+#include "ColorBatch.h"
+#include "simd/Kernels.h"
+#include <algorithm>
+#include <random>
+#include <string.h>
+using namespace std;
+
+// Octree is permanently reduced to this number of colors when histogram is set
+#define OCTREE_MAX_COLORS 200
+#define KMEANS_MAX_ITERATIONS 32
+// k-means stops when no center moves further than this distance in Lab color space
+#define KMEANS_MIN_SHIFT 0.05
+// Seed of k-means++ center selection, fixed so that the same histogram always gives the same palette
+#define KMEANS_SEED 1
+// Number of moment cells along each axis of Wu quantizer. First cells are zero to simplify box volume calculation
+#define WU_SIDE ((1 << COLOR_HISTOGRAM_BITS) + 1)
+
+static const char *quantizer_names[QUANTIZER_COUNT] = {"octree", "median_cut", "wu", "kmeans"};
+
+static inline const QuantizerKernels* kernels()
+{
+	return kernels_quantizer();
+}
+
+/** \struct OctreeQuantizer
+ * \brief Octree quantizer. Tree is reduced to a color count without modifying it, so it is built once per histogram.
+ */
+typedef struct OctreeQuantizer{
+	Quantizer quantizer;
+	ColorOctree *octree;
+}OctreeQuantizer;
+
+static void octree_set_histogram(Quantizer *quantizer, const ColorHistogram *histogram)
+{
+	OctreeQuantizer *octree_quantizer = reinterpret_cast<OctreeQuantizer*>(quantizer);
+	if (octree_quantizer->octree) color_octree_destroy(octree_quantizer->octree);
+	ColorOctree *octree = color_octree_new(COLOR_HISTOGRAM_BITS);
+	const ColorHistogramBin *bins = color_histogram_get_bins(histogram);
+	// each bin matches a single leaf node of an octree with COLOR_HISTOGRAM_BITS depth
+	for (int i = 0; i < COLOR_HISTOGRAM_SIZE; i++){
+		const ColorHistogramBin &bin = bins[i];
+		if (!bin.count) continue;
+		double sum[3];
+		for (int j = 0; j < 3; j++)
+			sum[j] = bin.sum[j] / 255.0;
+		color_octree_add_group(octree, bin.count, sum, bin.sum_squares / (255.0 * 255.0));
+	}
+	color_octree_reduce(octree, OCTREE_MAX_COLORS);
+	octree_quantizer->octree = octree;
+}
+
+static void octree_get_colors(Quantizer *quantizer, uint32_t colors, vector<Color> &result)
+{
+	OctreeQuantizer *octree_quantizer = reinterpret_cast<OctreeQuantizer*>(quantizer);
+	result.clear();
+	if (octree_quantizer->octree) color_octree_get_colors(octree_quantizer->octree, colors, result);
+}
+
+static void octree_destroy(Quantizer *quantizer)
+{
+	OctreeQuantizer *octree_quantizer = reinterpret_cast<OctreeQuantizer*>(quantizer);
+	if (octree_quantizer->octree) color_octree_destroy(octree_quantizer->octree);
+	delete octree_quantizer;
+}
+
+/** \struct MedianCutSample
+ * \brief Non-empty histogram bin.
+ */
+typedef struct MedianCutSample{
+	uint8_t position[3]; /**< Bin coordinates */
+	uint64_t count;
+	uint64_t sum[3];
+}MedianCutSample;
+
+/** \struct MedianCutBox
+ * \brief Range of samples sorted into one box.
+ */
+typedef struct MedianCutBox{
+	size_t begin;
+	size_t end;
+	uint64_t count;
+	int axis; /**< Axis with the largest range */
+	int range; /**< Range of bin coordinates along axis */
+}MedianCutBox;
+
+typedef struct MedianCutQuantizer{
+	Quantizer quantizer;
+	vector<MedianCutSample> samples;
+}MedianCutQuantizer;
+
+static void median_cut_set_histogram(Quantizer *quantizer, const ColorHistogram *histogram)
+{
+	MedianCutQuantizer *median_cut = reinterpret_cast<MedianCutQuantizer*>(quantizer);
+	median_cut->samples.clear();
+	const ColorHistogramBin *bins = color_histogram_get_bins(histogram);
+	const int mask = (1 << COLOR_HISTOGRAM_BITS) - 1;
+	for (int i = 0; i < COLOR_HISTOGRAM_SIZE; i++){
+		if (!bins[i].count) continue;
+		MedianCutSample sample;
+		sample.position[0] = (i >> (COLOR_HISTOGRAM_BITS * 2)) & mask;
+		sample.position[1] = (i >> COLOR_HISTOGRAM_BITS) & mask;
+		sample.position[2] = i & mask;
+		sample.count = bins[i].count;
+		for (int j = 0; j < 3; j++)
+			sample.sum[j] = bins[i].sum[j];
+		median_cut->samples.push_back(sample);
+	}
+}
+
+static void median_cut_update_box(const vector<MedianCutSample> &samples, MedianCutBox &box)
+{
+	int low[3] = {255, 255, 255}, high[3] = {0, 0, 0};
+	box.count = 0;
+	for (size_t i = box.begin; i < box.end; i++){
+		for (int j = 0; j < 3; j++){
+			low[j] = min<int>(low[j], samples[i].position[j]);
+			high[j] = max<int>(high[j], samples[i].position[j]);
+		}
+		box.count += samples[i].count;
+	}
+	box.axis = 0;
+	for (int j = 1; j < 3; j++){
+		if (high[j] - low[j] > high[box.axis] - low[box.axis]) box.axis = j;
+	}
+	box.range = high[box.axis] - low[box.axis];
+}
+
+static void median_cut_get_colors(Quantizer *quantizer, uint32_t colors, vector<Color> &result)
+{
+	MedianCutQuantizer *median_cut = reinterpret_cast<MedianCutQuantizer*>(quantizer);
+	result.clear();
+	if (median_cut->samples.empty() || colors == 0) return;
+	// samples are reordered while splitting, so each call starts from the same order
+	vector<MedianCutSample> samples = median_cut->samples;
+	vector<MedianCutBox> boxes(1);
+	boxes[0].begin = 0;
+	boxes[0].end = samples.size();
+	median_cut_update_box(samples, boxes[0]);
+	while (boxes.size() < colors){
+		// split the box with the largest number of pixels and range product
+		size_t best = boxes.size();
+		for (size_t i = 0; i < boxes.size(); i++){
+			if (boxes[i].range == 0) continue;
+			if (best == boxes.size() || double(boxes[i].count) * boxes[i].range > double(boxes[best].count) * boxes[best].range) best = i;
+		}
+		if (best == boxes.size()) break;
+		MedianCutBox box = boxes[best];
+		int axis = box.axis;
+		sort(samples.begin() + box.begin, samples.begin() + box.end, [axis](const MedianCutSample &a, const MedianCutSample &b){
+			return a.position[axis] < b.position[axis];
+		});
+		size_t median = box.begin;
+		uint64_t accumulated = samples[median].count;
+		while (accumulated * 2 < box.count){
+			median++;
+			accumulated += samples[median].count;
+		}
+		// bins with the same coordinate stay in the same box, box range guarantees that a different coordinate exists
+		size_t split = median + 1;
+		while (split < box.end && samples[split].position[axis] == samples[median].position[axis]) split++;
+		if (split == box.end){
+			split = median;
+			while (samples[split - 1].position[axis] == samples[median].position[axis]) split--;
+		}
+		MedianCutBox upper;
+		upper.begin = split;
+		upper.end = box.end;
+		boxes[best].end = split;
+		median_cut_update_box(samples, boxes[best]);
+		median_cut_update_box(samples, upper);
+		boxes.push_back(upper);
+	}
+	for (auto &box: boxes){
+		uint64_t sum[3] = {0, 0, 0};
+		for (size_t i = box.begin; i < box.end; i++){
+			for (int j = 0; j < 3; j++)
+				sum[j] += samples[i].sum[j];
+		}
+		Color color;
+		color.rgb.red = sum[0] / (255.0 * box.count);
+		color.rgb.green = sum[1] / (255.0 * box.count);
+		color.rgb.blue = sum[2] / (255.0 * box.count);
+		result.push_back(color);
+	}
+}
+
+static void median_cut_destroy(Quantizer *quantizer)
+{
+	delete reinterpret_cast<MedianCutQuantizer*>(quantizer);
+}
+
+/** \struct WuMoment
+ * \brief Pixel count, component sums and squared component sum of a histogram area.
+ */
+typedef struct WuMoment{
+	double count;
+	double sum[3];
+	double sum_squares;
+}WuMoment;
+
+/** \struct WuBox
+ * \brief Box of histogram bins. Lower coordinates are exclusive, upper coordinates are inclusive.
+ */
+typedef struct WuBox{
+	int low[3];
+	int high[3];
+}WuBox;
+
+/** \struct WuQuantizer
+ * \brief Wu quantizer. Cumulative moments are calculated once per histogram, so sums of any box are found from 8 moments.
+ */
+typedef struct WuQuantizer{
+	Quantizer quantizer;
+	vector<WuMoment> moments;
+}WuQuantizer;
+
+static inline int wu_index(int red, int green, int blue)
+{
+	return (red * WU_SIDE + green) * WU_SIDE + blue;
+}
+
+static inline void wu_add(WuMoment &a, const WuMoment &b, double sign)
+{
+	a.count += sign * b.count;
+	for (int i = 0; i < 3; i++)
+		a.sum[i] += sign * b.sum[i];
+	a.sum_squares += sign * b.sum_squares;
+}
+
+static void wu_set_histogram(Quantizer *quantizer, const ColorHistogram *histogram)
+{
+	WuQuantizer *wu = reinterpret_cast<WuQuantizer*>(quantizer);
+	wu->moments.assign(WU_SIDE * WU_SIDE * WU_SIDE, WuMoment());
+	const ColorHistogramBin *bins = color_histogram_get_bins(histogram);
+	const int mask = (1 << COLOR_HISTOGRAM_BITS) - 1;
+	for (int i = 0; i < COLOR_HISTOGRAM_SIZE; i++){
+		WuMoment &moment = wu->moments[wu_index(((i >> (COLOR_HISTOGRAM_BITS * 2)) & mask) + 1, ((i >> COLOR_HISTOGRAM_BITS) & mask) + 1, (i & mask) + 1)];
+		moment.count = bins[i].count;
+		for (int j = 0; j < 3; j++)
+			moment.sum[j] = bins[i].sum[j];
+		moment.sum_squares = bins[i].sum_squares;
+	}
+	// cumulative sums along each axis
+	for (int axis = 0; axis < 3; axis++){
+		int step = axis == 0 ? WU_SIDE * WU_SIDE : (axis == 1 ? WU_SIDE : 1);
+		for (int i = 0; i < WU_SIDE * WU_SIDE * WU_SIDE; i++){
+			if ((i / step) % WU_SIDE == 0) continue;
+			wu_add(wu->moments[i], wu->moments[i - step], 1);
+		}
+	}
+}
+
+static WuMoment wu_box_moment(const vector<WuMoment> &moments, const WuBox &box)
+{
+	WuMoment result = WuMoment();
+	for (int corner = 0; corner < 8; corner++){
+		int position[3];
+		int lows = 0;
+		for (int i = 0; i < 3; i++){
+			bool low = corner & (1 << i);
+			position[i] = low ? box.low[i] : box.high[i];
+			lows += low;
+		}
+		wu_add(result, moments[wu_index(position[0], position[1], position[2])], lows & 1 ? -1 : 1);
+	}
+	return result;
+}
+
+static double wu_variance(const WuMoment &moment)
+{
+	if (moment.count <= 0) return 0;
+	return moment.sum_squares - (moment.sum[0] * moment.sum[0] + moment.sum[1] * moment.sum[1] + moment.sum[2] * moment.sum[2]) / moment.count;
+}
+
+/**
+ * Split box into two boxes with the smallest total variance.
+ * @param[in] moments Cumulative moments.
+ * @param[in,out] box Box to split, becomes the lower box.
+ * @param[out] upper Upper box.
+ * @return False when box can not be split.
+ */
+static bool wu_cut(const vector<WuMoment> &moments, WuBox &box, WuBox &upper)
+{
+	WuMoment whole = wu_box_moment(moments, box);
+	int best_axis = -1, best_cut = 0;
+	double best_score = 0;
+	for (int axis = 0; axis < 3; axis++){
+		for (int cut = box.low[axis] + 1; cut < box.high[axis]; cut++){
+			WuBox lower_box = box;
+			lower_box.high[axis] = cut;
+			WuMoment lower = wu_box_moment(moments, lower_box), rest = whole;
+			wu_add(rest, lower, -1);
+			if (lower.count <= 0 || rest.count <= 0) continue;
+			// minimizing the sum of variances is the same as maximizing this sum
+			double score = (lower.sum[0] * lower.sum[0] + lower.sum[1] * lower.sum[1] + lower.sum[2] * lower.sum[2]) / lower.count +
+				(rest.sum[0] * rest.sum[0] + rest.sum[1] * rest.sum[1] + rest.sum[2] * rest.sum[2]) / rest.count;
+			if (best_axis < 0 || score > best_score){
+				best_axis = axis;
+				best_cut = cut;
+				best_score = score;
+			}
+		}
+	}
+	if (best_axis < 0) return false;
+	upper = box;
+	upper.low[best_axis] = best_cut;
+	box.high[best_axis] = best_cut;
+	return true;
+}
+
+static void wu_get_colors(Quantizer *quantizer, uint32_t colors, vector<Color> &result)
+{
+	WuQuantizer *wu = reinterpret_cast<WuQuantizer*>(quantizer);
+	result.clear();
+	if (wu->moments.empty() || colors == 0) return;
+	vector<WuBox> boxes(1);
+	for (int i = 0; i < 3; i++){
+		boxes[0].low[i] = 0;
+		boxes[0].high[i] = WU_SIDE - 1;
+	}
+	if (wu_box_moment(wu->moments, boxes[0]).count <= 0) return;
+	vector<double> variances(1, wu_variance(wu_box_moment(wu->moments, boxes[0])));
+	while (boxes.size() < colors){
+		// split the box with the largest variance
+		size_t next = max_element(variances.begin(), variances.end()) - variances.begin();
+		if (variances[next] <= 0) break;
+		WuBox upper;
+		if (!wu_cut(wu->moments, boxes[next], upper)){
+			variances[next] = 0;
+			continue;
+		}
+		boxes.push_back(upper);
+		variances[next] = wu_variance(wu_box_moment(wu->moments, boxes[next]));
+		variances.push_back(wu_variance(wu_box_moment(wu->moments, upper)));
+	}
+	for (auto &box: boxes){
+		WuMoment moment = wu_box_moment(wu->moments, box);
+		Color color;
+		color.rgb.red = moment.sum[0] / (255.0 * moment.count);
+		color.rgb.green = moment.sum[1] / (255.0 * moment.count);
+		color.rgb.blue = moment.sum[2] / (255.0 * moment.count);
+		result.push_back(color);
+	}
+}
+
+static void wu_destroy(Quantizer *quantizer)
+{
+	delete reinterpret_cast<WuQuantizer*>(quantizer);
+}
+
+/** \struct KmeansQuantizer
+ * \brief k-means quantizer. Mean colors of histogram bins are converted into Lab color space once per histogram and clustered with pixel count weights.
+ */
+typedef struct KmeansQuantizer{
+	Quantizer quantizer;
+	ColorSpan *points; /**< Mean colors of non-empty bins in Lab color space */
+	vector<float> weights; /**< Pixel counts of non-empty bins */
+}KmeansQuantizer;
+
+static void kmeans_set_histogram(Quantizer *quantizer, const ColorHistogram *histogram)
+{
+	KmeansQuantizer *kmeans = reinterpret_cast<KmeansQuantizer*>(quantizer);
+	if (kmeans->points) color_span_destroy(kmeans->points);
+	const ColorHistogramBin *bins = color_histogram_get_bins(histogram);
+	kmeans->weights.clear();
+	for (int i = 0; i < COLOR_HISTOGRAM_SIZE; i++){
+		if (bins[i].count) kmeans->weights.push_back(bins[i].count);
+	}
+	kmeans->points = color_span_new(kmeans->weights.size());
+	size_t index = 0;
+	for (int i = 0; i < COLOR_HISTOGRAM_SIZE; i++){
+		if (!bins[i].count) continue;
+		for (int j = 0; j < 3; j++)
+			kmeans->points->component[j][index] = bins[i].sum[j] / (255.0 * bins[i].count);
+		index++;
+	}
+	color_batch_rgb_to_lab_d50(kmeans->points, kmeans->points);
+}
+
+/**
+ * Select point with probability proportional to its weight, multiplied by squared distance when distances are specified.
+ */
+static size_t kmeans_select(const vector<float> &weights, const float *distances, mt19937 &random)
+{
+	double total = 0;
+	for (size_t i = 0; i < weights.size(); i++)
+		total += distances ? double(weights[i]) * distances[i] : weights[i];
+	double value = uniform_real_distribution<double>(0, total)(random);
+	for (size_t i = 0; i < weights.size(); i++){
+		value -= distances ? double(weights[i]) * distances[i] : weights[i];
+		if (value < 0) return i;
+	}
+	return weights.size() - 1;
+}
+
+static void kmeans_get_colors(Quantizer *quantizer, uint32_t colors, vector<Color> &result)
+{
+	KmeansQuantizer *kmeans = reinterpret_cast<KmeansQuantizer*>(quantizer);
+	result.clear();
+	if (!kmeans->points || kmeans->points->count == 0 || colors == 0) return;
+	const ColorSpan *points = kmeans->points;
+	size_t count = points->count, k = min<size_t>(colors, count);
+	vector<float> centers;
+	vector<uint32_t> nearest(count);
+	vector<float> distances(count), nearest_distances(count);
+	mt19937 random(KMEANS_SEED);
+	// k-means++ seeding: each new center is selected with probability proportional to squared distance from already selected centers
+	size_t selected = kmeans_select(kmeans->weights, nullptr, random);
+	for (;;){
+		for (int j = 0; j < 3; j++)
+			centers.push_back(points->component[j][selected]);
+		size_t center = centers.size() / 3 - 1;
+		kernels()->nearest(points, &centers[center * 3], 1, &nearest.front(), &distances.front());
+		if (center == 0)
+			nearest_distances = distances;
+		else
+			for (size_t i = 0; i < count; i++)
+				nearest_distances[i] = min(nearest_distances[i], distances[i]);
+		if (center + 1 >= k) break;
+		// every point is a center already
+		if (*max_element(nearest_distances.begin(), nearest_distances.end()) <= 0) break;
+		selected = kmeans_select(kmeans->weights, &nearest_distances.front(), random);
+	}
+	k = centers.size() / 3;
+	vector<double> sums(k * 3), weights(k);
+	for (int iteration = 0; iteration < KMEANS_MAX_ITERATIONS; iteration++){
+		kernels()->nearest(points, &centers.front(), k, &nearest.front(), &distances.front());
+		fill(sums.begin(), sums.end(), 0);
+		fill(weights.begin(), weights.end(), 0);
+		for (size_t i = 0; i < count; i++){
+			uint32_t center = nearest[i];
+			weights[center] += kmeans->weights[i];
+			for (int j = 0; j < 3; j++)
+				sums[center * 3 + j] += double(kmeans->weights[i]) * points->component[j][i];
+		}
+		double max_shift = 0;
+		for (size_t center = 0; center < k; center++){
+			// centers without points are kept in place
+			if (weights[center] <= 0) continue;
+			double shift = 0;
+			for (int j = 0; j < 3; j++){
+				float value = sums[center * 3 + j] / weights[center];
+				shift += (value - centers[center * 3 + j]) * (value - centers[center * 3 + j]);
+				centers[center * 3 + j] = value;
+			}
+			max_shift = max(max_shift, shift);
+		}
+		if (max_shift < KMEANS_MIN_SHIFT * KMEANS_MIN_SHIFT) break;
+	}
+	// colors are ordered by the number of pixels in their clusters
+	vector<size_t> order(k);
+	for (size_t i = 0; i < k; i++)
+		order[i] = i;
+	stable_sort(order.begin(), order.end(), [&weights](size_t a, size_t b){
+		return weights[a] > weights[b];
+	});
+	for (auto center: order){
+		if (weights[center] <= 0) continue;
+		Color lab, color;
+		lab.lab.L = centers[center * 3];
+		lab.lab.a = centers[center * 3 + 1];
+		lab.lab.b = centers[center * 3 + 2];
+		color_lab_to_rgb_d50(&lab, &color);
+		color_rgb_normalize(&color);
+		result.push_back(color);
+	}
+}
+
+static void kmeans_destroy(Quantizer *quantizer)
+{
+	KmeansQuantizer *kmeans = reinterpret_cast<KmeansQuantizer*>(quantizer);
+	if (kmeans->points) color_span_destroy(kmeans->points);
+	delete kmeans;
+}
+
+Quantizer* quantizer_new(QuantizerType type)
+{
+	switch (type){
+		case QUANTIZER_OCTREE:
+			{
+				OctreeQuantizer *octree = new OctreeQuantizer;
+				octree->quantizer.set_histogram = octree_set_histogram;
+				octree->quantizer.get_colors = octree_get_colors;
+				octree->quantizer.destroy = octree_destroy;
+				octree->octree = nullptr;
+				return &octree->quantizer;
+			}
+		case QUANTIZER_MEDIAN_CUT:
+			{
+				MedianCutQuantizer *median_cut = new MedianCutQuantizer;
+				median_cut->quantizer.set_histogram = median_cut_set_histogram;
+				median_cut->quantizer.get_colors = median_cut_get_colors;
+				median_cut->quantizer.destroy = median_cut_destroy;
+				return &median_cut->quantizer;
+			}
+		case QUANTIZER_WU:
+			{
+				WuQuantizer *wu = new WuQuantizer;
+				wu->quantizer.set_histogram = wu_set_histogram;
+				wu->quantizer.get_colors = wu_get_colors;
+				wu->quantizer.destroy = wu_destroy;
+				return &wu->quantizer;
+			}
+		case QUANTIZER_KMEANS:
+		default:
+			{
+				KmeansQuantizer *kmeans = new KmeansQuantizer;
+				kmeans->quantizer.set_histogram = kmeans_set_histogram;
+				kmeans->quantizer.get_colors = kmeans_get_colors;
+				kmeans->quantizer.destroy = kmeans_destroy;
+				kmeans->points = nullptr;
+				return &kmeans->quantizer;
+			}
+	}
+}
+
+const char* quantizer_get_name(QuantizerType type)
+{
+	if (type < 0 || type >= QUANTIZER_COUNT) return nullptr;
+	return quantizer_names[type];
+}
+
+bool quantizer_find_by_name(const char *name, QuantizerType *type)
+{
+	for (int i = 0; i < QUANTIZER_COUNT; i++){
+		if (strcmp(quantizer_names[i], name) == 0){
+			*type = QuantizerType(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void quantizer_set_histogram(Quantizer *quantizer, const ColorHistogram *histogram)
+{
+	quantizer->set_histogram(quantizer, histogram);
+}
+
+void quantizer_get_colors(Quantizer *quantizer, uint32_t colors, vector<Color> &result)
+{
+	quantizer->get_colors(quantizer, colors, result);
+}
+
+void quantizer_destroy(Quantizer *quantizer)
+{
+	quantizer->destroy(quantizer);
+}
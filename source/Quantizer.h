@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_QUANTIZER_H_
+#define GPICK_QUANTIZER_H_
+
+#include "Color.h"
+#include "ColorHistogram.h"
+#include <stdint.h>
+#include <vector>
+
+/** \file source/Quantizer.h
+ * \brief Color quantizers, which find palettes of color histograms.
+ *
+ * Quantizers work on histogram bins instead of pixels, so their cost does not depend on image size. Work, which does not depend on
+ * the number of colors, is done once when histogram is set, so palettes with different numbers of colors can be requested cheaply.
+ */
+
+/** \enum QuantizerType
+ * \brief Available quantizer engines.
+ */
+enum QuantizerType{
+	QUANTIZER_OCTREE = 0, /**< Octree in RGB color space, merging nodes with smallest color spread */
+	QUANTIZER_MEDIAN_CUT = 1, /**< Median cut in RGB color space */
+	QUANTIZER_WU = 2, /**< Wu's variance minimizing box splitting in RGB color space */
+	QUANTIZER_KMEANS = 3, /**< k-means clustering with k-means++ seeding in Lab color space */
+	QUANTIZER_COUNT = 4,
+};
+
+/** \struct Quantizer
+ * \brief Quantizer interface. Implementations embed it as their first member.
+ */
+typedef struct Quantizer{
+	/**
+	 * Prepare quantizer for a histogram.
+	 * @param[in] quantizer Quantizer.
+	 * @param[in] histogram Histogram. Not used after the call.
+	 */
+	void (*set_histogram)(Quantizer *quantizer, const ColorHistogram *histogram);
+	/**
+	 * Find palette of the last histogram.
+	 * @param[in] quantizer Quantizer.
+	 * @param[in] colors Maximum number of colors.
+	 * @param[out] result Colors in RGB color space.
+	 */
+	void (*get_colors)(Quantizer *quantizer, uint32_t colors, std::vector<Color> &result);
+	void (*destroy)(Quantizer *quantizer);
+}Quantizer;
+
+/**
+ * Create quantizer.
+ * @param[in] type Quantizer engine.
+ * @return New quantizer without histogram.
+ */
+Quantizer* quantizer_new(QuantizerType type);
+
+/**
+ * Get quantizer engine name, which can be used in settings and command line options.
+ * @param[in] type Quantizer engine.
+ * @return Engine name.
+ */
+const char* quantizer_get_name(QuantizerType type);
+
+/**
+ * Find quantizer engine by name.
+ * @param[in] name Engine name.
+ * @param[out] type Quantizer engine.
+ * @return True if engine was found.
+ */
+bool quantizer_find_by_name(const char *name, QuantizerType *type);
+
+void quantizer_set_histogram(Quantizer *quantizer, const ColorHistogram *histogram);
+void quantizer_get_colors(Quantizer *quantizer, uint32_t colors, std::vector<Color> &result);
+void quantizer_destroy(Quantizer *quantizer);
+
+#endif /* GPICK_QUANTIZER_H_ */
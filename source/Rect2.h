@@ -45,6 +45,7 @@ public:
 		if (empty) return rect;
 
 		Rect2 r;
+		r.empty = false;
 
 		if (x1 < rect.x1) r.x1 = x1;
 		else r.x1 = rect.x1;
@@ -74,6 +75,18 @@ public:
 		return r;
 	}
 
+	Rect2 intersection(const Rect2 &rect) const{
+		if (empty || rect.empty) return Rect2();
+		Rect2 r;
+		r.x1 = x1 > rect.x1 ? x1 : rect.x1;
+		r.y1 = y1 > rect.y1 ? y1 : rect.y1;
+		r.x2 = x2 < rect.x2 ? x2 : rect.x2;
+		r.y2 = y2 < rect.y2 ? y2 : rect.y2;
+		if (r.x1 >= r.x2 || r.y1 >= r.y2) return Rect2();
+		r.empty = false;
+		return r;
+	}
+
 	bool isInside(const T &x, const T &y) const{
 		if (x<x1 || x>x2 || y<y1 || y>y2)
 			return false;
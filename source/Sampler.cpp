@@ -19,8 +19,11 @@
 
 #include "Sampler.h"
 #include "MathUtil.h"
+#include "simd/Kernels.h"
 #include <math.h>
+#include <stdint.h>
 #include <gdk/gdk.h>
+#include <vector>
 
 using namespace math;
 
@@ -29,8 +32,15 @@ struct Sampler{
 	enum SamplerFalloff falloff;
 	float (*falloff_fnc)(float distance);
 	struct ScreenReader* screen_reader;
+	std::vector<uint16_t> kernel; /**< Falloff weights of (2 * oversample + 1)^2 pixels, repeated for each channel */
+	uint64_t kernel_total; /**< Sum of all falloff weights */
 };
 
+static inline const SamplerKernels* kernels()
+{
+	return kernels_sampler();
+}
+
 static float sampler_falloff_none(float distance) {
 	return 1;
 }
@@ -65,6 +75,28 @@ void sampler_destroy(struct Sampler *sampler) {
 }
 
 
+/**
+ * Precalculate falloff weights, as they only depend on oversample and falloff function.
+ */
+static void sampler_update_kernel(struct Sampler *sampler)
+{
+	int oversample = sampler->oversample;
+	int size = oversample * 2 + 1;
+	sampler->kernel.assign(size * size * 3, 0);
+	sampler->kernel_total = 0;
+	if (!sampler->falloff_fnc) return;
+	float max_distance = oversample ? 1 / sqrt(2 * pow((double)oversample, 2)) : 0;
+	uint16_t *weights = sampler->kernel.data();
+	for (int y = -oversample; y <= oversample; ++y){
+		for (int x = -oversample; x <= oversample; ++x, weights += 3){
+			float f = sampler->falloff_fnc(sqrt((double)(x * x + y * y)) * max_distance);
+			uint16_t weight = uint16_t(clamp_float(f, 0, 1) * 32767 + 0.5f);
+			weights[0] = weights[1] = weights[2] = weight;
+			sampler->kernel_total += weight;
+		}
+	}
+}
+
 void sampler_set_falloff(struct Sampler *sampler, enum SamplerFalloff falloff) {
 	sampler->falloff = falloff;
 	switch (falloff){
@@ -86,27 +118,65 @@ void sampler_set_falloff(struct Sampler *sampler, enum SamplerFalloff falloff) {
 	default:
 		sampler->falloff_fnc = 0;
 	}
+	sampler_update_kernel(sampler);
 }
 
 void sampler_set_oversample(struct Sampler *sampler, int oversample){
 	sampler->oversample = oversample;
+	sampler_update_kernel(sampler);
 }
 
-static void get_pixel(const guchar *pixels, int row_stride, int x, int y, Color* color)
+#define GDK_PIXBUF_VERSION_GE(a, b) (GDK_PIXBUF_MAJOR > a || (GDK_PIXBUF_MAJOR == a && GDK_PIXBUF_MINOR >= b))
+static void sampler_get_box_sample(const guchar *pixels, int row_stride, const Rect2<int> &box, Color *color)
 {
-	const guchar *p;
-	p = pixels + y * row_stride + x * 3;
-	color->rgb.red = p[0] / 255.0;
-	color->rgb.green = p[1] / 255.0;
-	color->rgb.blue = p[2] / 255.0;
+	uint32_t sum[3] = {0, 0, 0};
+	for (int y = box.getTop(); y < box.getBottom(); ++y){
+		const guchar *p = pixels + y * row_stride + box.getX() * 3;
+		for (int x = box.getLeft(); x < box.getRight(); ++x, p += 3){
+			sum[0] += p[0];
+			sum[1] += p[1];
+			sum[2] += p[2];
+		}
+	}
+	float divider = 1 / (255.0f * box.getWidth() * box.getHeight());
+	color->rgb.red = sum[0] * divider;
+	color->rgb.green = sum[1] * divider;
+	color->rgb.blue = sum[2] * divider;
+}
+static void sampler_get_weighted_sample(struct Sampler *sampler, const guchar *pixels, int row_stride, const Rect2<int> &box, int center_x, int center_y, Color *color)
+{
+	int oversample = sampler->oversample;
+	int size = oversample * 2 + 1;
+	int width = box.getWidth(), height = box.getHeight();
+	int kernel_x = oversample - center_x, kernel_y = oversample - center_y;
+	SamplerWeightedSumKernel weighted_sum = kernels()->weighted_sum;
+	uint64_t sums[3] = {0, 0, 0};
+	uint64_t divider = 0;
+	bool clipped = width != size || height != size;
+	for (int y = 0; y < height; ++y){
+		const guchar *p = pixels + (box.getY() + y) * row_stride + box.getX() * 3;
+		const uint16_t *weights = sampler->kernel.data() + ((kernel_y + y) * size + kernel_x) * 3;
+		for (int x = 0; x < width; x += int(SAMPLER_KERNEL_MAX_COUNT)){
+			weighted_sum(p + x * 3, weights + x * 3, min_int(width - x, int(SAMPLER_KERNEL_MAX_COUNT)), sums);
+		}
+		if (clipped){
+			for (int x = 0; x < width; ++x)
+				divider += weights[x * 3];
+		}
+	}
+	if (!clipped)
+		divider = sampler->kernel_total;
+	if (divider == 0){
+		color_zero(color);
+		return;
+	}
+	double scale = 1 / (255.0 * divider);
+	color->rgb.red = sums[0] * scale;
+	color->rgb.green = sums[1] * scale;
+	color->rgb.blue = sums[2] * scale;
 }
-#define GDK_PIXBUF_VERSION_GE(a, b) (GDK_PIXBUF_MAJOR > a || (GDK_PIXBUF_MAJOR == a && GDK_PIXBUF_MINOR >= b))
 int sampler_get_color_sample(struct Sampler *sampler, Vec2<int>& pointer, Rect2<int>& screen_rect, Vec2<int>& offset, Color* color)
 {
-	Color sample;
-	Color result;
-	float divider = 0;
-	color_zero(&result);
 	GdkPixbuf* pixbuf = screen_reader_get_pixbuf(sampler->screen_reader);
 	int x = pointer.x, y = pointer.y;
 	int left, right, top, bottom;
@@ -124,26 +194,17 @@ int sampler_get_color_sample(struct Sampler *sampler, Vec2<int>& pointer, Rect2<
 #else
 	const guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
 #endif
-	float max_distance = 1 / sqrt(2 * pow((double)sampler->oversample, 2));
-	for (int x=-sampler->oversample; x <= sampler->oversample; ++x){
-		for (int y=-sampler->oversample; y <= sampler->oversample; ++y){
-			if ((center_x + x < 0) || (center_y + y < 0)) continue;
-			if ((center_x + x >= width) || (center_y + y >= height)) continue;
-			get_pixel(pixels, row_stride, offset.x + center_x+x, offset.y + center_y+y, &sample);
-			float f;
-			if (sampler->oversample){
-				f = sampler->falloff_fnc(sqrt((double)(x * x + y * y)) * max_distance);
-			}else{
-				f = 1;
-			}
-			color_multiply(&sample, f);
-			color_add(&result, &sample);
-			divider+=f;
-		}
+	if (width <= 0 || height <= 0){
+		color_zero(color);
+		return 0;
+	}
+	// sampled pixels always form a rectangle, which starts at offset in pixbuf coordinates
+	Rect2<int> box(offset.x, offset.y, offset.x + width, offset.y + height);
+	if (sampler->oversample == 0 || sampler->falloff == NONE){
+		sampler_get_box_sample(pixels, row_stride, box, color);
+	}else{
+		sampler_get_weighted_sample(sampler, pixels, row_stride, box, center_x, center_y, color);
 	}
-	if (divider > 0)
-		color_multiply(&result, 1 / divider);
-	color_copy(&result, color);
 	return 0;
 }
 
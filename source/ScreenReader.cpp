@@ -18,29 +18,76 @@
 
 
 #include "ScreenReader.h"
+#include "ScreenSource.h"
 #include "Rect2.h"
 
 #include <algorithm>
+#include <string.h>
 
 using namespace math;
 
-struct ScreenReader{
+/** \struct ScreenReaderBuffer
+ * \brief Capture buffer of a single monitor.
+ */
+typedef struct ScreenReaderBuffer{
+	Rect2<int> screen_rect; /**< Monitor area. Empty for reads without monitor */
 	GdkPixbuf *pixbuf;
-	int max_size;
+	int size; /**< Pixbuf width and height */
+	uint32_t last_use; /**< Generation of the last read */
+}ScreenReaderBuffer;
+
+struct ScreenReader{
+	ScreenReaderBuffer buffers[SCREEN_READER_MAX_BUFFERS];
+	int buffer_count;
+	ScreenReaderBuffer *current; /**< Buffer of the last read */
+	GdkPixbuf *pixbuf; /**< Pixbuf of the last read */
 	GdkScreen *screen;
 	Rect2<int> read_area;
+	Rect2<int> screen_rect; /**< Monitor containing requested areas */
+	ScreenSource *source;
+	uint32_t generation;
+	uint32_t hash_generation;
+	uint64_t hash;
+	int read_width;
+	int read_height;
+	uint64_t allocations;
 };
 
+static const int SCREEN_READER_INITIAL_SIZE = 150;
+
 struct ScreenReader* screen_reader_new(){
+	return screen_reader_new_with_source(screen_source_display_new());
+}
+
+static GdkPixbuf* screen_reader_new_pixbuf(struct ScreenReader *screen, int size){
+	screen->allocations++;
+	return gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, size, size);
+}
+
+struct ScreenReader* screen_reader_new_with_source(ScreenSource *source){
 	struct ScreenReader* screen = new struct ScreenReader;
-	screen->max_size = 150;
-	screen->pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, 150, 150);
+	screen->buffer_count = 1;
+	screen->buffers[0].last_use = 0;
+	screen->allocations = 0;
+	screen->buffers[0].pixbuf = screen_reader_new_pixbuf(screen, SCREEN_READER_INITIAL_SIZE);
+	screen->buffers[0].size = SCREEN_READER_INITIAL_SIZE;
+	screen->current = &screen->buffers[0];
+	screen->pixbuf = screen->current->pixbuf;
 	screen->screen = nullptr;
+	screen->source = source;
+	screen->generation = 0;
+	screen->hash_generation = 0;
+	screen->hash = 0;
+	screen->read_width = 0;
+	screen->read_height = 0;
 	return screen;
 }
 
 void screen_reader_destroy(struct ScreenReader *screen) {
-	if (screen->pixbuf) g_object_unref(screen->pixbuf);
+	screen_source_destroy(screen->source);
+	for (int i = 0; i < screen->buffer_count; i++){
+		if (screen->buffers[i].pixbuf) g_object_unref(screen->buffers[i].pixbuf);
+	}
 	delete screen;
 }
 
@@ -53,32 +100,133 @@ void screen_reader_add_rect(struct ScreenReader *screen, GdkScreen *gdk_screen,
 	}
 }
 
+void screen_reader_set_screen_rect(struct ScreenReader *screen, Rect2<int>& screen_rect){
+	screen->screen_rect = screen_rect;
+}
+
 void screen_reader_reset_rect(struct ScreenReader *screen){
 	screen->read_area = Rect2<int>();
+	screen->screen_rect = Rect2<int>();
 	screen->screen = nullptr;
 }
 
-void screen_reader_update_pixbuf(struct ScreenReader *screen, Rect2<int>* update_rect){
-	if (!screen->screen) return;
+static bool screen_reader_is_same_rect(const Rect2<int> &a, const Rect2<int> &b){
+	if (a.isEmpty() || b.isEmpty()) return a.isEmpty() == b.isEmpty();
+	return a.getX() == b.getX() && a.getY() == b.getY() && a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight();
+}
+
+/**
+ * Find buffer of the monitor. When all buffers are used, least recently used buffer is taken over together with its pixbuf, so moving between monitors does not allocate.
+ */
+static ScreenReaderBuffer* screen_reader_get_buffer(struct ScreenReader *screen, const Rect2<int> &screen_rect){
+	ScreenReaderBuffer *oldest = &screen->buffers[0];
+	for (int i = 0; i < screen->buffer_count; i++){
+		ScreenReaderBuffer *buffer = &screen->buffers[i];
+		if (screen_reader_is_same_rect(buffer->screen_rect, screen_rect)) return buffer;
+		if (buffer->last_use < oldest->last_use) oldest = buffer;
+	}
+	// the first buffer is created before any monitor is known, so it is assigned to the first monitor used
+	if (screen->generation == 0 && screen->buffers[0].last_use == 0){
+		screen->buffers[0].screen_rect = screen_rect;
+		return &screen->buffers[0];
+	}
+	if (screen->buffer_count < SCREEN_READER_MAX_BUFFERS){
+		ScreenReaderBuffer *buffer = &screen->buffers[screen->buffer_count++];
+		buffer->screen_rect = screen_rect;
+		buffer->pixbuf = nullptr;
+		buffer->size = 0;
+		buffer->last_use = 0;
+		return buffer;
+	}
+	oldest->screen_rect = screen_rect;
+	return oldest;
+}
 
-	GdkWindow* root_window = gdk_screen_get_root_window(screen->screen);
-	GdkColormap* colormap = gdk_screen_get_system_colormap(screen->screen);
+void screen_reader_update_pixbuf(struct ScreenReader *screen, Rect2<int>* update_rect){
+	if (screen->read_area.isEmpty()) return;
+	// requested areas are centered around the pointer, so nothing outside of its monitor has to be read
+	Rect2<int> read_area = screen->read_area;
+	if (!screen->screen_rect.isEmpty()){
+		read_area = read_area.intersection(screen->screen_rect);
+		if (read_area.isEmpty()) return;
+	}
 
-	int left = screen->read_area.getX();
-	int top = screen->read_area.getY();
-	int width = screen->read_area.getWidth();
-	int height = screen->read_area.getHeight();
+	int left = read_area.getX();
+	int top = read_area.getY();
+	int width = read_area.getWidth();
+	int height = read_area.getHeight();
 
-	if (width > screen->max_size || height > screen->max_size){
-		if (screen->pixbuf) g_object_unref(screen->pixbuf);
-		screen->max_size = (std::max(width, height) / 150 + 1) * 150;
-		screen->pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, screen->max_size, screen->max_size);
+	ScreenReaderBuffer *buffer = screen_reader_get_buffer(screen, screen->screen_rect);
+	GdkPixbuf *pixbuf = buffer->pixbuf;
+	int size = buffer->size;
+	if (width > size || height > size){
+		size = std::max(size, (std::max(width, height) / SCREEN_READER_INITIAL_SIZE + 1) * SCREEN_READER_INITIAL_SIZE);
+		// buffer never has to be larger than its monitor
+		if (!screen->screen_rect.isEmpty())
+			size = std::min(size, std::max(std::max(screen->screen_rect.getWidth(), screen->screen_rect.getHeight()), std::max(width, height)));
+		pixbuf = screen_reader_new_pixbuf(screen, size);
 	}
 
-	gdk_pixbuf_get_from_drawable(screen->pixbuf, root_window, colormap, left, top, 0, 0, width, height);
-	*update_rect = screen->read_area;
+	// larger pixbuf replaces the old one only after a successful read, as the old one can still be the pixbuf of the last read
+	if (!screen->source->read(screen->source, screen->screen, left, top, width, height, pixbuf)){
+		if (pixbuf != buffer->pixbuf) g_object_unref(pixbuf);
+		return;
+	}
+	if (pixbuf != buffer->pixbuf){
+		if (buffer->pixbuf) g_object_unref(buffer->pixbuf);
+		buffer->pixbuf = pixbuf;
+		buffer->size = size;
+	}
+	screen->generation++;
+	buffer->last_use = screen->generation;
+	screen->current = buffer;
+	screen->pixbuf = buffer->pixbuf;
+	screen->read_width = width;
+	screen->read_height = height;
+	*update_rect = read_area;
 }
 
 GdkPixbuf* screen_reader_get_pixbuf(struct ScreenReader *screen){
 	return screen->pixbuf;
 }
+
+void screen_reader_get_statistics(struct ScreenReader *screen, ScreenReaderStatistics *statistics){
+	statistics->buffers = screen->buffer_count;
+	statistics->memory = 0;
+	for (int i = 0; i < screen->buffer_count; i++){
+		const ScreenReaderBuffer &buffer = screen->buffers[i];
+		if (buffer.pixbuf)
+			statistics->memory += size_t(gdk_pixbuf_get_rowstride(buffer.pixbuf)) * gdk_pixbuf_get_height(buffer.pixbuf);
+	}
+	statistics->allocations = screen->allocations;
+}
+
+uint32_t screen_reader_get_generation(struct ScreenReader *screen){
+	return screen->generation;
+}
+
+uint64_t screen_reader_get_hash(struct ScreenReader *screen){
+	if (screen->hash_generation == screen->generation) return screen->hash;
+	const uint64_t prime = 0x100000001b3ull;
+	uint64_t hash = 0xcbf29ce484222325ull;
+	int row_stride = gdk_pixbuf_get_rowstride(screen->pixbuf);
+	const guchar *pixels = gdk_pixbuf_get_pixels(screen->pixbuf);
+	size_t row_size = screen->read_width * 3;
+	for (int y = 0; y < screen->read_height; y++){
+		const guchar *p = pixels + y * row_stride;
+		size_t i = 0;
+		// FNV-1a applied to 8 byte words instead of single bytes
+		for (; i + 8 <= row_size; i += 8){
+			uint64_t word;
+			memcpy(&word, p + i, sizeof(word));
+			hash = (hash ^ word) * prime;
+		}
+		for (; i < row_size; i++){
+			hash = (hash ^ p[i]) * prime;
+		}
+	}
+	hash ^= uint64_t(screen->read_width) << 32 | uint32_t(screen->read_height);
+	screen->hash = hash;
+	screen->hash_generation = screen->generation;
+	return hash;
+}
@@ -21,17 +21,63 @@
 
 #include <gdk/gdk.h>
 #include "Rect2.h"
+#include <stddef.h>
+#include <stdint.h>
 
 struct ScreenReader;
+struct ScreenSource;
+
+/** Number of monitors, which keep their own capture buffer. */
+const int SCREEN_READER_MAX_BUFFERS = 4;
+
+/** \struct ScreenReaderStatistics
+ * \brief Capture buffer usage.
+ */
+typedef struct ScreenReaderStatistics{
+	int buffers; /**< Capture buffers in use */
+	size_t memory; /**< Pixel memory of all capture buffers in bytes */
+	uint64_t allocations; /**< Capture buffer allocations since screen reader was created */
+}ScreenReaderStatistics;
 
 struct ScreenReader* screen_reader_new();
+/**
+ * Create screen reader, which reads pixels from a custom screen source.
+ * @param[in] source Screen source. Screen reader takes ownership of it.
+ * @return New screen reader.
+ */
+struct ScreenReader* screen_reader_new_with_source(struct ScreenSource *source);
 
 void screen_reader_reset_rect(struct ScreenReader *screen);
 
 void screen_reader_add_rect(struct ScreenReader *screen, GdkScreen *gdk_screen, math::Rect2<int>& rect);
+/**
+ * Set monitor containing requested areas. Each monitor keeps its own capture buffer, and read area is limited to the monitor.
+ * Reset by screen_reader_reset_rect.
+ * @param[in] screen Screen reader.
+ * @param[in] screen_rect Monitor area.
+ */
+void screen_reader_set_screen_rect(struct ScreenReader *screen, math::Rect2<int>& screen_rect);
 
 void screen_reader_update_pixbuf(struct ScreenReader *screen, math::Rect2<int>* update_rect);
 GdkPixbuf* screen_reader_get_pixbuf(struct ScreenReader *screen);
+/**
+ * Get capture generation. It changes every time pixbuf contents are updated, so cached data derived from pixbuf can be invalidated.
+ * @param[in] screen Screen reader.
+ * @return Capture generation.
+ */
+uint32_t screen_reader_get_generation(struct ScreenReader *screen);
+/**
+ * Get hash of pixels read by the last pixbuf update. Used to detect whether the screen under the pointer has changed.
+ * @param[in] screen Screen reader.
+ * @return Pixel hash.
+ */
+uint64_t screen_reader_get_hash(struct ScreenReader *screen);
+/**
+ * Get capture buffer usage.
+ * @param[in] screen Screen reader.
+ * @param[out] statistics Capture buffer usage.
+ */
+void screen_reader_get_statistics(struct ScreenReader *screen, ScreenReaderStatistics *statistics);
 
 void screen_reader_destroy(struct ScreenReader *screen);
 
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ScreenSource.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef HAVE_XSHM
+#include "ScreenSourceShm.h"
+#include <gdk/gdkx.h>
+#endif
+
+typedef struct ScreenSourceDisplay{
+	ScreenSource source;
+#ifdef HAVE_XSHM
+	ScreenSourceShm shm;
+#endif
+}ScreenSourceDisplay;
+static bool screen_source_display_read(ScreenSource *source, GdkScreen *screen, int left, int top, int width, int height, GdkPixbuf *pixbuf)
+{
+	if (!screen) return false;
+	GdkWindow* root_window = gdk_screen_get_root_window(screen);
+#ifdef HAVE_XSHM
+	ScreenSourceDisplay *display_source = reinterpret_cast<ScreenSourceDisplay*>(source);
+	// areas partially outside of the screen are left to GDK, which clips them
+	if (left >= 0 && top >= 0 && left + width <= gdk_screen_get_width(screen) && top + height <= gdk_screen_get_height(screen)){
+		Visual *visual = gdk_x11_visual_get_xvisual(gdk_drawable_get_visual(root_window));
+		if (screen_source_shm_read(&display_source->shm, GDK_WINDOW_XDISPLAY(root_window), GDK_WINDOW_XID(root_window), visual, gdk_drawable_get_depth(root_window), left, top, width, height, pixbuf, 0, 0)) return true;
+	}
+#endif
+	GdkColormap* colormap = gdk_screen_get_system_colormap(screen);
+	gdk_pixbuf_get_from_drawable(pixbuf, root_window, colormap, left, top, 0, 0, width, height);
+	return true;
+}
+static void screen_source_display_destroy(ScreenSource *source)
+{
+	ScreenSourceDisplay *display_source = reinterpret_cast<ScreenSourceDisplay*>(source);
+#ifdef HAVE_XSHM
+	screen_source_shm_release(&display_source->shm);
+#endif
+	delete display_source;
+}
+ScreenSource* screen_source_display_new()
+{
+	ScreenSourceDisplay *display_source = new ScreenSourceDisplay;
+	display_source->source.read = screen_source_display_read;
+	display_source->source.destroy = screen_source_display_destroy;
+#ifdef HAVE_XSHM
+	screen_source_shm_init(&display_source->shm, true);
+	// GPICK_SCREEN_READER=gdk selects GDK capture, so both capture paths can be compared, for example under Xvfb
+	const char *backend = getenv("GPICK_SCREEN_READER");
+	display_source->shm.disabled = backend && strcmp(backend, "gdk") == 0;
+#endif
+	return &display_source->source;
+}
+typedef struct ScreenSourceImage{
+	ScreenSource source;
+	GdkPixbuf *image; /**< Image in RGB format without alpha channel */
+}ScreenSourceImage;
+static bool screen_source_image_read(ScreenSource *source, GdkScreen *screen, int left, int top, int width, int height, GdkPixbuf *pixbuf)
+{
+	GdkPixbuf *image = reinterpret_cast<ScreenSourceImage*>(source)->image;
+	int image_width = gdk_pixbuf_get_width(image), image_height = gdk_pixbuf_get_height(image);
+	int image_rowstride = gdk_pixbuf_get_rowstride(image), rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+	const guchar *image_pixels = gdk_pixbuf_get_pixels(image);
+	guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
+	// pixels outside of the image are black, like areas outside of all monitors
+	int copy_left = std::max(left, 0), copy_right = std::min(left + width, image_width);
+	for (int y = 0; y < height; y++){
+		guchar *row = pixels + y * rowstride;
+		if (top + y < 0 || top + y >= image_height || copy_left >= copy_right){
+			memset(row, 0, width * 3);
+			continue;
+		}
+		memset(row, 0, (copy_left - left) * 3);
+		memcpy(row + (copy_left - left) * 3, image_pixels + (top + y) * image_rowstride + copy_left * 3, (copy_right - copy_left) * 3);
+		memset(row + (copy_right - left) * 3, 0, (left + width - copy_right) * 3);
+	}
+	return true;
+}
+static void screen_source_image_destroy(ScreenSource *source)
+{
+	ScreenSourceImage *image_source = reinterpret_cast<ScreenSourceImage*>(source);
+	g_object_unref(image_source->image);
+	delete image_source;
+}
+ScreenSource* screen_source_image_new(GdkPixbuf *image)
+{
+	ScreenSourceImage *image_source = new ScreenSourceImage;
+	image_source->source.read = screen_source_image_read;
+	image_source->source.destroy = screen_source_image_destroy;
+	int width = gdk_pixbuf_get_width(image), height = gdk_pixbuf_get_height(image);
+	image_source->image = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, width, height);
+	// convert image to the same format as screen reader pixbuf, so that reads are plain row copies
+	int channels = gdk_pixbuf_get_n_channels(image);
+	int rowstride = gdk_pixbuf_get_rowstride(image), target_rowstride = gdk_pixbuf_get_rowstride(image_source->image);
+	const guchar *pixels = gdk_pixbuf_get_pixels(image);
+	guchar *target_pixels = gdk_pixbuf_get_pixels(image_source->image);
+	for (int y = 0; y < height; y++){
+		for (int x = 0; x < width; x++){
+			memcpy(target_pixels + y * target_rowstride + x * 3, pixels + y * rowstride + x * channels, 3);
+		}
+	}
+	return &image_source->source;
+}
+ScreenSource* screen_source_image_new_from_file(const char *filename)
+{
+	GdkPixbuf *image = gdk_pixbuf_new_from_file(filename, nullptr);
+	if (!image) return nullptr;
+	ScreenSource *source = screen_source_image_new(image);
+	g_object_unref(image);
+	return source;
+}
+void screen_source_destroy(ScreenSource *source)
+{
+	source->destroy(source);
+}
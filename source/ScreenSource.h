@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SCREEN_SOURCE_H_
+#define GPICK_SCREEN_SOURCE_H_
+
+#include <gdk/gdk.h>
+
+/** \file source/ScreenSource.h
+ * \brief Sources of screen pixels for ScreenReader.
+ */
+
+/** \struct ScreenSource
+ * \brief Screen pixel source interface. Implementations embed it as their first member.
+ */
+typedef struct ScreenSource{
+	/**
+	 * Copy screen area into the top left corner of a pixbuf.
+	 * @param[in] source Screen source.
+	 * @param[in] screen Screen to read from. Can be null for sources, which do not use a display.
+	 * @param[in] left Left coordinate of the area.
+	 * @param[in] top Top coordinate of the area.
+	 * @param[in] width Width of the area.
+	 * @param[in] height Height of the area.
+	 * @param[in] pixbuf RGB pixbuf without alpha channel, which is at least as large as the area.
+	 * @return True on success.
+	 */
+	bool (*read)(ScreenSource *source, GdkScreen *screen, int left, int top, int width, int height, GdkPixbuf *pixbuf);
+	void (*destroy)(ScreenSource *source);
+}ScreenSource;
+
+/**
+ * Create screen source, which reads root window of a display. Uses MIT-SHM extension when available.
+ * @return New screen source.
+ */
+ScreenSource* screen_source_display_new();
+/**
+ * Create screen source, which reads pixels from an image instead of a display.
+ * @param[in] image Image, which is copied.
+ * @return New screen source.
+ */
+ScreenSource* screen_source_image_new(GdkPixbuf *image);
+/**
+ * Create screen source, which reads pixels from an image file instead of a display.
+ * @param[in] filename Image file name.
+ * @return New screen source or null when image can not be loaded.
+ */
+ScreenSource* screen_source_image_new_from_file(const char *filename);
+void screen_source_destroy(ScreenSource *source);
+
+#endif /* GPICK_SCREEN_SOURCE_H_ */
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ScreenSourceShm.h"
+#ifdef HAVE_XSHM
+#include <X11/Xutil.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <stdint.h>
+
+void screen_source_shm_init(ScreenSourceShm *shm, bool trap_errors)
+{
+	shm->display = nullptr;
+	shm->capacity = 0;
+	shm->image = nullptr;
+	shm->disabled = false;
+	shm->trap_errors = trap_errors;
+	shm->error_code = nullptr;
+}
+void screen_source_shm_release(ScreenSourceShm *shm)
+{
+	if (shm->image){
+		XDestroyImage(shm->image);
+		shm->image = nullptr;
+	}
+	if (shm->capacity){
+		XShmDetach(shm->display, &shm->info);
+		shmdt(shm->info.shmaddr);
+		shm->capacity = 0;
+	}
+}
+static void screen_source_shm_trap_push(ScreenSourceShm *shm)
+{
+	if (shm->trap_errors)
+		gdk_error_trap_push();
+	else if (shm->error_code)
+		*shm->error_code = Success;
+}
+/**
+ * Wait until X server processes all requests.
+ * @return Code of X error made by requests since screen_source_shm_trap_push, or Success.
+ */
+static int screen_source_shm_trap_pop(ScreenSourceShm *shm)
+{
+	XSync(shm->display, False);
+	if (shm->trap_errors)
+		return gdk_error_trap_pop();
+	return shm->error_code ? *shm->error_code : Success;
+}
+static bool screen_source_shm_allocate(ScreenSourceShm *shm, Display *display, size_t capacity)
+{
+	screen_source_shm_release(shm);
+	shm->display = display;
+	shm->info.shmid = shmget(IPC_PRIVATE, capacity, IPC_CREAT | 0600);
+	if (shm->info.shmid < 0) return false;
+	shm->info.shmaddr = reinterpret_cast<char*>(shmat(shm->info.shmid, nullptr, 0));
+	if (shm->info.shmaddr == reinterpret_cast<char*>(-1)){
+		shmctl(shm->info.shmid, IPC_RMID, nullptr);
+		return false;
+	}
+	shm->info.readOnly = False;
+	screen_source_shm_trap_push(shm);
+	Status attached = XShmAttach(display, &shm->info);
+	attached = screen_source_shm_trap_pop(shm) == Success && attached;
+	// segment is removed as soon as both processes detach from it, so it does not leak if gpick crashes
+	shmctl(shm->info.shmid, IPC_RMID, nullptr);
+	if (!attached){
+		shmdt(shm->info.shmaddr);
+		return false;
+	}
+	shm->capacity = capacity;
+	return true;
+}
+static bool screen_source_shm_is_supported_image(const XImage *image)
+{
+	const uint32_t byte_order_probe = 1;
+	int native_byte_order = (*reinterpret_cast<const uint8_t*>(&byte_order_probe) == 1) ? LSBFirst : MSBFirst;
+	return image->bits_per_pixel == 32 && image->byte_order == native_byte_order && image->red_mask == 0xff0000 && image->green_mask == 0xff00 && image->blue_mask == 0xff;
+}
+bool screen_source_shm_read(ScreenSourceShm *shm, Display *display, Drawable drawable, Visual *visual, int depth, int left, int top, int width, int height, GdkPixbuf *pixbuf, int pixbuf_x, int pixbuf_y)
+{
+	if (shm->disabled) return false;
+	if (shm->capacity == 0 || shm->display != display){
+		if (!XShmQueryExtension(display)){
+			shm->disabled = true;
+			return false;
+		}
+	}
+	size_t capacity = size_t(gdk_pixbuf_get_width(pixbuf)) * gdk_pixbuf_get_height(pixbuf) * 4;
+	if (shm->capacity < capacity || shm->display != display){
+		if (!screen_source_shm_allocate(shm, display, capacity)){
+			shm->disabled = true;
+			return false;
+		}
+	}
+	if (shm->image == nullptr || shm->image->width != width || shm->image->height != height){
+		if (shm->image) XDestroyImage(shm->image);
+		shm->image = XShmCreateImage(display, visual, depth, ZPixmap, shm->info.shmaddr, &shm->info, width, height);
+		if (shm->image == nullptr || !screen_source_shm_is_supported_image(shm->image) || size_t(shm->image->bytes_per_line) * height > shm->capacity){
+			screen_source_shm_release(shm);
+			shm->disabled = true;
+			return false;
+		}
+	}
+	screen_source_shm_trap_push(shm);
+	Bool captured = XShmGetImage(display, drawable, shm->image, left, top, AllPlanes);
+	int error_code = screen_source_shm_trap_pop(shm);
+	// area is outside of the drawable when screen is resized after the caller has checked its size. Next read can succeed, so MIT-SHM stays enabled
+	if (error_code == BadMatch) return false;
+	if (error_code != Success || !captured){
+		screen_source_shm_release(shm);
+		shm->disabled = true;
+		return false;
+	}
+	guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
+	int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+	for (int y = 0; y < height; y++){
+		const uint32_t *source = reinterpret_cast<const uint32_t*>(shm->image->data + y * shm->image->bytes_per_line);
+		guchar *destination = pixels + (pixbuf_y + y) * rowstride + pixbuf_x * 3;
+		for (int x = 0; x < width; x++){
+			uint32_t pixel = source[x];
+			destination[0] = pixel >> 16;
+			destination[1] = pixel >> 8;
+			destination[2] = pixel;
+			destination += 3;
+		}
+	}
+	return true;
+}
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SCREEN_SOURCE_SHM_H_
+#define GPICK_SCREEN_SOURCE_SHM_H_
+
+#ifdef HAVE_XSHM
+#include <gdk/gdk.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
+
+/** \file source/ScreenSourceShm.h
+ * \brief Screen capture through MIT-SHM extension, shared by screen sources of GDK display and capture thread display.
+ */
+
+/** \struct ScreenSourceShm
+ * \brief MIT-SHM capture state. Shared memory segment is kept between captures and only grows with the read area.
+ */
+typedef struct ScreenSourceShm{
+	Display *display;
+	XShmSegmentInfo info;
+	size_t capacity; /**< Shared memory segment size in bytes */
+	XImage *image; /**< Image header for the current read area size, pointing into the shared memory segment */
+	bool disabled; /**< Extension is not available or capture has failed, so other capture method must be used */
+	bool trap_errors; /**< X errors are caught with GDK error traps, which can only be used from the main thread */
+	int *error_code; /**< Code of the last X error, set by error handler of display connection. Checked instead of GDK error traps when trap_errors is false. Can be nullptr */
+}ScreenSourceShm;
+
+/**
+ * Initialize MIT-SHM capture state. Nothing is allocated until the first read.
+ * @param[in] shm Capture state.
+ * @param[in] trap_errors Catch X errors with GDK error traps. Must be false when reads are made outside of the main thread, where error_code should be set instead.
+ */
+void screen_source_shm_init(ScreenSourceShm *shm, bool trap_errors);
+/**
+ * Capture area of a drawable into pixbuf. Area must be fully inside of the drawable.
+ * @param[in] shm Capture state.
+ * @param[in] display Display connection. Segment is reattached when it changes.
+ * @param[in] drawable Drawable to read from.
+ * @param[in] visual Visual of the drawable.
+ * @param[in] depth Depth of the drawable.
+ * @param[in] left Left coordinate of the area.
+ * @param[in] top Top coordinate of the area.
+ * @param[in] width Width of the area.
+ * @param[in] height Height of the area.
+ * @param[in] pixbuf RGB pixbuf without alpha channel. Its size limits the size of the shared memory segment.
+ * @param[in] pixbuf_x Horizontal position of the area in pixbuf.
+ * @param[in] pixbuf_y Vertical position of the area in pixbuf.
+ * @return True on success. False when other capture method must be used instead, or when the area is not inside of the drawable anymore.
+ */
+bool screen_source_shm_read(ScreenSourceShm *shm, Display *display, Drawable drawable, Visual *visual, int depth, int left, int top, int width, int height, GdkPixbuf *pixbuf, int pixbuf_x, int pixbuf_y);
+/**
+ * Detach and free shared memory segment. Next read allocates it again.
+ * @param[in] shm Capture state.
+ */
+void screen_source_shm_release(ScreenSourceShm *shm);
+#endif
+
+#endif /* GPICK_SCREEN_SOURCE_SHM_H_ */
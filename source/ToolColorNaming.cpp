@@ -23,6 +23,7 @@
 #include "color_names/ColorNames.h"
 #include "ColorObject.h"
 #include <string>
+#include <vector>
 using namespace std;
 
 const ToolColorNamingOption options[] = {
@@ -78,3 +79,17 @@ void ToolColorNameAssigner::assign(ColorObject *color_object, const Color *color
 			break;
 	}
 }
+void ToolColorNameAssigner::assign(ColorObject **color_objects, const Color *colors, size_t count)
+{
+	if (m_color_naming_type != TOOL_COLOR_NAMING_AUTOMATIC_NAME){
+		for (size_t i = 0; i < count; i++){
+			assign(color_objects[i], &colors[i]);
+		}
+		return;
+	}
+	vector<string> names(count);
+	color_names_get_batch(m_gs->getColorNames(), colors, count, m_imprecision_postfix, names.data());
+	for (size_t i = 0; i < count; i++){
+		color_objects[i]->setName(names[i]);
+	}
+}
@@ -20,6 +20,7 @@
 #define GPICK_TOOL_COLOR_NAMING_H_
 
 #include <string>
+#include <cstddef>
 class GlobalState;
 struct Color;
 class ColorObject;
@@ -47,6 +48,13 @@ class ToolColorNameAssigner{
 		ToolColorNameAssigner(GlobalState *gs);
 		virtual ~ToolColorNameAssigner();
 		void assign(ColorObject *color_object, const Color *color);
+		/**
+		 * Assign names to multiple color objects. Automatic names are found using multiple threads, tool specific names are requested in color object order.
+		 * @param[in] color_objects Color objects.
+		 * @param[in] colors Colors of color objects.
+		 * @param[in] count Number of color objects.
+		 */
+		void assign(ColorObject **color_objects, const Color *colors, size_t count);
 		virtual std::string getToolSpecificName(ColorObject *color_object, const Color *color) = 0;
 };
 
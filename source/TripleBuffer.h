@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_TRIPLE_BUFFER_H_
+#define GPICK_TRIPLE_BUFFER_H_
+
+#include <atomic>
+#include <stdint.h>
+
+/** \file source/TripleBuffer.h
+ * \brief Lock-free single producer, single consumer triple buffer.
+ */
+
+/** \class TripleBuffer
+ * \brief Passes the latest value from one producer thread to one consumer thread without locking.
+ *
+ * Producer writes into back slot and publishes it, consumer reads the latest published slot. Neither side ever waits for
+ * the other: unread values are replaced by newer ones, and the consumer keeps its slot until it asks for a newer value.
+ */
+template<typename T> class TripleBuffer
+{
+	public:
+		TripleBuffer():
+			m_state(1),
+			m_back(0),
+			m_front(2)
+		{
+		}
+		/**
+		 * Get slot by index. Only intended for initialization, before producer and consumer start.
+		 * @param[in] index Slot index in [0, 2] range.
+		 * @return Slot.
+		 */
+		T &slot(int index)
+		{
+			return m_slots[index];
+		}
+		/**
+		 * Get slot owned by producer.
+		 * @return Back slot.
+		 */
+		T &back()
+		{
+			return m_slots[m_back];
+		}
+		/**
+		 * Publish back slot and take over another one. Must only be called by producer.
+		 * @return True if previously published value was replaced without being read by consumer.
+		 */
+		bool publish()
+		{
+			uint8_t previous = m_state.exchange(uint8_t(m_back | fresh), std::memory_order_acq_rel);
+			m_back = previous & index_mask;
+			return (previous & fresh) != 0;
+		}
+		/**
+		 * Take the latest published slot. Must only be called by consumer.
+		 * @return True if a new value was published since the last call. Otherwise front slot stays the same.
+		 */
+		bool update()
+		{
+			if (!(m_state.load(std::memory_order_relaxed) & fresh)) return false;
+			uint8_t previous = m_state.exchange(uint8_t(m_front), std::memory_order_acq_rel);
+			m_front = previous & index_mask;
+			return true;
+		}
+		/**
+		 * Get slot owned by consumer.
+		 * @return Front slot.
+		 */
+		T &front()
+		{
+			return m_slots[m_front];
+		}
+	private:
+		static const uint8_t index_mask = 3;
+		static const uint8_t fresh = 4;
+		std::atomic<uint8_t> m_state; /**< Index of the middle slot and a flag, which is set when it holds an unread value */
+		int m_back;
+		int m_front;
+		T m_slots[3];
+};
+
+#endif /* GPICK_TRIPLE_BUFFER_H_ */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ZoomRenderer.h"
+#include "simd/Kernels.h"
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+using namespace math;
+using namespace std;
+
+struct ZoomRenderer{
+	int32_t width_height;
+	cairo_surface_t *surface;
+	int width; /**< Source area width of the previous render */
+	int height; /**< Source area height of the previous render */
+	vector<uint16_t> runs_x; /**< Zoomed view columns of each source column */
+	vector<int32_t> rows; /**< First zoomed view row of each source row, followed by zoomed view size */
+	vector<uint8_t> previous; /**< Source pixels of the previous render */
+	vector<uint32_t> row; /**< Expanded row with space for kernel padding */
+	bool valid; /**< Previous render pixels can be compared with new pixels */
+};
+
+static inline const ZoomKernels* kernels()
+{
+	return kernels_zoom();
+}
+
+struct ZoomRenderer* zoom_renderer_new(int32_t width_height)
+{
+	ZoomRenderer *renderer = new ZoomRenderer;
+	renderer->width_height = 0;
+	renderer->surface = nullptr;
+	zoom_renderer_set_size(renderer, width_height);
+	return renderer;
+}
+
+void zoom_renderer_set_size(struct ZoomRenderer *renderer, int32_t width_height)
+{
+	if (renderer->surface && renderer->width_height == width_height) return;
+	if (renderer->surface)
+		cairo_surface_destroy(renderer->surface);
+	renderer->width_height = width_height;
+	renderer->surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width_height, width_height);
+	cairo_t *cr = cairo_create(renderer->surface);
+	cairo_set_source_rgb(cr, 0x80 / 255.0, 0x80 / 255.0, 0x80 / 255.0);
+	cairo_paint(cr);
+	cairo_destroy(cr);
+	renderer->width = renderer->height = 0;
+	renderer->row.resize(width_height + ZOOM_KERNEL_ROW_PADDING);
+	renderer->valid = false;
+}
+
+/**
+ * Map source columns and rows into zoomed view. Source pixel i covers zoomed view pixels from (i * size) / width to ((i + 1) * size) / width, the same way pointer position is mapped by the zoomed view.
+ */
+static void zoom_renderer_update_mapping(ZoomRenderer *renderer, int width, int height)
+{
+	int32_t size = renderer->width_height;
+	renderer->width = width;
+	renderer->height = height;
+	renderer->runs_x.resize(width);
+	for (int x = 0; x < width; x++)
+		renderer->runs_x[x] = uint16_t(((x + 1) * size) / width - (x * size) / width);
+	renderer->rows.resize(height + 1);
+	for (int y = 0; y <= height; y++)
+		renderer->rows[y] = (y * size) / height;
+	renderer->previous.resize(width * height * 3);
+	renderer->valid = false;
+}
+
+bool zoom_renderer_render(struct ZoomRenderer *renderer, math::Rect2<int>& area, math::Vec2<int>& offset, GdkPixbuf *pixbuf, math::Rect2<int> *changed_rect)
+{
+	*changed_rect = Rect2<int>();
+	int width = area.getWidth(), height = area.getHeight();
+	if (width <= 0 || height <= 0) return false;
+	if (width != renderer->width || height != renderer->height)
+		zoom_renderer_update_mapping(renderer, width, height);
+	int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+	const uint8_t *pixels = gdk_pixbuf_get_pixels(pixbuf) + offset.y * rowstride + offset.x * 3;
+	cairo_surface_flush(renderer->surface);
+	uint8_t *surface_pixels = cairo_image_surface_get_data(renderer->surface);
+	int surface_stride = cairo_image_surface_get_stride(renderer->surface);
+	size_t row_size = width * 3;
+	int changed_top = height, changed_bottom = 0, changed_left = width, changed_right = 0;
+	for (int y = 0; y < height; y++){
+		const uint8_t *source = pixels + y * rowstride;
+		uint8_t *previous = &renderer->previous[y * row_size];
+		int left = 0, right = width;
+		if (renderer->valid){
+			if (memcmp(source, previous, row_size) == 0) continue;
+			while (memcmp(source + left * 3, previous + left * 3, 3) == 0) left++;
+			while (memcmp(source + (right - 1) * 3, previous + (right - 1) * 3, 3) == 0) right--;
+		}
+		memcpy(previous, source, row_size);
+		kernels()->expand_row(source, &renderer->runs_x.front(), width, &renderer->row.front());
+		for (int32_t zoomed_y = renderer->rows[y]; zoomed_y < renderer->rows[y + 1]; zoomed_y++)
+			memcpy(surface_pixels + zoomed_y * surface_stride, &renderer->row.front(), renderer->width_height * sizeof(uint32_t));
+		changed_top = std::min(changed_top, y);
+		changed_bottom = y + 1;
+		changed_left = std::min(changed_left, left);
+		changed_right = std::max(changed_right, right);
+	}
+	renderer->valid = true;
+	if (changed_top >= changed_bottom) return false;
+	int32_t size = renderer->width_height;
+	*changed_rect = Rect2<int>((changed_left * size) / width, renderer->rows[changed_top], (changed_right * size) / width, renderer->rows[changed_bottom]);
+	cairo_surface_mark_dirty_rectangle(renderer->surface, changed_rect->getX(), changed_rect->getY(), changed_rect->getWidth(), changed_rect->getHeight());
+	return true;
+}
+
+cairo_surface_t* zoom_renderer_get_surface(struct ZoomRenderer *renderer)
+{
+	return renderer->surface;
+}
+
+void zoom_renderer_destroy(struct ZoomRenderer *renderer)
+{
+	cairo_surface_destroy(renderer->surface);
+	delete renderer;
+}
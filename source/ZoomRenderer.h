@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_ZOOM_RENDERER_H_
+#define GPICK_ZOOM_RENDERER_H_
+
+#include "Rect2.h"
+#include "Vector2.h"
+#include <gdk/gdk.h>
+#include <stdint.h>
+
+/** \file source/ZoomRenderer.h
+ * \brief Nearest-neighbour magnification of a screen area into a persistent cairo image surface.
+ *
+ * Each screen pixel is repeated into a block of zoomed view pixels. Source rows, which did not change since the previous
+ * render, are not drawn again, so only the changed part of the zoomed view has to be redrawn. Does not need a display.
+ */
+
+struct ZoomRenderer;
+
+/**
+ * Create zoom renderer.
+ * @param[in] width_height Zoomed view size.
+ * @return New zoom renderer.
+ */
+struct ZoomRenderer* zoom_renderer_new(int32_t width_height);
+
+/**
+ * Change zoomed view size. Surface is recreated and filled with gray color.
+ * @param[in] renderer Zoom renderer.
+ * @param[in] width_height Zoomed view size.
+ */
+void zoom_renderer_set_size(struct ZoomRenderer *renderer, int32_t width_height);
+
+/**
+ * Magnify screen area into surface.
+ * @param[in] renderer Zoom renderer.
+ * @param[in] area Screen area, calculated by gtk_zoomed_calculate_screen_rect.
+ * @param[in] offset Position of the area in screen pixbuf.
+ * @param[in] pixbuf Screen pixbuf.
+ * @param[out] changed_rect Changed surface area. Empty when nothing changed.
+ * @return True if any surface pixel changed.
+ */
+bool zoom_renderer_render(struct ZoomRenderer *renderer, math::Rect2<int>& area, math::Vec2<int>& offset, GdkPixbuf *pixbuf, math::Rect2<int> *changed_rect);
+
+/**
+ * Get surface with magnified screen area.
+ * @param[in] renderer Zoom renderer.
+ * @return Cairo image surface in RGB24 format. Owned by renderer.
+ */
+cairo_surface_t* zoom_renderer_get_surface(struct ZoomRenderer *renderer);
+
+/**
+ * Destroy zoom renderer.
+ * @param[in] renderer Zoom renderer.
+ */
+void zoom_renderer_destroy(struct ZoomRenderer *renderer);
+
+#endif /* GPICK_ZOOM_RENDERER_H_ */
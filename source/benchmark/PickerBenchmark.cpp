@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../ScreenReader.h"
+#include "../ScreenSource.h"
+#include "../Sampler.h"
+#include "../Color.h"
+#include "../gtk/Zoomed.h"
+#include "../PickerScheduler.h"
+#include "../ZoomRenderer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+using namespace math;
+using namespace std;
+
+/** \file source/benchmark/PickerBenchmark.cpp
+ * \brief Measures per frame latency of the picker pipeline: screen reader, sampler and zoomed view rendering. Runs without a display. Frames, which did not change since the previous one, are skipped by PickerScheduler just like in pickers.
+ */
+
+typedef struct PointerPath{
+	const char *name;
+	Vec2<int> (*position)(int frame, int width, int height);
+}PointerPath;
+static Vec2<int> path_sweep(int frame, int width, int height)
+{
+	// scan lines from left to right, moving 8 pixels per frame
+	int x = (frame * 8) % width;
+	int y = ((frame * 8) / width * 37) % height;
+	return Vec2<int>(x, y);
+}
+static Vec2<int> path_circle(int frame, int width, int height)
+{
+	double angle = frame * 0.02;
+	double radius = min(width, height) * 0.4;
+	return Vec2<int>(int(width / 2 + cos(angle) * radius), int(height / 2 + sin(angle) * radius));
+}
+static Vec2<int> path_hover(int frame, int width, int height)
+{
+	// small pseudo random movements around a few points, like a user looking for a color
+	uint32_t seed = frame * 2654435761u;
+	int target = (frame / 120) % 4;
+	int x = width / 5 * (target + 1) + int(seed >> 28) - 8;
+	int y = height / 2 + int((seed >> 24) & 0xf) - 8;
+	return Vec2<int>(x, y);
+}
+static const PointerPath paths[] = {
+	{"sweep", path_sweep},
+	{"circle", path_circle},
+	{"hover", path_hover},
+};
+static GdkPixbuf* create_synthetic_image(int width, int height)
+{
+	GdkPixbuf *image = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, width, height);
+	int rowstride = gdk_pixbuf_get_rowstride(image);
+	guchar *pixels = gdk_pixbuf_get_pixels(image);
+	for (int y = 0; y < height; y++){
+		for (int x = 0; x < width; x++){
+			guchar *p = pixels + y * rowstride + x * 3;
+			p[0] = x * 255 / width;
+			p[1] = y * 255 / height;
+			p[2] = ((x / 16 + y / 16) & 1) ? 200 : 50;
+		}
+	}
+	return image;
+}
+static double percentile(const vector<double> &sorted_values, double fraction)
+{
+	size_t index = min(sorted_values.size() - 1, size_t(fraction * sorted_values.size()));
+	return sorted_values[index];
+}
+int main(int argc, char **argv)
+{
+#if !GLIB_CHECK_VERSION(2, 36, 0)
+	g_type_init();
+#endif
+	const char *image_file = nullptr;
+	int frames = 2000, oversample = 0, falloff = NONE, zoomed_size = 150, monitors = 1;
+	float zoom = 20;
+	for (int i = 1; i < argc; i++){
+		if (strcmp(argv[i], "--image") == 0 && i + 1 < argc) image_file = argv[++i];
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--oversample") == 0 && i + 1 < argc) oversample = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--falloff") == 0 && i + 1 < argc) falloff = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--zoom") == 0 && i + 1 < argc) zoom = atof(argv[++i]);
+		else if (strcmp(argv[i], "--zoomed-size") == 0 && i + 1 < argc) zoomed_size = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--monitors") == 0 && i + 1 < argc) monitors = max(1, atoi(argv[++i]));
+		else{
+			cerr << "Usage: " << argv[0] << " [--image file] [--frames n] [--oversample n] [--falloff 0-4] [--zoom 0-100] [--zoomed-size n] [--monitors n]" << endl;
+			return 1;
+		}
+	}
+	color_init();
+	GdkPixbuf *image = image_file ? gdk_pixbuf_new_from_file(image_file, nullptr) : create_synthetic_image(1920, 1080);
+	if (!image){
+		cerr << "Could not load image \"" << image_file << "\"" << endl;
+		return 1;
+	}
+	int width = gdk_pixbuf_get_width(image), height = gdk_pixbuf_get_height(image);
+	ScreenReader *screen_reader = screen_reader_new_with_source(screen_source_image_new(image));
+	g_object_unref(image);
+	Sampler *sampler = sampler_new(screen_reader);
+	sampler_set_oversample(sampler, oversample);
+	sampler_set_falloff(sampler, SamplerFalloff(falloff));
+	ZoomRenderer *zoomed = zoom_renderer_new(zoomed_size);
+	int monitor_width = width / monitors;
+	cout << "image " << width << "x" << height << ", " << monitors << " monitors, oversample " << oversample << ", falloff " << falloff << ", zoom " << zoom << ", " << frames << " frames per path" << endl;
+	cout << "latency in microseconds" << endl;
+	cout << setw(8) << "path" << setw(10) << "p50" << setw(10) << "p90" << setw(10) << "p99" << setw(10) << "max" << setw(11) << "processed" << setw(9) << "skipped" << endl;
+	float checksum = 0;
+	for (const PointerPath &path: paths){
+		vector<double> latencies;
+		latencies.reserve(frames);
+		PickerScheduler *scheduler = picker_scheduler_new(nullptr, nullptr);
+		for (int frame = 0; frame < frames; frame++){
+			Vec2<int> pointer = path.position(frame, width, height);
+			auto start = chrono::steady_clock::now();
+			int monitor = min(monitors - 1, pointer.x / monitor_width);
+			Rect2<int> screen_rect(monitor * monitor_width, 0, monitor == monitors - 1 ? width : (monitor + 1) * monitor_width, height);
+			Rect2<int> sampler_rect, zoomed_rect, final_rect;
+			screen_reader_reset_rect(screen_reader);
+			screen_reader_set_screen_rect(screen_reader, screen_rect);
+			sampler_get_screen_rect(sampler, pointer, screen_rect, &sampler_rect);
+			screen_reader_add_rect(screen_reader, nullptr, sampler_rect);
+			gtk_zoomed_calculate_screen_rect(zoomed_size, zoom, pointer, screen_rect, &zoomed_rect);
+			screen_reader_add_rect(screen_reader, nullptr, zoomed_rect);
+			screen_reader_update_pixbuf(screen_reader, &final_rect);
+			Color color;
+			color_zero(&color);
+			if (picker_scheduler_update(scheduler, pointer, screen_reader_get_hash(screen_reader))){
+				Vec2<int> offset(sampler_rect.getX() - final_rect.getX(), sampler_rect.getY() - final_rect.getY());
+				sampler_get_color_sample(sampler, pointer, screen_rect, offset, &color);
+				offset = Vec2<int>(zoomed_rect.getX() - final_rect.getX(), zoomed_rect.getY() - final_rect.getY());
+				Rect2<int> changed_rect;
+				zoom_renderer_render(zoomed, zoomed_rect, offset, screen_reader_get_pixbuf(screen_reader), &changed_rect);
+			}
+			auto end = chrono::steady_clock::now();
+			latencies.push_back(chrono::duration<double, micro>(end - start).count());
+			checksum += color.rgb.red + cairo_image_surface_get_data(zoom_renderer_get_surface(zoomed))[0];
+		}
+		PickerSchedulerStatistics statistics;
+		picker_scheduler_get_statistics(scheduler, &statistics);
+		picker_scheduler_destroy(scheduler);
+		sort(latencies.begin(), latencies.end());
+		cout << fixed << setprecision(2) << setw(8) << path.name << setw(10) << percentile(latencies, 0.5) << setw(10) << percentile(latencies, 0.9) << setw(10) << percentile(latencies, 0.99) << setw(10) << latencies.back() << setw(11) << statistics.processed << setw(9) << statistics.skipped << endl;
+	}
+	ScreenReaderStatistics reader_statistics;
+	screen_reader_get_statistics(screen_reader, &reader_statistics);
+	cout << "capture buffers " << reader_statistics.buffers << ", " << reader_statistics.memory / 1024 << " KiB, " << reader_statistics.allocations << " allocations" << endl;
+	cout << "checksum " << checksum << endl;
+	zoom_renderer_destroy(zoomed);
+	sampler_destroy(sampler);
+	screen_reader_destroy(screen_reader);
+	return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../Quantizer.h"
+#include "../ColorHistogram.h"
+#include "../ImageHistogram.h"
+#include "../Color.h"
+#include <glib-object.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+using namespace std;
+
+/** \file source/benchmark/QuantizerBenchmark.cpp
+ * \brief Compares speed and palette error of quantizer engines on a corpus of images. Synthetic images are used when no image files are given.
+ *
+ * Error is CIE76 color difference (Euclidean distance in Lab color space) between the mean color of each histogram bin and the nearest
+ * palette color, weighted by the number of pixels in the bin.
+ */
+
+typedef struct SyntheticImage{
+	const char *name;
+	void (*pixel)(int x, int y, int width, int height, uint8_t *pixel);
+}SyntheticImage;
+static void image_gradient(int x, int y, int width, int height, uint8_t *pixel)
+{
+	pixel[0] = x * 255 / width;
+	pixel[1] = y * 255 / height;
+	pixel[2] = ((x / 16 + y / 16) & 1) ? 200 : 50;
+}
+static void image_clusters(int x, int y, int width, int height, uint8_t *pixel)
+{
+	// a few flat color areas with noise, like a photo of simple objects
+	static const uint8_t colors[6][3] = {{200, 40, 30}, {30, 120, 200}, {240, 220, 180}, {40, 140, 60}, {20, 20, 25}, {250, 180, 0}};
+	uint32_t seed = (y * width + x) * 2654435761u;
+	const uint8_t *color = colors[((x * 3 / width) + (y * 2 / height) * 3) % 6];
+	for (int i = 0; i < 3; i++)
+		pixel[i] = max(0, min(255, int(color[i]) + int((seed >> (i * 8)) & 0x1f) - 16));
+}
+static void image_sky(int x, int y, int width, int height, uint8_t *pixel)
+{
+	// smooth hue and lightness changes, where banding is easy to see
+	double t = double(y) / height, s = double(x) / width;
+	pixel[0] = uint8_t(255 * (0.2 + 0.7 * t * t));
+	pixel[1] = uint8_t(255 * (0.4 + 0.4 * t * (1 - s)));
+	pixel[2] = uint8_t(255 * (0.9 - 0.5 * t * s));
+}
+static const SyntheticImage synthetic_images[] = {
+	{"gradient", image_gradient},
+	{"clusters", image_clusters},
+	{"sky", image_sky},
+};
+static ColorHistogram* create_synthetic_histogram(const SyntheticImage &image, int width, int height)
+{
+	vector<uint8_t> pixels(size_t(width) * height * 3);
+	for (int y = 0; y < height; y++){
+		for (int x = 0; x < width; x++){
+			image.pixel(x, y, width, height, &pixels[(size_t(y) * width + x) * 3]);
+		}
+	}
+	ColorHistogram *histogram = color_histogram_new();
+	color_histogram_add_image(histogram, &pixels.front(), width, height, width * 3, 3);
+	return histogram;
+}
+/**
+ * Calculate mean and maximum color difference between histogram bins and their nearest palette colors.
+ */
+static void palette_error(const ColorHistogram *histogram, const vector<Color> &palette, double *mean, double *maximum)
+{
+	*mean = *maximum = 0;
+	if (palette.empty()) return;
+	vector<Color> palette_lab(palette.size());
+	for (size_t i = 0; i < palette.size(); i++)
+		color_rgb_to_lab_d50(&palette[i], &palette_lab[i]);
+	const ColorHistogramBin *bins = color_histogram_get_bins(histogram);
+	double error = 0, pixels = 0;
+	for (int i = 0; i < COLOR_HISTOGRAM_SIZE; i++){
+		if (!bins[i].count) continue;
+		Color color, lab;
+		color.rgb.red = bins[i].sum[0] / (255.0 * bins[i].count);
+		color.rgb.green = bins[i].sum[1] / (255.0 * bins[i].count);
+		color.rgb.blue = bins[i].sum[2] / (255.0 * bins[i].count);
+		color_rgb_to_lab_d50(&color, &lab);
+		double nearest = -1;
+		for (auto &entry: palette_lab){
+			double distance = sqrt(pow(lab.lab.L - entry.lab.L, 2) + pow(lab.lab.a - entry.lab.a, 2) + pow(lab.lab.b - entry.lab.b, 2));
+			if (nearest < 0 || distance < nearest) nearest = distance;
+		}
+		error += nearest * bins[i].count;
+		pixels += bins[i].count;
+		*maximum = max(*maximum, nearest);
+	}
+	*mean = error / pixels;
+}
+int main(int argc, char **argv)
+{
+#if !GLIB_CHECK_VERSION(2, 36, 0)
+	g_type_init();
+#endif
+	int colors = 16, repeat = 5;
+	vector<const char*> files;
+	for (int i = 1; i < argc; i++){
+		if (strcmp(argv[i], "--colors") == 0 && i + 1 < argc) colors = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+		else if (argv[i][0] == '-'){
+			cerr << "Usage: " << argv[0] << " [--colors n] [--repeat n] [image files]" << endl;
+			return 1;
+		}else files.push_back(argv[i]);
+	}
+	color_init();
+	vector<pair<string, ColorHistogram*>> corpus;
+	if (files.empty()){
+		for (auto &image: synthetic_images)
+			corpus.push_back(make_pair(string(image.name), create_synthetic_histogram(image, 1024, 768)));
+	}
+	for (auto file: files){
+		ColorHistogram *histogram = color_histogram_new();
+		GError *error = nullptr;
+		auto start = chrono::steady_clock::now();
+		if (!image_histogram_load(file, histogram, &error)){
+			cerr << "Could not load image \"" << file << "\"" << (error ? string(": ") + error->message : string()) << endl;
+			if (error) g_error_free(error);
+			color_histogram_destroy(histogram);
+			continue;
+		}
+		auto end = chrono::steady_clock::now();
+		cout << file << ": " << color_histogram_get_pixel_count(histogram) << " pixels counted in " << fixed << setprecision(1) << chrono::duration<double, milli>(end - start).count() << " ms" << endl;
+		corpus.push_back(make_pair(string(file), histogram));
+	}
+	cout << colors << " colors, times in microseconds, best of " << repeat << " runs" << endl;
+	cout << setw(16) << "image" << setw(12) << "engine" << setw(8) << "colors" << setw(12) << "histogram" << setw(12) << "palette" << setw(10) << "mean dE" << setw(10) << "max dE" << endl;
+	double total_time[QUANTIZER_COUNT] = {0}, total_error[QUANTIZER_COUNT] = {0};
+	for (auto &image: corpus){
+		for (int type = 0; type < QUANTIZER_COUNT; type++){
+			Quantizer *quantizer = quantizer_new(QuantizerType(type));
+			vector<Color> palette;
+			double set_time = 0, get_time = 0;
+			for (int run = 0; run < repeat; run++){
+				auto start = chrono::steady_clock::now();
+				quantizer_set_histogram(quantizer, image.second);
+				auto middle = chrono::steady_clock::now();
+				quantizer_get_colors(quantizer, colors, palette);
+				auto end = chrono::steady_clock::now();
+				double set_run = chrono::duration<double, micro>(middle - start).count(), get_run = chrono::duration<double, micro>(end - middle).count();
+				if (run == 0 || set_run + get_run < set_time + get_time){
+					set_time = set_run;
+					get_time = get_run;
+				}
+			}
+			double mean, maximum;
+			palette_error(image.second, palette, &mean, &maximum);
+			total_time[type] += set_time + get_time;
+			total_error[type] += mean;
+			string name = image.first.size() > 15 ? image.first.substr(image.first.size() - 15) : image.first;
+			cout << setw(16) << name << setw(12) << quantizer_get_name(QuantizerType(type)) << setw(8) << palette.size() << fixed << setprecision(0) << setw(12) << set_time << setw(12) << get_time << setprecision(2) << setw(10) << mean << setw(10) << maximum << endl;
+			quantizer_destroy(quantizer);
+		}
+	}
+	if (!corpus.empty()){
+		cout << "average over " << corpus.size() << " images" << endl;
+		for (int type = 0; type < QUANTIZER_COUNT; type++){
+			cout << setw(16) << "" << setw(12) << quantizer_get_name(QuantizerType(type)) << setw(8) << "" << fixed << setprecision(0) << setw(24) << total_time[type] / corpus.size() << setprecision(2) << setw(10) << total_error[type] / corpus.size() << endl;
+		}
+	}
+	for (auto &image: corpus)
+		color_histogram_destroy(image.second);
+	return 0;
+}
@@ -18,14 +18,43 @@
 
 #include "ColorNames.h"
 #include "../Color.h"
+#include "../MathUtil.h"
+#include <math.h>
+#include <algorithm>
+#include <stdlib.h>
 #include <string.h>
 #include <sstream>
 #include <fstream>
+#include <thread>
 using namespace std;
 
+static void color_names_reset_name_search(ColorNames* cnames)
+{
+	lock_guard<mutex> lock(cnames->name_search_mutex);
+	if (cnames->name_search != nullptr){
+		name_search_destroy(cnames->name_search);
+		cnames->name_search = nullptr;
+	}
+}
+static void color_names_clear_cache(ColorNames* cnames)
+{
+	lock_guard<mutex> lock(cnames->cache.mutex);
+	for (size_t i = 0; i < COLOR_NAMES_CACHE_SIZE; i++){
+		cnames->cache.slots[i].key = 0;
+	}
+}
 ColorNames* color_names_new()
 {
 	ColorNames* cnames = new ColorNames;
+	cnames->colors = nullptr;
+	cnames->color_count = 0;
+	cnames->strings = nullptr;
+	cnames->strings_size = 0;
+	cnames->index.cell_start = nullptr;
+	cnames->cache.lookups = 0;
+	cnames->cache.hits = 0;
+	color_names_clear_cache(cnames);
+	cnames->name_search = nullptr;
 	cnames->color_space_convert = color_rgb_to_lab_d50;
 	cnames->color_space_distance = color_distance_lch;
 	return cnames;
@@ -42,27 +71,130 @@ static void color_names_strip_spaces(string& string_x, string& stripchars)
 	}
 	string_x = string_x.substr(startIndex, (endIndex-startIndex)+1 );
 }
-void color_names_get_color_xyz(ColorNames* cnames, Color* c, int* x1, int* y1, int* z1, int* x2, int* y2, int* z2)
+// Approximate cell size in Lab units. Most entries have their nearest neighbours within one or two cells
+#define INDEX_CELL_SIZE 12.0f
+#define INDEX_MAX_CELLS 64
+// Lookup cache slot key flag, which marks slot as used
+#define CACHE_VALID (1u << 24)
+// Smallest number of colors named by each color_names_get_batch thread
+#define BATCH_MIN_COLORS_PER_THREAD 64
+
+static int color_names_index_cell(const ColorNamesIndex* index, int axis, float value)
+{
+	return clamp_int(int((value - index->origin[axis]) / index->cell_size[axis]), 0, index->size[axis] - 1);
+}
+static int color_names_index_cell_id(const ColorNamesIndex* index, int l, int a, int b)
+{
+	return (l * index->size[1] + a) * index->size[2] + b;
+}
+static void color_names_build_index(ColorNames* cnames)
+{
+	ColorNamesIndex* index = &cnames->index;
+	float min_value[3] = {0, 0, 0}, max_value[3] = {0, 0, 0};
+	index->max_chroma = 0;
+	for (size_t i = 0; i < cnames->color_storage.size(); i++){
+		const Color &color = cnames->color_storage[i].color;
+		for (int axis = 0; axis < 3; axis++){
+			if (i == 0 || color.ma[axis] < min_value[axis]) min_value[axis] = color.ma[axis];
+			if (i == 0 || color.ma[axis] > max_value[axis]) max_value[axis] = color.ma[axis];
+		}
+		index->max_chroma = std::max(index->max_chroma, float(sqrt(color.lab.a * color.lab.a + color.lab.b * color.lab.b)));
+	}
+	for (int axis = 0; axis < 3; axis++){
+		float range = max_value[axis] - min_value[axis];
+		index->size[axis] = clamp_int(int(ceil(range / INDEX_CELL_SIZE)), 1, INDEX_MAX_CELLS);
+		index->origin[axis] = min_value[axis];
+		index->cell_size[axis] = std::max(range / index->size[axis], 1e-3f);
+	}
+	size_t cell_count = index->size[0] * index->size[1] * index->size[2];
+	vector<uint32_t> cell_ids(cnames->color_storage.size());
+	vector<uint32_t> &cell_start = cnames->cell_start_storage;
+	cell_start.assign(cell_count + 1, 0);
+	for (size_t i = 0; i < cnames->color_storage.size(); i++){
+		const Color &color = cnames->color_storage[i].color;
+		cell_ids[i] = color_names_index_cell_id(index, color_names_index_cell(index, 0, color.lab.L), color_names_index_cell(index, 1, color.lab.a), color_names_index_cell(index, 2, color.lab.b));
+		cell_start[cell_ids[i] + 1]++;
+	}
+	for (size_t i = 0; i < cell_count; i++){
+		cell_start[i + 1] += cell_start[i];
+	}
+	// counting sort keeps load order of entries within each cell
+	vector<ColorEntry> sorted(cnames->color_storage.size());
+	vector<uint32_t> position(cell_start.begin(), cell_start.end() - 1);
+	for (size_t i = 0; i < cnames->color_storage.size(); i++){
+		sorted[position[cell_ids[i]]++] = cnames->color_storage[i];
+	}
+	cnames->color_storage.swap(sorted);
+	cnames->colors = cnames->color_storage.data();
+	cnames->color_count = cnames->color_storage.size();
+	cnames->strings = cnames->string_storage.data();
+	cnames->strings_size = cnames->string_storage.size();
+	index->cell_start = cell_start.data();
+	color_names_clear_cache(cnames);
+	color_names_reset_name_search(cnames);
+}
+static double color_names_axis_distance(double value, double start, double end)
+{
+	if (value < start) return start - value;
+	if (value > end) return value - end;
+	return 0;
+}
+/**
+ * Lower bound of color_distance_lch between query color and any color in a cell.
+ * Uses the facts that chroma difference can not exceed a, b plane distance and that chroma and hue terms are monotonic in cell chroma.
+ */
+static double color_names_cell_lower_bound(const ColorNamesIndex* index, int l, int a, int b, const Color* query, double query_chroma)
+{
+	double l_start = index->origin[0] + l * index->cell_size[0], l_end = l_start + index->cell_size[0];
+	double a_start = index->origin[1] + a * index->cell_size[1], a_end = a_start + index->cell_size[1];
+	double b_start = index->origin[2] + b * index->cell_size[2], b_end = b_start + index->cell_size[2];
+	double dl = color_names_axis_distance(query->lab.L, l_start, l_end);
+	double da = color_names_axis_distance(query->lab.a, a_start, a_end);
+	double db = color_names_axis_distance(query->lab.b, b_start, b_end);
+	double ab_distance = sqrt(da * da + db * db);
+	double da0 = color_names_axis_distance(0, a_start, a_end);
+	double db0 = color_names_axis_distance(0, b_start, b_end);
+	double chroma_min = sqrt(da0 * da0 + db0 * db0);
+	double chroma_max = sqrt(std::max(a_start * a_start, a_end * a_end) + std::max(b_start * b_start, b_end * b_end));
+	double chroma = 0;
+	if (query_chroma < chroma_min)
+		chroma = (chroma_min - query_chroma) / (1 + 0.045 * chroma_min);
+	else if (query_chroma > chroma_max)
+		chroma = (query_chroma - chroma_max) / (1 + 0.045 * chroma_max);
+	double hue = 0;
+	if (ab_distance >= 1)
+		hue = (ab_distance * ab_distance - ab_distance) / (1 + 0.015 * chroma_max);
+	return sqrt(dl * dl + chroma * chroma + hue * hue);
+}
+/**
+ * Lower bound of color_distance_lch between query color and any color in cells at Chebyshev distance ring from the query cell.
+ */
+static double color_names_ring_lower_bound(const ColorNamesIndex* index, int ring)
 {
-	*x1 = clamp_int(int(c->xyz.x * 8 - 0.5), 0, 7);
-	*y1 = clamp_int(int(c->xyz.y * 8 - 0.5), 0, 7);
-	*z1 = clamp_int(int(c->xyz.z * 8 - 0.5), 0, 7);
-	*x2 = clamp_int(int(c->xyz.x * 8 + 0.5), 0, 7);
-	*y2 = clamp_int(int(c->xyz.y * 8 + 0.5), 0, 7);
-	*z2 = clamp_int(int(c->xyz.z * 8 + 0.5), 0, 7);
+	if (ring <= 1) return 0;
+	double l = (ring - 1) * index->cell_size[0];
+	double ab = (ring - 1) * std::min(index->cell_size[1], index->cell_size[2]);
+	double hue = 0;
+	if (ab >= 1)
+		hue = (ab * ab - ab) / (1 + 0.015 * index->max_chroma);
+	return std::min(l, hue);
 }
-list<ColorEntry*>* color_names_get_color_list(ColorNames* cnames, Color* c)
+/**
+ * Copy entries and names from a memory mapped database into owned storage, so that more names can be added.
+ */
+static void color_names_take_ownership(ColorNames* cnames)
 {
-	int x,y,z;
-	x = clamp_int(int(c->xyz.x * 8), 0, 7);
-	y = clamp_int(int(c->xyz.y * 8), 0, 7);
-	z = clamp_int(int(c->xyz.z * 8), 0, 7);
-	return &cnames->colors[x][y][z];
+	if (cnames->color_count == 0 || cnames->colors == cnames->color_storage.data()) return;
+	cnames->color_storage.assign(cnames->colors, cnames->colors + cnames->color_count);
+	cnames->string_storage.assign(cnames->strings, cnames->strings + cnames->strings_size);
+	cnames->colors = cnames->color_storage.data();
+	cnames->strings = cnames->string_storage.data();
 }
 int color_names_load_from_file(ColorNames* cnames, const char* filename)
 {
 	ifstream file(filename, ifstream::in);
 	if (file.is_open()) {
+		color_names_take_ownership(cnames);
 		string line;
 		stringstream rline (ios::in | ios::out);
 		Color color;
@@ -84,76 +216,309 @@ int color_names_load_from_file(ColorNames* cnames, const char* filename)
 				*i = tolower((unsigned char)*i);
 			}
 			color_multiply(&color, 1/255.0);
-			ColorNameEntry* name_entry = new ColorNameEntry;
-			name_entry->name=name;
-			cnames->names.push_back(name_entry);
-			ColorEntry* color_entry = new ColorEntry;
-			color_entry->name=name_entry;
-			cnames->color_space_convert(&color, &color_entry->color);
-			color_names_get_color_list(cnames, &color_entry->color)->push_back(color_entry);
+			ColorEntry color_entry;
+			color_entry.name = cnames->string_storage.size();
+			cnames->string_storage.insert(cnames->string_storage.end(), name.c_str(), name.c_str() + name.length() + 1);
+			cnames->color_space_convert(&color, &color_entry.color);
+			cnames->color_storage.push_back(color_entry);
 		}
 		file.close();
+		color_names_build_index(cnames);
 		return 0;
 	}
 	return -1;
 }
-void color_names_destroy(ColorNames* cnames)
+#define DATABASE_MAGIC "GPICKCND"
+#define DATABASE_VERSION 1
+
+/** \struct ColorNamesDatabaseHeader
+ * \brief Header of the color names database file. It is followed by color entries, index cell starts and null terminated names.
+ * All values are stored in native byte order, so version also includes a byte order mark.
+ */
+typedef struct ColorNamesDatabaseHeader{
+	char magic[8];
+	uint64_t source_hash;
+	uint32_t version;
+	uint32_t color_count;
+	uint32_t cell_count;
+	uint32_t strings_size;
+	float origin[3];
+	float cell_size[3];
+	int32_t size[3];
+	float max_chroma;
+}ColorNamesDatabaseHeader;
+static uint32_t color_names_database_version()
+{
+	return (DATABASE_VERSION << 8) | sizeof(ColorEntry);
+}
+int color_names_load_from_memory(ColorNames* cnames, const void* data, size_t size, uint64_t source_hash)
 {
-	for (list<ColorNameEntry*>::iterator i=cnames->names.begin();i != cnames->names.end();++i){
-		delete (*i);
+	ColorNamesDatabaseHeader header;
+	if (size < sizeof(header)) return -1;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, DATABASE_MAGIC, sizeof(header.magic)) != 0 || header.version != color_names_database_version() || header.source_hash != source_hash) return -1;
+	uint64_t cell_count = uint64_t(header.size[0]) * header.size[1] * header.size[2];
+	if (header.size[0] < 1 || header.size[1] < 1 || header.size[2] < 1 || cell_count != header.cell_count) return -1;
+	size_t colors_offset = sizeof(header);
+	size_t cells_offset = colors_offset + sizeof(ColorEntry) * header.color_count;
+	size_t strings_offset = cells_offset + sizeof(uint32_t) * (header.cell_count + 1);
+	if (strings_offset + header.strings_size != size || header.strings_size == 0) return -1;
+	const char* bytes = reinterpret_cast<const char*>(data);
+	const ColorEntry* colors = reinterpret_cast<const ColorEntry*>(bytes + colors_offset);
+	const uint32_t* cell_start = reinterpret_cast<const uint32_t*>(bytes + cells_offset);
+	const char* strings = bytes + strings_offset;
+	if (cell_start[0] != 0 || cell_start[header.cell_count] != header.color_count || strings[header.strings_size - 1] != 0) return -1;
+	for (uint32_t i = 0; i < header.cell_count; i++){
+		if (cell_start[i] > cell_start[i + 1]) return -1;
 	}
-	for (int x=0;x<8;x++){
-		for (int y=0;y<8;y++){
-			for (int z=0;z<8;z++){
-				for (list<ColorEntry*>::iterator i=cnames->colors[x][y][z].begin();i != cnames->colors[x][y][z].end();++i){
-					delete (*i);
-				}
+	for (uint32_t i = 0; i < header.color_count; i++){
+		if (colors[i].name >= header.strings_size) return -1;
+	}
+	cnames->color_storage.clear();
+	cnames->string_storage.clear();
+	cnames->cell_start_storage.clear();
+	cnames->colors = colors;
+	cnames->color_count = header.color_count;
+	cnames->strings = strings;
+	cnames->strings_size = header.strings_size;
+	ColorNamesIndex* index = &cnames->index;
+	for (int axis = 0; axis < 3; axis++){
+		index->origin[axis] = header.origin[axis];
+		index->cell_size[axis] = header.cell_size[axis];
+		index->size[axis] = header.size[axis];
+	}
+	index->max_chroma = header.max_chroma;
+	index->cell_start = cell_start;
+	color_names_clear_cache(cnames);
+	color_names_reset_name_search(cnames);
+	return 0;
+}
+int color_names_save_database(const ColorNames* cnames, const char* filename, uint64_t source_hash)
+{
+	if (cnames->color_count == 0) return -1;
+	ColorNamesDatabaseHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DATABASE_MAGIC, sizeof(header.magic));
+	header.source_hash = source_hash;
+	header.version = color_names_database_version();
+	header.color_count = cnames->color_count;
+	const ColorNamesIndex* index = &cnames->index;
+	header.cell_count = index->size[0] * index->size[1] * index->size[2];
+	for (int axis = 0; axis < 3; axis++){
+		header.origin[axis] = index->origin[axis];
+		header.cell_size[axis] = index->cell_size[axis];
+		header.size[axis] = index->size[axis];
+	}
+	header.max_chroma = index->max_chroma;
+	header.strings_size = cnames->strings_size;
+	ofstream file(filename, ios::out | ios::binary | ios::trunc);
+	if (!file.is_open()) return -1;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(cnames->colors), sizeof(ColorEntry) * cnames->color_count);
+	file.write(reinterpret_cast<const char*>(index->cell_start), sizeof(uint32_t) * (header.cell_count + 1));
+	file.write(cnames->strings, cnames->strings_size);
+	file.close();
+	return file.fail() ? -1 : 0;
+}
+int color_names_source_hash(const char* const* filenames, size_t count, uint64_t* hash)
+{
+	// 64-bit FNV-1a over contents of all files
+	uint64_t value = 14695981039346656037ULL;
+	char buffer[4096];
+	for (size_t i = 0; i < count; i++){
+		ifstream file(filenames[i], ios::in | ios::binary);
+		if (!file.is_open()) return -1;
+		while (file){
+			file.read(buffer, sizeof(buffer));
+			for (streamsize j = 0; j < file.gcount(); j++){
+				value = (value ^ uint8_t(buffer[j])) * 1099511628211ULL;
 			}
 		}
+		// separate files, so that moving lines between them changes the hash
+		value = (value ^ 0xff) * 1099511628211ULL;
 	}
+	*hash = value;
+	return 0;
+}
+void color_names_destroy(ColorNames* cnames)
+{
+	color_names_reset_name_search(cnames);
 	delete cnames;
 }
-string color_names_get(ColorNames* cnames, const Color* color, bool imprecision_postfix)
+/**
+ * Find k nearest entries of a color in color names color space.
+ * @return Number of found entries. Entries and their distances are sorted by distance.
+ */
+static size_t color_names_search(const ColorNames* cnames, const Color* query, size_t k, const ColorEntry** entries, float* deltas)
 {
-	Color c1;
-	cnames->color_space_convert(color, &c1);
-	int x1, y1, z1, x2, y2, z2;
-	color_names_get_color_xyz(cnames, &c1, &x1, &y1, &z1, &x2, &y2, &z2);
-	float result_delta=1e5;
-	ColorEntry* color_entry = nullptr;
-	char skip_mask[8][8][8];
-	memset(&skip_mask, 0, sizeof(skip_mask));
-	/* Search expansion should be from 0 to 7, but this would only increase search time and return
-	 * wrong color names when no closely matching color is found. Search expansion is only useful
-	 * when color name database is very small (16 colors)
-	 */
-	for (int expansion = 0; expansion < 7; ++expansion){
-		int x_start = std::max(x1 - expansion, 0), x_end = std::min(x2 + expansion, 7);
-		int y_start = std::max(y1 - expansion, 0), y_end = std::min(y2 + expansion, 7);
-		int z_start = std::max(z1 - expansion, 0), z_end = std::min(z2 + expansion, 7);
-		for (int x_i = x_start; x_i <= x_end; ++x_i) {
-			for (int y_i = y_start; y_i <= y_end; ++y_i) {
-				for (int z_i = z_start; z_i <= z_end; ++z_i) {
-					if (skip_mask[x_i][y_i][z_i]) continue; // skip checked items
-					skip_mask[x_i][y_i][z_i] = 1;
-					for (list<ColorEntry*>::iterator i=cnames->colors[x_i][y_i][z_i].begin(); i != cnames->colors[x_i][y_i][z_i].end();++i){
-						float delta = cnames->color_space_distance(&(*i)->color, &c1);
-						if (delta < result_delta) {
-							result_delta=delta;
-							color_entry=*i;
+	if (k == 0) return 0;
+	const ColorNamesIndex* index = &cnames->index;
+	double query_chroma = sqrt(query->lab.a * query->lab.a + query->lab.b * query->lab.b);
+	int center[3];
+	for (int axis = 0; axis < 3; axis++){
+		center[axis] = color_names_index_cell(index, axis, query->ma[axis]);
+	}
+	int max_ring = std::max(std::max(index->size[0], index->size[1]), index->size[2]);
+	size_t found = 0;
+	// visit cells in rings of growing Chebyshev distance until no remaining cell can contain a closer color than the k-th found one
+	for (int ring = 0; ring < max_ring; ++ring){
+		if (found == k && color_names_ring_lower_bound(index, ring) > deltas[k - 1]) break;
+		for (int l = std::max(center[0] - ring, 0); l <= std::min(center[0] + ring, index->size[0] - 1); ++l){
+			for (int a = std::max(center[1] - ring, 0); a <= std::min(center[1] + ring, index->size[1] - 1); ++a){
+				for (int b = std::max(center[2] - ring, 0); b <= std::min(center[2] + ring, index->size[2] - 1); ++b){
+					if (std::max(std::max(abs(l - center[0]), abs(a - center[1])), abs(b - center[2])) != ring) continue;
+					int cell = color_names_index_cell_id(index, l, a, b);
+					uint32_t start = index->cell_start[cell], end = index->cell_start[cell + 1];
+					if (start == end) continue;
+					if (found == k && color_names_cell_lower_bound(index, l, a, b, query, query_chroma) > deltas[k - 1]) continue;
+					for (uint32_t i = start; i < end; ++i){
+						float delta = cnames->color_space_distance(&cnames->colors[i].color, query);
+						if (found == k && delta >= deltas[k - 1]) continue;
+						// insertion into sorted result list, dropping the farthest entry when the list is full
+						size_t position = (found < k) ? found++ : k - 1;
+						for (; position > 0 && deltas[position - 1] > delta; position--){
+							entries[position] = entries[position - 1];
+							deltas[position] = deltas[position - 1];
 						}
+						entries[position] = &cnames->colors[i];
+						deltas[position] = delta;
 					}
 				}
 			}
 		}
-		//no need for further expansion if we have found a match
-		if (color_entry) break;
 	}
-	if (color_entry){
-		stringstream s;
-		s << color_entry->name->name;
-		if (imprecision_postfix) if (result_delta>0.1) s<<" ~";
-		return s.str();
+	return found;
+}
+size_t color_names_find_nearest(const ColorNames* cnames, const Color* color, size_t k, ColorNameMatch* matches)
+{
+	if (cnames->color_count == 0 || k == 0) return 0;
+	Color query;
+	cnames->color_space_convert(color, &query);
+	vector<const ColorEntry*> entries(k);
+	vector<float> deltas(k);
+	size_t found = color_names_search(cnames, &query, k, &entries.front(), &deltas.front());
+	for (size_t i = 0; i < found; i++){
+		matches[i].name = cnames->strings + entries[i]->name;
+		matches[i].distance = deltas[i];
+	}
+	return found;
+}
+static uint32_t color_names_cache_key(const Color* color)
+{
+	uint32_t key = 0;
+	for (int i = 0; i < 3; i++){
+		key = (key << 8) | uint32_t(clamp_float(color->ma[i], 0, 1) * 255 + 0.5f);
+	}
+	return key;
+}
+/**
+ * Find the nearest entry of a quantized color.
+ */
+static const ColorEntry* color_names_search_quantized(const ColorNames* cnames, uint32_t key, float* delta)
+{
+	Color color, query;
+	for (int i = 0; i < 3; i++){
+		color.ma[i] = ((key >> (16 - i * 8)) & 0xff) / 255.0f;
 	}
-	return string("");
+	cnames->color_space_convert(&color, &query);
+	const ColorEntry* color_entry = nullptr;
+	color_names_search(cnames, &query, 1, &color_entry, delta);
+	return color_entry;
+}
+static string color_names_format(const ColorNames* cnames, const ColorEntry* color_entry, float delta, bool imprecision_postfix)
+{
+	string name(cnames->strings + color_entry->name);
+	if (imprecision_postfix && delta > 0.1) name += " ~";
+	return name;
+}
+string color_names_get(ColorNames* cnames, const Color* color, bool imprecision_postfix)
+{
+	if (cnames->color_count == 0) return string("");
+	uint32_t key = color_names_cache_key(color);
+	ColorNamesCache* cache = &cnames->cache;
+	ColorNamesCacheSlot* set = &cache->slots[((key * 2654435761u) >> (32 - COLOR_NAMES_CACHE_BITS)) & ~(COLOR_NAMES_CACHE_WAYS - 1)];
+	ColorNamesCacheSlot slot;
+	int way = 0;
+	{
+		lock_guard<mutex> lock(cache->mutex);
+		cache->lookups++;
+		while (way < COLOR_NAMES_CACHE_WAYS && set[way].key != (key | CACHE_VALID)) way++;
+		if (way < COLOR_NAMES_CACHE_WAYS){
+			cache->hits++;
+			slot = set[way];
+		}
+	}
+	if (way == COLOR_NAMES_CACHE_WAYS){
+		// search without holding the lock, so that other threads are not blocked
+		float delta;
+		slot.key = key | CACHE_VALID;
+		slot.entry = color_names_search_quantized(cnames, key, &delta) - cnames->colors;
+		slot.delta = delta;
+	}
+	{
+		lock_guard<mutex> lock(cache->mutex);
+		// keep slots of each set in most recently used order, so that the least recently used slot is replaced
+		way = 0;
+		while (way < COLOR_NAMES_CACHE_WAYS - 1 && set[way].key != slot.key) way++;
+		for (; way > 0; way--){
+			set[way] = set[way - 1];
+		}
+		set[0] = slot;
+	}
+	return color_names_format(cnames, &cnames->colors[slot.entry], slot.delta, imprecision_postfix);
+}
+void color_names_get_batch(const ColorNames* cnames, const Color* colors, size_t count, bool imprecision_postfix, string* names)
+{
+	if (count == 0) return;
+	if (cnames->color_count == 0){
+		for (size_t i = 0; i < count; i++)
+			names[i].clear();
+		return;
+	}
+	auto worker = [cnames, colors, imprecision_postfix, names](size_t start, size_t end){
+		for (size_t i = start; i < end; i++){
+			float delta;
+			const ColorEntry* color_entry = color_names_search_quantized(cnames, color_names_cache_key(&colors[i]), &delta);
+			names[i] = color_names_format(cnames, color_entry, delta, imprecision_postfix);
+		}
+	};
+	size_t thread_count = std::min<size_t>(std::max(thread::hardware_concurrency(), 1u), (count + BATCH_MIN_COLORS_PER_THREAD - 1) / BATCH_MIN_COLORS_PER_THREAD);
+	vector<thread> threads;
+	for (size_t i = 1; i < thread_count; i++){
+		threads.emplace_back(worker, count * i / thread_count, count * (i + 1) / thread_count);
+	}
+	worker(0, count / thread_count);
+	for (auto &worker_thread: threads){
+		worker_thread.join();
+	}
+}
+size_t color_names_find_by_name(ColorNames* cnames, const char* query, size_t max_matches, ColorNameSearchMatch* matches)
+{
+	vector<NameSearchMatch> name_matches(max_matches);
+	size_t count;
+	{
+		lock_guard<mutex> lock(cnames->name_search_mutex);
+		if (cnames->name_search == nullptr){
+			cnames->name_search = name_search_new();
+			for (size_t i = 0; i < cnames->color_count; i++){
+				name_search_add(cnames->name_search, cnames->strings + cnames->colors[i].name, i);
+			}
+			name_search_build(cnames->name_search);
+		}
+		count = name_search_find(cnames->name_search, query, max_matches, name_matches.data());
+	}
+	for (size_t i = 0; i < count; i++){
+		matches[i].name = name_matches[i].name;
+		// color names are stored in Lab color space, see color_names_new
+		color_lab_to_rgb_d50(&cnames->colors[name_matches[i].id].color, &matches[i].color);
+		color_rgb_normalize(&matches[i].color);
+		matches[i].score = name_matches[i].score;
+	}
+	return count;
+}
+void color_names_get_cache_statistics(ColorNames* cnames, uint64_t* lookups, uint64_t* hits)
+{
+	lock_guard<mutex> lock(cnames->cache.mutex);
+	*lookups = cnames->cache.lookups;
+	*hits = cnames->cache.hits;
 }
@@ -20,25 +20,146 @@
 #define GPICK_COLOR_NAMES_COLOR_NAMES_H_
 
 #include "../Color.h"
+#include "../NameSearch.h"
 #include <string>
-#include <list>
+#include <vector>
+#include <mutex>
+#include <cstdint>
 
-typedef struct ColorNameEntry{
-	std::string name;
-}ColorNameEntry;
 typedef struct ColorEntry{
-	Color color;
-	ColorNameEntry* name;
+	Color color; /**< Color in color names color space */
+	uint32_t name; /**< Offset of the name in ColorNames::strings */
 }ColorEntry;
+/** \struct ColorNamesIndex
+ * \brief Uniform grid over Lab color space. Entries of each cell are stored contiguously in ColorNames::colors.
+ */
+typedef struct ColorNamesIndex{
+	float origin[3]; /**< Lowest L, a and b values of all entries */
+	float cell_size[3]; /**< Cell size along L, a and b axes */
+	int32_t size[3]; /**< Number of cells along L, a and b axes */
+	float max_chroma; /**< Largest chroma of all entries */
+	const uint32_t* cell_start; /**< Index of the first entry of each cell in ColorNames::colors. Has one additional element for the end of the last cell */
+}ColorNamesIndex;
+#define COLOR_NAMES_CACHE_BITS 12
+#define COLOR_NAMES_CACHE_SIZE (1 << COLOR_NAMES_CACHE_BITS)
+#define COLOR_NAMES_CACHE_WAYS 4
+typedef struct ColorNamesCacheSlot{
+	uint32_t key; /**< Quantized 24-bit RGB color with additional valid bit */
+	uint32_t entry; /**< Index of the nearest entry in ColorNames::colors */
+	float delta; /**< Distance to the nearest entry, so that imprecision postfix can be decided for both flag values */
+}ColorNamesCacheSlot;
+/** \struct ColorNamesCache
+ * \brief Bounded set associative cache of color_names_get results with least recently used replacement.
+ */
+typedef struct ColorNamesCache{
+	std::mutex mutex;
+	ColorNamesCacheSlot slots[COLOR_NAMES_CACHE_SIZE];
+	uint64_t lookups; /**< Number of color_names_get calls */
+	uint64_t hits; /**< Number of color_names_get calls answered from cache */
+}ColorNamesCache;
+/** \struct ColorNames
+ * \brief Color names with search index. Entries, names and index either point to owned storage or to a memory mapped color names database.
+ */
 typedef struct ColorNames{
-	std::list<ColorNameEntry*> names;
-	std::list<ColorEntry*> colors[8][8][8];
+	const ColorEntry* colors; /**< Color entries sorted by index cell */
+	size_t color_count; /**< Number of color entries */
+	const char* strings; /**< Null terminated color names */
+	size_t strings_size; /**< Size of all color names in bytes */
+	ColorNamesIndex index;
+	ColorNamesCache cache;
+	NameSearch* name_search; /**< Name search index, which is built on first search */
+	std::mutex name_search_mutex;
+	std::vector<ColorEntry> color_storage;
+	std::vector<char> string_storage;
+	std::vector<uint32_t> cell_start_storage;
 	void (*color_space_convert)(const Color* a, Color* b);
 	float (*color_space_distance)(const Color* a, const Color* b);
 }ColorNames;
+/** \struct ColorNameMatch
+ * \brief Color name found by color_names_find_nearest.
+ */
+typedef struct ColorNameMatch{
+	const char* name; /**< Color name, which stays valid until color names are destroyed or more names are loaded */
+	float distance; /**< Distance between query color and named color */
+}ColorNameMatch;
+/** \struct ColorNameSearchMatch
+ * \brief Color name found by color_names_find_by_name.
+ */
+typedef struct ColorNameSearchMatch{
+	const char* name; /**< Color name, which stays valid until color names are destroyed or more names are loaded */
+	Color color; /**< Named color in RGB color space */
+	float score; /**< Match score, higher is better */
+}ColorNameSearchMatch;
 ColorNames* color_names_new();
 int color_names_load_from_file(ColorNames* cnames, const char* filename);
+/**
+ * Use precompiled color names database. Data is not copied and must stay valid until color names are destroyed or more names are loaded from a file.
+ * @param[in] cnames Color names.
+ * @param[in] data Database file contents.
+ * @param[in] size Size of database file contents.
+ * @param[in] source_hash Expected hash of color names text files, which database must have been compiled from.
+ * @return 0 on success, -1 when data is not a valid database or it is stale.
+ */
+int color_names_load_from_memory(ColorNames* cnames, const void* data, size_t size, uint64_t source_hash);
+/**
+ * Write color names, precomputed color values and search index into a database file, which can be used by color_names_load_from_memory.
+ * @param[in] cnames Color names.
+ * @param[in] filename Database file name.
+ * @param[in] source_hash Hash of color names text files, returned by color_names_source_hash.
+ * @return 0 on success, -1 on write error.
+ */
+int color_names_save_database(const ColorNames* cnames, const char* filename, uint64_t source_hash);
+/**
+ * Calculate hash of color names text files contents. Used to detect stale color names databases.
+ * @param[in] filenames Color names text file names.
+ * @param[in] count Number of file names.
+ * @param[out] hash Hash of all file contents.
+ * @return 0 on success, -1 when any of the files can not be read.
+ */
+int color_names_source_hash(const char* const* filenames, size_t count, uint64_t* hash);
 void color_names_destroy(ColorNames* cnames);
+/**
+ * Find name of the nearest color. Search uses color names index and is exact under color_distance_lch.
+ * Colors are quantized to 24-bit RGB and results are cached, so repeated lookups of the same color do not search again.
+ * @param[in] cnames Color names.
+ * @param[in] color Color in RGB color space.
+ * @param[in] imprecision_postfix Append "~" to name when color does not match exactly.
+ * @return Color name or empty string, when there are no color names.
+ */
 std::string color_names_get(ColorNames* cnames, const Color* color, bool imprecision_postfix);
+/**
+ * Find k nearest color names. Search is exact under color_distance_lch and does not use the color_names_get cache.
+ * @param[in] cnames Color names.
+ * @param[in] color Color in RGB color space.
+ * @param[in] k Maximum number of names to find.
+ * @param[out] matches Array of at least k elements, which receives names sorted by distance.
+ * @return Number of found names.
+ */
+size_t color_names_find_nearest(const ColorNames* cnames, const Color* color, size_t k, ColorNameMatch* matches);
+/**
+ * Find names of multiple colors using multiple threads. Results are the same as color_names_get results.
+ * @param[in] cnames Color names.
+ * @param[in] colors Colors in RGB color space.
+ * @param[in] count Number of colors.
+ * @param[in] imprecision_postfix Append "~" to names when colors do not match exactly.
+ * @param[out] names Array of count elements, which receives color names.
+ */
+void color_names_get_batch(const ColorNames* cnames, const Color* colors, size_t count, bool imprecision_postfix, std::string* names);
+/**
+ * Find colors by name using prefix and fuzzy matching.
+ * @param[in] cnames Color names.
+ * @param[in] query Search query.
+ * @param[in] max_matches Maximum number of matches.
+ * @param[out] matches Array of at least max_matches elements, which receives matches sorted by score.
+ * @return Number of matches.
+ */
+size_t color_names_find_by_name(ColorNames* cnames, const char* query, size_t max_matches, ColorNameSearchMatch* matches);
+/**
+ * Get color_names_get cache statistics.
+ * @param[in] cnames Color names.
+ * @param[out] lookups Number of lookups.
+ * @param[out] hits Number of lookups answered from cache.
+ */
+void color_names_get_cache_statistics(ColorNames* cnames, uint64_t* lookups, uint64_t* hits);
 
 #endif /* GPICK_COLOR_NAMES_COLOR_NAMES_H_ */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../ColorNames.h"
+#include "../../Color.h"
+#include <iostream>
+using namespace std;
+
+int main(int argc, char **argv)
+{
+	if (argc < 3){
+		cerr << "Usage: " << argv[0] << " <database> <color names file>..." << endl;
+		return 1;
+	}
+	color_init();
+	const char* const* filenames = argv + 2;
+	size_t count = argc - 2;
+	uint64_t source_hash;
+	if (color_names_source_hash(filenames, count, &source_hash) != 0){
+		cerr << "Could not read color names files" << endl;
+		return 1;
+	}
+	ColorNames* cnames = color_names_new();
+	for (size_t i = 0; i < count; i++){
+		if (color_names_load_from_file(cnames, filenames[i]) != 0){
+			cerr << "Could not load color names from \"" << filenames[i] << "\"" << endl;
+			color_names_destroy(cnames);
+			return 1;
+		}
+	}
+	if (color_names_save_database(cnames, argv[1], source_hash) != 0){
+		cerr << "Could not write color names database \"" << argv[1] << "\"" << endl;
+		color_names_destroy(cnames);
+		return 1;
+	}
+	color_names_destroy(cnames);
+	return 0;
+}
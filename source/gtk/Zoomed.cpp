@@ -19,6 +19,7 @@
 #include "Zoomed.h"
 #include "../Color.h"
 #include "../MathUtil.h"
+#include "../ZoomRenderer.h"
 #include <math.h>
 #include <iomanip>
 #include <algorithm>
@@ -48,7 +49,7 @@ typedef struct GtkZoomedPrivate
 {
 	Color color;
 	gfloat zoom;
-	GdkPixbuf *pixbuf;
+	ZoomRenderer *renderer;
 	vector2 point;
 	vector2 point_size;
 	int32_t width_height;
@@ -94,16 +95,7 @@ GtkWidget* gtk_zoomed_new()
 	ns->point.x = 0;
 	ns->point.y = 0;
 	ns->width_height = 150;
-	ns->pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, ns->width_height, ns->width_height);
-	int rowstride;
-	rowstride = gdk_pixbuf_get_rowstride(ns->pixbuf);
-	guchar *pixels = gdk_pixbuf_get_pixels(ns->pixbuf);
-	for (int y = 0; y < ns->width_height; y++){
-		guchar *p = pixels + y * rowstride;
-		for (int x = 0; x < ns->width_height * 3; x++){
-			p[x] = 0x80;
-		}
-	}
+	ns->renderer = zoom_renderer_new(ns->width_height);
 	gtk_widget_set_size_request(GTK_WIDGET(widget), ns->width_height + widget->style->xthickness * 2, ns->width_height + widget->style->ythickness * 2);
 	return widget;
 }
@@ -116,21 +108,8 @@ void gtk_zoomed_set_size(GtkZoomed *zoomed, int32_t width_height)
 {
 	GtkZoomedPrivate *ns = GTK_ZOOMED_GET_PRIVATE(zoomed);
 	if (ns->width_height != width_height){
-		if (ns->pixbuf){
-			g_object_unref(ns->pixbuf);
-			ns->pixbuf = 0;
-		}
 		ns->width_height = width_height;
-		ns->pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, ns->width_height, ns->width_height);
-		int rowstride;
-		rowstride = gdk_pixbuf_get_rowstride(ns->pixbuf);
-		guchar *pixels = gdk_pixbuf_get_pixels(ns->pixbuf);
-		for (int y = 0; y < ns->width_height; y++){
-			guchar *p = pixels + y * rowstride;
-			for (int x = 0; x < ns->width_height * 3; x++){
-				p[x] = 0x80;
-			}
-		}
+		zoom_renderer_set_size(ns->renderer, ns->width_height);
 		gtk_widget_set_size_request(GTK_WIDGET(zoomed), ns->width_height + GTK_WIDGET(zoomed)->style->xthickness * 2, ns->width_height + GTK_WIDGET(zoomed)->style->ythickness * 2);
 	}
 }
@@ -143,9 +122,9 @@ void gtk_zoomed_set_fade(GtkZoomed* zoomed, bool fade)
 static void gtk_zoomed_finalize(GObject *zoomed_obj)
 {
 	GtkZoomedPrivate *ns = GTK_ZOOMED_GET_PRIVATE(zoomed_obj);
-	if (ns->pixbuf){
-		g_object_unref(ns->pixbuf);
-		ns->pixbuf = 0;
+	if (ns->renderer){
+		zoom_renderer_destroy(ns->renderer);
+		ns->renderer = nullptr;
 	}
 	G_OBJECT_CLASS(parent_class)->finalize(zoomed_obj);
 }
@@ -158,12 +137,11 @@ void gtk_zoomed_get_current_screen_rect(GtkZoomed* zoomed, math::Rect2<int> *rec
 	GtkZoomedPrivate *ns = GTK_ZOOMED_GET_PRIVATE(zoomed);
 	gtk_zoomed_get_screen_rect(zoomed, ns->pointer, ns->screen_rect, rect);
 }
-void gtk_zoomed_get_screen_rect(GtkZoomed *zoomed, math::Vec2<int>& pointer, math::Rect2<int>& screen_rect, math::Rect2<int> *rect)
+void gtk_zoomed_calculate_screen_rect(int32_t width_height, gfloat zoom, math::Vec2<int>& pointer, math::Rect2<int>& screen_rect, math::Rect2<int> *rect)
 {
-	GtkZoomedPrivate *ns = GTK_ZOOMED_GET_PRIVATE(zoomed);
 	gint32 x = pointer.x, y = pointer.y;
 	gint32 left, right, top, bottom;
-	gint32 area_width = uint32_t(ns->width_height * zoom_transformation(ns->zoom));
+	gint32 area_width = uint32_t(width_height * zoom_transformation(zoom));
 	if (!area_width) area_width = 1;
 	left = x - area_width / 2;
 	top = y - area_width / 2;
@@ -187,6 +165,11 @@ void gtk_zoomed_get_screen_rect(GtkZoomed *zoomed, math::Vec2<int>& pointer, mat
 	}
 	*rect = math::Rect2<int>(left, top, right, bottom);
 }
+void gtk_zoomed_get_screen_rect(GtkZoomed *zoomed, math::Vec2<int>& pointer, math::Rect2<int>& screen_rect, math::Rect2<int> *rect)
+{
+	GtkZoomedPrivate *ns = GTK_ZOOMED_GET_PRIVATE(zoomed);
+	gtk_zoomed_calculate_screen_rect(ns->width_height, ns->zoom, pointer, screen_rect, rect);
+}
 math::Vec2<int> gtk_zoomed_get_screen_position(GtkZoomed *zoomed, const math::Vec2<int>& position)
 {
 	GtkZoomedPrivate *ns = GTK_ZOOMED_GET_PRIVATE(zoomed);
@@ -227,41 +210,30 @@ void gtk_zoomed_update(GtkZoomed *zoomed, math::Vec2<int>& pointer, math::Rect2<
 	ns->pointer = pointer;
 	ns->screen_rect = screen_rect;
 	gint32 x = pointer.x, y = pointer.y;
-	gint32 left, right, top, bottom;
+	math::Rect2<int> area;
+	gtk_zoomed_calculate_screen_rect(ns->width_height, ns->zoom, pointer, screen_rect, &area);
 	gint32 area_width = uint32_t(ns->width_height * zoom_transformation(ns->zoom));
 	if (!area_width) area_width = 1;
-	left = x - area_width / 2;
-	top = y - area_width / 2;
-	right = x + (area_width - area_width / 2);
-	bottom = y + (area_width - area_width / 2);
-	if (left < ns->screen_rect.getLeft()){
-		right += -(left - ns->screen_rect.getLeft());
-		left = ns->screen_rect.getLeft();
-	}
-	if (right > ns->screen_rect.getRight()){
-		left -= right - ns->screen_rect.getRight();
-		right = ns->screen_rect.getRight();
-	}
-	if (top < ns->screen_rect.getTop()){
-		bottom += -(top - ns->screen_rect.getTop());
-		top = ns->screen_rect.getTop();
-	}
-	if (bottom > ns->screen_rect.getBottom()){
-		top -= bottom - ns->screen_rect.getBottom();
-		bottom = ns->screen_rect.getBottom();
-	}
+	gint32 left = area.getLeft(), top = area.getTop();
 	gint32 xl = ((x - left) * ns->width_height) / area_width;
 	gint32 xh = (((x + 1) - left) * ns->width_height) / area_width;
 	gint32 yl = ((y - top) * ns->width_height) / area_width;
 	gint32 yh = (((y + 1) - top) * ns->width_height) / area_width;
+	vector2 point = ns->point, point_size = ns->point_size;
 	ns->point.x = (xl + xh) / 2.0;
 	ns->point.y = (yl + yh) / 2.0;
 	ns->point_size.x = xh - xl;
 	ns->point_size.y = yh - yl;
-	int width = right - left;
-	int height = bottom - top;
-	gdk_pixbuf_scale(pixbuf, ns->pixbuf, 0, 0, ns->width_height, ns->width_height, -offset.x * ns->width_height / (double)width, -offset.y * ns->width_height / (double)height, ns->width_height / (double)width, ns->width_height / (double)height, GDK_INTERP_NEAREST);
-	gtk_widget_queue_draw(GTK_WIDGET(zoomed));
+	math::Rect2<int> changed_rect;
+	bool changed = zoom_renderer_render(ns->renderer, area, offset, pixbuf, &changed_rect);
+	// pointer marker and marks move with the pointer, so only pixel changes under a still pointer can be redrawn partially
+	bool moved = point.x != ns->point.x || point.y != ns->point.y || point_size.x != ns->point_size.x || point_size.y != ns->point_size.y;
+	GtkWidget *widget = GTK_WIDGET(zoomed);
+	if (moved || ns->marks[0].valid || ns->marks[1].valid){
+		gtk_widget_queue_draw(widget);
+	}else if (changed){
+		gtk_widget_queue_draw_area(widget, widget->style->xthickness * 2 + changed_rect.getX(), widget->style->ythickness * 2 + changed_rect.getY(), changed_rect.getWidth(), changed_rect.getHeight());
+	}
 }
 void gtk_zoomed_set_zoom(GtkZoomed *zoomed, gfloat zoom)
 {
@@ -285,9 +257,11 @@ static gboolean gtk_zoomed_expose(GtkWidget *widget, GdkEventExpose *event)
 	GtkZoomedPrivate *ns = GTK_ZOOMED_GET_PRIVATE(widget);
 	cairo_t *cr;
 	cr = gdk_cairo_create(widget->window);
+	gdk_cairo_region(cr, event->region);
+	cairo_clip(cr);
 	cairo_translate(cr, widget->style->xthickness, widget->style->ythickness);
-	if (ns->pixbuf){
-		gdk_cairo_set_source_pixbuf(cr, ns->pixbuf, widget->style->xthickness, widget->style->ythickness);
+	if (ns->renderer){
+		cairo_set_source_surface(cr, zoom_renderer_get_surface(ns->renderer), widget->style->xthickness, widget->style->ythickness);
 		if (ns->fade){
 			cairo_paint_with_alpha(cr, 0.2);
 		}else{
@@ -71,6 +71,16 @@ void gtk_zoomed_clear_mark(GtkZoomed *zoomed, int index);
 void gtk_zoomed_update(GtkZoomed* zoomed, math::Vec2<int>& pointer, math::Rect2<int>& screen_rect, math::Vec2<int>& offset, GdkPixbuf* pixbuf);
 void gtk_zoomed_get_screen_rect(GtkZoomed* zoomed, math::Vec2<int>& pointer, math::Rect2<int>& screen_rect, math::Rect2<int> *rect);
 
+/**
+ * Calculate screen area shown by a zoomed view. Does not need a widget, so it can be used without a display.
+ * @param[in] width_height Zoomed view size.
+ * @param[in] zoom Zoom level.
+ * @param[in] pointer Pointer position.
+ * @param[in] screen_rect Monitor area, which contains the pointer.
+ * @param[out] rect Shown screen area.
+ */
+void gtk_zoomed_calculate_screen_rect(int32_t width_height, gfloat zoom, math::Vec2<int>& pointer, math::Rect2<int>& screen_rect, math::Rect2<int> *rect);
+
 GType gtk_zoomed_get_type(void);
 
 G_END_DECLS
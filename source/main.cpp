@@ -23,8 +23,11 @@
 #include "Internationalisation.h"
 #include "version/Version.h"
 #include "DynvHelpers.h"
+#include "Color.h"
+#include "simd/Dispatch.h"
 #include <gtk/gtk.h>
 #include <string>
+#include <sstream>
 using namespace std;
 
 static gchar **commandline_filename = nullptr;
@@ -35,6 +38,7 @@ static gboolean output_without_newline = FALSE;
 static gboolean single_color_pick_mode = FALSE;
 static gboolean version_information = FALSE;
 static gboolean do_not_start = FALSE;
+static gboolean print_cpu_dispatch = FALSE;
 static gchar *converter_name = nullptr;
 static GOptionEntry commandline_entries[] =
 {
@@ -46,6 +50,7 @@ static GOptionEntry commandline_entries[] =
 	{"no-start", 0, 0, G_OPTION_ARG_NONE, &do_not_start, "Do not start Gpick if it is not already running", nullptr},
 	{"converter-name", 'c', 0, G_OPTION_ARG_STRING, &converter_name, "Converter name used for floating picker mode", nullptr},
 	{"version", 'v', 0, G_OPTION_ARG_NONE, &version_information, "Print version information", nullptr},
+	{"print-cpu-dispatch", 0, 0, G_OPTION_ARG_NONE, &print_cpu_dispatch, "Print instruction sets and kernels selected for this CPU", nullptr},
 	{G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &commandline_filename, nullptr, "[FILE...]"},
 	{nullptr}
 };
@@ -82,6 +87,15 @@ int main(int argc, char **argv)
 		g_strfreev(argv_copy);
 		return 0;
 	}
+	if (print_cpu_dispatch){
+		color_init();
+		stringstream report;
+		dispatch_print(report);
+		g_print("%s", report.str().c_str());
+		g_option_context_free(context);
+		g_strfreev(argv_copy);
+		return 0;
+	}
 	AppOptions options;
 	options.floating_picker_mode = pick_color;
 	options.output_picked_color = output_picked_color;
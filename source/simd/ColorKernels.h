@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SIMD_COLOR_KERNELS_H_
+#define GPICK_SIMD_COLOR_KERNELS_H_
+
+#include "../ColorBatch.h"
+
+/** \file source/simd/ColorKernels.h
+ * \brief Tables of color conversion kernels compiled for different instruction sets.
+ */
+
+/** \struct ColorKernelParameters
+ * \brief Constants used by color conversion kernels. Matrices are stored in row-major order.
+ */
+typedef struct ColorKernelParameters{
+	float rgb_to_xyz[9]; /**< Linear sRGB to XYZ (D65) matrix */
+	float xyz_to_rgb[9]; /**< XYZ (D65) to linear sRGB matrix */
+	float rgb_to_xyz_d50[9]; /**< Linear sRGB to XYZ matrix with D65-D50 chromatic adaptation */
+	float xyz_d50_to_rgb[9]; /**< XYZ to linear sRGB matrix with D50-D65 chromatic adaptation */
+	float white_d50[3]; /**< D50 reference white */
+}ColorKernelParameters;
+
+typedef void (*ColorKernel)(const ColorSpan* a, ColorSpan* b, const ColorKernelParameters* parameters);
+typedef void (*ColorDistanceKernel)(const ColorSpan* a, const float* b, float* distances);
+
+/** \struct ColorKernels
+ * \brief Color conversion kernels for one instruction set.
+ */
+typedef struct ColorKernels{
+	const char *name; /**< Instruction set name */
+	ColorKernel rgb_to_hsv;
+	ColorKernel hsv_to_rgb;
+	ColorKernel rgb_to_hsl;
+	ColorKernel hsl_to_rgb;
+	ColorKernel rgb_to_xyz;
+	ColorKernel xyz_to_rgb;
+	ColorKernel rgb_to_lab_d50;
+	ColorKernel lab_to_rgb_d50;
+	ColorKernel rgb_to_lch_d50;
+	ColorKernel lch_to_rgb_d50;
+	ColorKernel rgb_get_linear;
+	ColorKernel linear_get_rgb;
+	ColorDistanceKernel distance; /**< Batch version of color_distance */
+	ColorDistanceKernel distance_lch; /**< Batch version of color_distance_lch */
+}ColorKernels;
+
+/**
+ * Get portable scalar kernels.
+ * @return Kernel table.
+ */
+const ColorKernels* color_kernels_scalar();
+
+/**
+ * Get SSE2 kernels.
+ * @return Kernel table or nullptr, when kernels were not compiled in.
+ */
+const ColorKernels* color_kernels_sse2();
+
+/**
+ * Get SSE4.1 kernels.
+ * @return Kernel table or nullptr, when kernels were not compiled in.
+ */
+const ColorKernels* color_kernels_sse4_1();
+
+/**
+ * Get AVX2 kernels.
+ * @return Kernel table or nullptr, when kernels were not compiled in.
+ */
+const ColorKernels* color_kernels_avx2();
+
+/**
+ * Get AVX-512 kernels.
+ * @return Kernel table or nullptr, when kernels were not compiled in.
+ */
+const ColorKernels* color_kernels_avx512();
+
+#endif /* GPICK_SIMD_COLOR_KERNELS_H_ */
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SIMD_COLOR_KERNELS_IMPL_H_
+#define GPICK_SIMD_COLOR_KERNELS_IMPL_H_
+
+#include "ColorKernels.h"
+#include "Vector.h"
+
+/** \file source/simd/ColorKernelsImpl.h
+ * \brief Color conversion kernels written once for all SIMD wrappers from Vector.h.
+ *
+ * Must only be included by kernel translation units, each of which instantiates kernels for one instruction set.
+ * Branches of single color functions are replaced by computing both sides and selecting the result per lane.
+ */
+
+namespace simd {
+namespace {
+
+const float lab_epsilon = 216.0f / 24389.0f;
+const float lab_kappa = 24389.0f / 27.0f;
+
+/**
+ * Natural logarithm of positive normal values. Cephes logf polynomial, relative error below 1e-7.
+ */
+template<typename F> inline F natural_log(F x)
+{
+	F e;
+	F m = split_exponent(x, e);
+	auto small = m < F(0.707106781186547524f);
+	e = select(small, e - 1.0f, e);
+	m = select(small, m + m, m) - 1.0f;
+	F z = m * m;
+	F y = F(7.0376836292e-2f);
+	y = y * m - 1.1514610310e-1f;
+	y = y * m + 1.1676998740e-1f;
+	y = y * m - 1.2420140846e-1f;
+	y = y * m + 1.4249322787e-1f;
+	y = y * m - 1.6668057665e-1f;
+	y = y * m + 2.0000714765e-1f;
+	y = y * m - 2.4999993993e-1f;
+	y = y * m + 3.3333331174e-1f;
+	y = y * m * z;
+	y = y + e * -2.12194440e-4f;
+	y = y - z * 0.5f;
+	return m + y + e * 0.693359375f;
+}
+/**
+ * Natural exponent. Cephes expf polynomial, relative error below 2e-7.
+ */
+template<typename F> inline F natural_exp(F x)
+{
+	x = min(max(x, F(-87.3f)), F(88.3f));
+	F n = floor(x * 1.44269504088896341f + 0.5f);
+	x = x - n * 0.693359375f;
+	x = x - n * -2.12194440e-4f;
+	F z = x * x;
+	F y = F(1.9875691500e-4f);
+	y = y * x + 1.3981999507e-3f;
+	y = y * x + 8.3334519073e-3f;
+	y = y * x + 4.1665795894e-2f;
+	y = y * x + 1.6666665459e-1f;
+	y = y * x + 5.0000001201e-1f;
+	y = y * z + x + 1.0f;
+	return y * exp2i(n);
+}
+template<typename F> inline F power(F x, float y)
+{
+	return natural_exp(natural_log(x) * y);
+}
+/**
+ * Four quadrant arc tangent in degrees. Returns zero when both arguments are zero.
+ */
+template<typename F> inline F atan2_degrees(F y, F x)
+{
+	F ax = abs(x), ay = abs(y);
+	F largest = max(ax, ay), smallest = min(ax, ay);
+	F t = smallest / largest;
+	auto reduce = t > F(0.4142135623730950f);
+	F u = select(reduce, (t - 1.0f) / (t + 1.0f), t);
+	F z = u * u;
+	F r = (((z * 8.05374449538e-2f - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * u + u;
+	r = select(reduce, r + 0.785398163397448f, r);
+	r = select(ay > ax, F(1.57079632679490f) - r, r);
+	r = select(x < F(0.0f), F(3.14159265358979f) - r, r);
+	r = select(y < F(0.0f), F(0.0f) - r, r);
+	r = select(largest == F(0.0f), F(0.0f), r);
+	return r * 57.2957795130823f;
+}
+/**
+ * Sine and cosine of angle in degrees. Angle is reduced to [-45, 45] degree range, so precision does not depend on quadrant.
+ */
+template<typename F> inline void sincos_degrees(F x, F &s, F &c)
+{
+	F q = floor(x * (1.0f / 90.0f) + 0.5f);
+	F r = (x - q * 90.0f) * 0.0174532925199433f;
+	F z = r * r;
+	F sr = ((z * -1.9515295891e-4f + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+	F cr = ((z * 2.443315711809948e-5f - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - z * 0.5f + 1.0f;
+	F k = q - floor(q * 0.25f) * 4.0f;
+	s = select(k == F(0.0f), sr, select(k == F(1.0f), cr, select(k == F(2.0f), F(0.0f) - sr, F(0.0f) - cr)));
+	c = select(k == F(0.0f), cr, select(k == F(1.0f), F(0.0f) - sr, select(k == F(2.0f), F(0.0f) - cr, sr)));
+}
+template<typename F> inline F srgb_decode(F c)
+{
+	return select(c > F(0.04045f), power((c + 0.055f) / 1.055f, 2.4f), c / 12.92f);
+}
+template<typename F> inline F srgb_encode(F c)
+{
+	return select(c > F(0.0031308f), power(c, 1.0f / 2.4f) * 1.055f - 0.055f, c * 12.92f);
+}
+template<typename F> inline void transform(const float *m, F &x, F &y, F &z)
+{
+	F a = x * m[0] + y * m[1] + z * m[2];
+	F b = x * m[3] + y * m[4] + z * m[5];
+	F c = x * m[6] + y * m[7] + z * m[8];
+	x = a;
+	y = b;
+	z = c;
+}
+template<typename F> inline F rgb_hue(F r, F g, F b, F max_value, F delta)
+{
+	F h = select(r == max_value, (g - b) / delta, select(g == max_value, (b - r) / delta + 2.0f, (r - g) / delta + 4.0f));
+	h = h / 6.0f;
+	h = select(h < F(0.0f), h + 1.0f, h);
+	return select(h >= F(1.0f), h - 1.0f, h);
+}
+template<typename F> inline void rgb_to_hsv(F &x, F &y, F &z)
+{
+	F max_value = max(max(x, y), z);
+	F min_value = min(min(x, y), z);
+	F delta = max_value - min_value;
+	F s = select(max_value != F(0.0f), delta / max_value, F(0.0f));
+	F h = select(s == F(0.0f), F(0.0f), rgb_hue(x, y, z, max_value, delta));
+	x = h;
+	y = s;
+	z = max_value;
+}
+template<typename F> inline void hsv_to_rgb(F &x, F &y, F &z)
+{
+	F v = z, s = y;
+	F h = (x - floor(x)) * 6.0f;
+	F i = floor(h);
+	F f = h - i;
+	F p = v * (F(1.0f) - s);
+	F q = v * (F(1.0f) - s * f);
+	F t = v * (F(1.0f) - s * (F(1.0f) - f));
+	auto i0 = i == F(0.0f), i1 = i == F(1.0f), i2 = i == F(2.0f), i3 = i == F(3.0f), i4 = i == F(4.0f);
+	F r = select(i0, v, select(i1, q, select(i2, p, select(i3, p, select(i4, t, v)))));
+	F g = select(i0, t, select(i1, v, select(i2, v, select(i3, q, p))));
+	F b = select(i0, p, select(i1, p, select(i2, t, select(i3, v, select(i4, v, q)))));
+	auto gray = s == F(0.0f);
+	x = select(gray, v, r);
+	y = select(gray, v, g);
+	z = select(gray, v, b);
+}
+template<typename F> inline void rgb_to_hsl(F &x, F &y, F &z)
+{
+	F max_value = max(max(x, y), z);
+	F min_value = min(min(x, y), z);
+	F delta = max_value - min_value;
+	F l = (max_value + min_value) / 2.0f;
+	F s = select(l < F(0.5f), delta / (max_value + min_value), delta / (F(2.0f) - max_value - min_value));
+	F h = rgb_hue(x, y, z, max_value, delta);
+	auto gray = delta == F(0.0f);
+	x = select(gray, F(0.0f), h);
+	y = select(gray, F(0.0f), s);
+	z = l;
+}
+template<typename F> inline F hsl_channel(F t, F p, F q)
+{
+	return select(t * 6.0f < F(1.0f), p + (q - p) * 6.0f * t,
+		select(t * 2.0f < F(1.0f), q,
+		select(t * 3.0f < F(2.0f), p + (q - p) * (F(2.0f / 3.0f) - t) * 6.0f, p)));
+}
+template<typename F> inline void hsl_to_rgb(F &x, F &y, F &z)
+{
+	F h = x, s = y, l = z;
+	F q = select(l < F(0.5f), l * (s + 1.0f), l + s - l * s);
+	F p = l * 2.0f - q;
+	F tr = h + 1.0f / 3.0f;
+	tr = select(tr > F(1.0f), tr - 1.0f, tr);
+	F tb = h - 1.0f / 3.0f;
+	tb = select(tb < F(0.0f), tb + 1.0f, tb);
+	auto gray = s == F(0.0f);
+	x = select(gray, l, hsl_channel(tr, p, q));
+	y = select(gray, l, hsl_channel(h, p, q));
+	z = select(gray, l, hsl_channel(tb, p, q));
+}
+template<typename F> inline F lab_f(F t)
+{
+	return select(t > F(lab_epsilon), power(t, 1.0f / 3.0f), (t * lab_kappa + 16.0f) / 116.0f);
+}
+template<typename F> inline void xyz_to_lab(const float *white, F &x, F &y, F &z)
+{
+	F fx = lab_f(x / white[0]);
+	F fy = lab_f(y / white[1]);
+	F fz = lab_f(z / white[2]);
+	x = fy * 116.0f - 16.0f;
+	y = (fx - fy) * 500.0f;
+	z = (fy - fz) * 200.0f;
+}
+template<typename F> inline void lab_to_xyz(const float *white, F &x, F &y, F &z)
+{
+	F fy = (x + 16.0f) / 116.0f;
+	F fx = y / 500.0f + fy;
+	F fz = fy - z / 200.0f;
+	F fx3 = fx * fx * fx, fy3 = fy * fy * fy, fz3 = fz * fz * fz;
+	F rx = select(fx3 > F(lab_epsilon), fx3, (fx * 116.0f - 16.0f) / lab_kappa);
+	F ry = select(x > F(lab_kappa * lab_epsilon), fy3, x / lab_kappa);
+	F rz = select(fz3 > F(lab_epsilon), fz3, (fz * 116.0f - 16.0f) / lab_kappa);
+	x = rx * white[0];
+	y = ry * white[1];
+	z = rz * white[2];
+}
+template<typename F> inline void lab_to_lch(F &x, F &y, F &z)
+{
+	F c = sqrt(y * y + z * z);
+	F h = atan2_degrees(z, y);
+	h = select(h < F(0.0f), h + 360.0f, h);
+	h = select(h >= F(360.0f), h - 360.0f, h);
+	y = c;
+	z = h;
+}
+template<typename F> inline void lch_to_lab(F &x, F &y, F &z)
+{
+	F s, c;
+	sincos_degrees(z, s, c);
+	F a = y * c;
+	F b = y * s;
+	y = a;
+	z = b;
+}
+
+template<typename F, typename Operation> inline void run(const ColorSpan *a, ColorSpan *b, Operation operation)
+{
+	size_t count = a->count, i = 0;
+	const float *in_x = a->component[0], *in_y = a->component[1], *in_z = a->component[2];
+	float *out_x = b->component[0], *out_y = b->component[1], *out_z = b->component[2];
+	for (; i + F::width <= count; i += F::width){
+		F x = F::load(in_x + i), y = F::load(in_y + i), z = F::load(in_z + i);
+		operation(x, y, z);
+		x.store(out_x + i);
+		y.store(out_y + i);
+		z.store(out_z + i);
+	}
+	for (; i < count; i++){
+		Scalar x = in_x[i], y = in_y[i], z = in_z[i];
+		operation(x, y, z);
+		out_x[i] = x.v;
+		out_y[i] = y.v;
+		out_z[i] = z.v;
+	}
+}
+
+template<typename F, typename Operation> inline void run_distance(const ColorSpan *a, float *distances, Operation operation)
+{
+	size_t count = a->count, i = 0;
+	const float *in_x = a->component[0], *in_y = a->component[1], *in_z = a->component[2];
+	for (; i + F::width <= count; i += F::width){
+		operation(F::load(in_x + i), F::load(in_y + i), F::load(in_z + i)).store(distances + i);
+	}
+	for (; i < count; i++){
+		distances[i] = operation(Scalar(in_x[i]), Scalar(in_y[i]), Scalar(in_z[i])).v;
+	}
+}
+
+template<typename F> void kernel_rgb_to_hsv(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [](auto &x, auto &y, auto &z){ rgb_to_hsv(x, y, z); });
+}
+template<typename F> void kernel_hsv_to_rgb(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [](auto &x, auto &y, auto &z){ hsv_to_rgb(x, y, z); });
+}
+template<typename F> void kernel_rgb_to_hsl(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [](auto &x, auto &y, auto &z){ rgb_to_hsl(x, y, z); });
+}
+template<typename F> void kernel_hsl_to_rgb(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [](auto &x, auto &y, auto &z){ hsl_to_rgb(x, y, z); });
+}
+template<typename F> void kernel_rgb_to_xyz(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [parameters](auto &x, auto &y, auto &z){
+		x = srgb_decode(x);
+		y = srgb_decode(y);
+		z = srgb_decode(z);
+		transform(parameters->rgb_to_xyz, x, y, z);
+	});
+}
+template<typename F> void kernel_xyz_to_rgb(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [parameters](auto &x, auto &y, auto &z){
+		transform(parameters->xyz_to_rgb, x, y, z);
+		x = srgb_encode(x);
+		y = srgb_encode(y);
+		z = srgb_encode(z);
+	});
+}
+template<typename F> void kernel_rgb_to_lab_d50(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [parameters](auto &x, auto &y, auto &z){
+		x = srgb_decode(x);
+		y = srgb_decode(y);
+		z = srgb_decode(z);
+		transform(parameters->rgb_to_xyz_d50, x, y, z);
+		xyz_to_lab(parameters->white_d50, x, y, z);
+	});
+}
+template<typename F> void kernel_lab_to_rgb_d50(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [parameters](auto &x, auto &y, auto &z){
+		lab_to_xyz(parameters->white_d50, x, y, z);
+		transform(parameters->xyz_d50_to_rgb, x, y, z);
+		x = srgb_encode(x);
+		y = srgb_encode(y);
+		z = srgb_encode(z);
+	});
+}
+template<typename F> void kernel_rgb_to_lch_d50(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [parameters](auto &x, auto &y, auto &z){
+		x = srgb_decode(x);
+		y = srgb_decode(y);
+		z = srgb_decode(z);
+		transform(parameters->rgb_to_xyz_d50, x, y, z);
+		xyz_to_lab(parameters->white_d50, x, y, z);
+		lab_to_lch(x, y, z);
+	});
+}
+template<typename F> void kernel_lch_to_rgb_d50(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [parameters](auto &x, auto &y, auto &z){
+		lch_to_lab(x, y, z);
+		lab_to_xyz(parameters->white_d50, x, y, z);
+		transform(parameters->xyz_d50_to_rgb, x, y, z);
+		x = srgb_encode(x);
+		y = srgb_encode(y);
+		z = srgb_encode(z);
+	});
+}
+template<typename F> void kernel_rgb_get_linear(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [](auto &x, auto &y, auto &z){
+		x = srgb_decode(x);
+		y = srgb_decode(y);
+		z = srgb_decode(z);
+	});
+}
+template<typename F> void kernel_linear_get_rgb(const ColorSpan *a, ColorSpan *b, const ColorKernelParameters *parameters)
+{
+	run<F>(a, b, [](auto &x, auto &y, auto &z){
+		x = srgb_encode(x);
+		y = srgb_encode(y);
+		z = srgb_encode(z);
+	});
+}
+
+template<typename F> void kernel_distance(const ColorSpan *a, const float *b, float *distances)
+{
+	float query_r = srgb_decode(Scalar(b[0])).v, query_g = srgb_decode(Scalar(b[1])).v, query_b = srgb_decode(Scalar(b[2])).v;
+	run_distance<F>(a, distances, [query_r, query_g, query_b](auto r, auto g, auto b){
+		auto dr = srgb_decode(r) - query_r;
+		auto dg = srgb_decode(g) - query_g;
+		auto db = srgb_decode(b) - query_b;
+		return sqrt(dr * dr + dg * dg + db * db);
+	});
+}
+template<typename F> void kernel_distance_lch(const ColorSpan *a, const float *b, float *distances)
+{
+	float query_l = b[0], query_a = b[1], query_b = b[2];
+	float query_c = sqrt(Scalar(query_a * query_a + query_b * query_b)).v;
+	run_distance<F>(a, distances, [query_l, query_a, query_b, query_c](auto l, auto a, auto b){
+		auto c = sqrt(a * a + b * b);
+		auto dl = l - query_l;
+		auto dc = decltype(c)(query_c) - c;
+		auto da = a - query_a;
+		auto db = b - query_b;
+		auto chroma = dc / (c * 0.045f + 1.0f);
+		auto hue = (da * da + db * db - dc) / (c * 0.015f + 1.0f);
+		return sqrt(dl * dl + chroma * chroma + hue * hue);
+	});
+}
+
+template<typename F> ColorKernels make_color_kernels(const char *name)
+{
+	ColorKernels kernels;
+	kernels.name = name;
+	kernels.rgb_to_hsv = kernel_rgb_to_hsv<F>;
+	kernels.hsv_to_rgb = kernel_hsv_to_rgb<F>;
+	kernels.rgb_to_hsl = kernel_rgb_to_hsl<F>;
+	kernels.hsl_to_rgb = kernel_hsl_to_rgb<F>;
+	kernels.rgb_to_xyz = kernel_rgb_to_xyz<F>;
+	kernels.xyz_to_rgb = kernel_xyz_to_rgb<F>;
+	kernels.rgb_to_lab_d50 = kernel_rgb_to_lab_d50<F>;
+	kernels.lab_to_rgb_d50 = kernel_lab_to_rgb_d50<F>;
+	kernels.rgb_to_lch_d50 = kernel_rgb_to_lch_d50<F>;
+	kernels.lch_to_rgb_d50 = kernel_lch_to_rgb_d50<F>;
+	kernels.rgb_get_linear = kernel_rgb_get_linear<F>;
+	kernels.linear_get_rgb = kernel_linear_get_rgb<F>;
+	kernels.distance = kernel_distance<F>;
+	kernels.distance_lch = kernel_distance_lch<F>;
+	return kernels;
+}
+
+}
+}
+
+#endif /* GPICK_SIMD_COLOR_KERNELS_IMPL_H_ */
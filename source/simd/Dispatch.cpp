@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Dispatch.h"
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define DISPATCH_CPUID_MSVC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DISPATCH_CPUID_GCC
+#endif
+using namespace std;
+
+static const char *instruction_set_names[DISPATCH_INSTRUCTION_SET_COUNT] = {
+	"scalar",
+	"sse2",
+	"sse4.1",
+	"avx2",
+	"avx512",
+};
+
+static bool supported[DISPATCH_INSTRUCTION_SET_COUNT] = {true};
+static DispatchInstructionSet limit = DispatchInstructionSet(DISPATCH_INSTRUCTION_SET_COUNT - 1);
+static DispatchFamily *families = nullptr;
+
+#if defined(DISPATCH_CPUID_MSVC)
+static void detect_instruction_sets()
+{
+	int info[4];
+	__cpuid(info, 0);
+	int max_leaf = info[0];
+	__cpuid(info, 1);
+	bool os_saves_ymm = false, os_saves_zmm = false;
+	if (info[2] & (1 << 27)){
+		unsigned long long xcr0 = _xgetbv(0);
+		os_saves_ymm = (xcr0 & 0x06) == 0x06;
+		os_saves_zmm = (xcr0 & 0xe6) == 0xe6;
+	}
+	supported[DISPATCH_INSTRUCTION_SET_SSE2] = (info[3] & (1 << 26)) != 0;
+	supported[DISPATCH_INSTRUCTION_SET_SSE4_1] = (info[2] & (1 << 19)) != 0;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	if (max_leaf >= 7){
+		__cpuidex(info, 7, 0);
+		supported[DISPATCH_INSTRUCTION_SET_AVX2] = os_saves_ymm && fma && (info[1] & (1 << 5)) != 0;
+		supported[DISPATCH_INSTRUCTION_SET_AVX512] = os_saves_zmm && (info[1] & (1 << 16)) != 0;
+	}
+}
+#elif defined(DISPATCH_CPUID_GCC)
+static void detect_instruction_sets()
+{
+	__builtin_cpu_init();
+	supported[DISPATCH_INSTRUCTION_SET_SSE2] = __builtin_cpu_supports("sse2");
+	supported[DISPATCH_INSTRUCTION_SET_SSE4_1] = __builtin_cpu_supports("sse4.1");
+	supported[DISPATCH_INSTRUCTION_SET_AVX2] = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	supported[DISPATCH_INSTRUCTION_SET_AVX512] = __builtin_cpu_supports("avx512f");
+}
+#else
+static void detect_instruction_sets()
+{
+}
+#endif
+
+static void select_implementation(DispatchFamily *family)
+{
+	for (int i = limit; i >= 0; i--){
+		if (supported[i] && family->implementations[i]){
+			family->active = family->implementations[i];
+			family->active_instruction_set = DispatchInstructionSet(i);
+			return;
+		}
+	}
+}
+
+void dispatch_init()
+{
+	detect_instruction_sets();
+	for (DispatchFamily *family = families; family; family = family->next){
+		select_implementation(family);
+	}
+}
+
+void dispatch_register(DispatchFamily *family)
+{
+	bool registered = false;
+	for (DispatchFamily *i = families; i; i = i->next){
+		if (i == family){
+			registered = true;
+			break;
+		}
+	}
+	if (!registered){
+		family->next = families;
+		families = family;
+	}
+	select_implementation(family);
+}
+
+bool dispatch_is_supported(DispatchInstructionSet instruction_set)
+{
+	return supported[instruction_set];
+}
+
+void dispatch_set_limit(DispatchInstructionSet instruction_set)
+{
+	limit = instruction_set;
+	for (DispatchFamily *family = families; family; family = family->next){
+		select_implementation(family);
+	}
+}
+
+const char* dispatch_get_instruction_set_name(DispatchInstructionSet instruction_set)
+{
+	return instruction_set_names[instruction_set];
+}
+
+void dispatch_print(ostream &stream)
+{
+	stream << "Supported instruction sets:";
+	for (int i = 0; i < DISPATCH_INSTRUCTION_SET_COUNT; i++){
+		if (supported[i]) stream << " " << instruction_set_names[i];
+	}
+	stream << endl;
+	for (DispatchFamily *family = families; family; family = family->next){
+		stream << family->name << " kernels: " << instruction_set_names[family->active_instruction_set] << " (compiled:";
+		for (int i = 0; i < DISPATCH_INSTRUCTION_SET_COUNT; i++){
+			if (family->implementations[i]) stream << " " << instruction_set_names[i];
+		}
+		stream << ")" << endl;
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SIMD_DISPATCH_H_
+#define GPICK_SIMD_DISPATCH_H_
+
+#include <ostream>
+
+/** \file source/simd/Dispatch.h
+ * \brief Runtime selection of kernels compiled for different instruction sets.
+ *
+ * Kernel families (color conversion, distance, sampling and so on) register a table of implementations, one per instruction set.
+ * The best implementation supported by the running CPU becomes active for each family.
+ */
+
+/** \enum DispatchInstructionSet
+ * \brief Instruction sets kernels can be compiled for, ordered from the oldest to the newest.
+ */
+enum DispatchInstructionSet {
+	DISPATCH_INSTRUCTION_SET_SCALAR = 0,
+	DISPATCH_INSTRUCTION_SET_SSE2 = 1,
+	DISPATCH_INSTRUCTION_SET_SSE4_1 = 2,
+	DISPATCH_INSTRUCTION_SET_AVX2 = 3,
+	DISPATCH_INSTRUCTION_SET_AVX512 = 4,
+	DISPATCH_INSTRUCTION_SET_COUNT = 5,
+};
+
+/** \struct DispatchFamily
+ * \brief Kernel family registered in dispatch table.
+ */
+typedef struct DispatchFamily{
+	const char *name; /**< Family name */
+	const void *implementations[DISPATCH_INSTRUCTION_SET_COUNT]; /**< Kernel tables indexed by instruction set. nullptr when not compiled in. Scalar implementation is required */
+	const void *active; /**< Active kernel table */
+	DispatchInstructionSet active_instruction_set; /**< Instruction set of active kernel table */
+	struct DispatchFamily *next;
+}DispatchFamily;
+
+/**
+ * Detect instruction sets supported by CPU. Called by color_init().
+ */
+void dispatch_init();
+
+/**
+ * Add kernel family into dispatch table and select its active implementation. Registering the same family again only updates selection.
+ * @param[in] family Kernel family. Must stay valid until program exit.
+ */
+void dispatch_register(DispatchFamily *family);
+
+/**
+ * Check if CPU supports instruction set.
+ * @param[in] instruction_set Instruction set.
+ * @return True if instruction set is supported.
+ */
+bool dispatch_is_supported(DispatchInstructionSet instruction_set);
+
+/**
+ * Limit instruction sets used by kernels and reselect active implementations of all families. Intended for testing and troubleshooting.
+ * @param[in] instruction_set Newest allowed instruction set.
+ */
+void dispatch_set_limit(DispatchInstructionSet instruction_set);
+
+/**
+ * Get instruction set name.
+ * @param[in] instruction_set Instruction set.
+ * @return Instruction set name.
+ */
+const char* dispatch_get_instruction_set_name(DispatchInstructionSet instruction_set);
+
+/**
+ * Write supported instruction sets and active kernels of each family.
+ * @param[in] stream Output stream.
+ */
+void dispatch_print(std::ostream &stream);
+
+#endif /* GPICK_SIMD_DISPATCH_H_ */
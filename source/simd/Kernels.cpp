@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Kernels.h"
+#include "Dispatch.h"
+
+static DispatchFamily color_family = {"color"};
+static DispatchFamily sampler_family = {"sampler"};
+static DispatchFamily zoom_family = {"zoom"};
+static DispatchFamily quantizer_family = {"quantizer"};
+
+void kernels_init()
+{
+	static bool registered = false;
+	if (registered) return;
+	registered = true;
+	color_family.implementations[DISPATCH_INSTRUCTION_SET_SCALAR] = color_kernels_scalar();
+	color_family.implementations[DISPATCH_INSTRUCTION_SET_SSE2] = color_kernels_sse2();
+	color_family.implementations[DISPATCH_INSTRUCTION_SET_SSE4_1] = color_kernels_sse4_1();
+	color_family.implementations[DISPATCH_INSTRUCTION_SET_AVX2] = color_kernels_avx2();
+	color_family.implementations[DISPATCH_INSTRUCTION_SET_AVX512] = color_kernels_avx512();
+	dispatch_register(&color_family);
+	sampler_family.implementations[DISPATCH_INSTRUCTION_SET_SCALAR] = sampler_kernels_scalar();
+	sampler_family.implementations[DISPATCH_INSTRUCTION_SET_SSE2] = sampler_kernels_sse2();
+	dispatch_register(&sampler_family);
+	zoom_family.implementations[DISPATCH_INSTRUCTION_SET_SCALAR] = zoom_kernels_scalar();
+	zoom_family.implementations[DISPATCH_INSTRUCTION_SET_SSE2] = zoom_kernels_sse2();
+	dispatch_register(&zoom_family);
+	quantizer_family.implementations[DISPATCH_INSTRUCTION_SET_SCALAR] = quantizer_kernels_scalar();
+	quantizer_family.implementations[DISPATCH_INSTRUCTION_SET_SSE2] = quantizer_kernels_sse2();
+	dispatch_register(&quantizer_family);
+}
+
+const ColorKernels* kernels_color()
+{
+	return reinterpret_cast<const ColorKernels*>(color_family.active);
+}
+
+const SamplerKernels* kernels_sampler()
+{
+	return reinterpret_cast<const SamplerKernels*>(sampler_family.active);
+}
+
+const ZoomKernels* kernels_zoom()
+{
+	return reinterpret_cast<const ZoomKernels*>(zoom_family.active);
+}
+
+const QuantizerKernels* kernels_quantizer()
+{
+	return reinterpret_cast<const QuantizerKernels*>(quantizer_family.active);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SIMD_KERNELS_H_
+#define GPICK_SIMD_KERNELS_H_
+
+#include "ColorKernels.h"
+#include "SamplerKernels.h"
+#include "ZoomKernels.h"
+#include "QuantizerKernels.h"
+
+/** \file source/simd/Kernels.h
+ * \brief Dispatch families of all kernel tables.
+ *
+ * All families are registered at once during color_init(), so every family is listed by dispatch_print and follows
+ * dispatch_set_limit, and no family is registered while kernels are being used from other threads.
+ */
+
+/**
+ * Register all kernel families in dispatch table. Called by color_init().
+ */
+void kernels_init();
+
+/**
+ * Get active color conversion kernels.
+ * @return Kernel table.
+ */
+const ColorKernels* kernels_color();
+
+/**
+ * Get active screen sampling kernels.
+ * @return Kernel table.
+ */
+const SamplerKernels* kernels_sampler();
+
+/**
+ * Get active zoomed view kernels.
+ * @return Kernel table.
+ */
+const ZoomKernels* kernels_zoom();
+
+/**
+ * Get active quantizer kernels.
+ * @return Kernel table.
+ */
+const QuantizerKernels* kernels_quantizer();
+
+#endif /* GPICK_SIMD_KERNELS_H_ */
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SIMD_QUANTIZER_KERNELS_H_
+#define GPICK_SIMD_QUANTIZER_KERNELS_H_
+
+#include "../ColorBatch.h"
+#include <stdint.h>
+
+/** \file source/simd/QuantizerKernels.h
+ * \brief Tables of color quantization kernels compiled for different instruction sets.
+ */
+
+/**
+ * Find the nearest center of each point by squared Euclidean distance. The first center wins when distances are equal.
+ * @param[in] points Points.
+ * @param[in] centers Center components, stored as consecutive triples.
+ * @param[in] center_count Number of centers. Must not be zero.
+ * @param[out] nearest Index of the nearest center of each point.
+ * @param[out] distances Squared distance to the nearest center of each point.
+ */
+typedef void (*QuantizerNearestKernel)(const ColorSpan *points, const float *centers, size_t center_count, uint32_t *nearest, float *distances);
+
+/** \struct QuantizerKernels
+ * \brief Quantization kernels for one instruction set.
+ */
+typedef struct QuantizerKernels{
+	const char *name; /**< Instruction set name */
+	QuantizerNearestKernel nearest;
+}QuantizerKernels;
+
+/**
+ * Get portable scalar kernels.
+ * @return Kernel table.
+ */
+const QuantizerKernels* quantizer_kernels_scalar();
+
+/**
+ * Get SSE2 kernels.
+ * @return Kernel table or nullptr, when kernels were not compiled in.
+ */
+const QuantizerKernels* quantizer_kernels_sse2();
+
+#endif /* GPICK_SIMD_QUANTIZER_KERNELS_H_ */
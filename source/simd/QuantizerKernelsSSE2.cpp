@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "QuantizerKernels.h"
+#include "Vector.h"
+
+#if defined(GPICK_SIMD_SSE2)
+static void nearest(const ColorSpan *points, const float *centers, size_t center_count, uint32_t *nearest, float *distances)
+{
+	size_t count = points->count, i = 0;
+	const float *x = points->component[0], *y = points->component[1], *z = points->component[2];
+	// 4 points are compared with each center at once
+	for (; i + 4 <= count; i += 4){
+		__m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+		__m128 best_distance = _mm_set1_ps(3.402823466e+38f);
+		__m128i best = _mm_setzero_si128();
+		for (size_t j = 0; j < center_count; ++j){
+			__m128 dx = _mm_sub_ps(px, _mm_set1_ps(centers[j * 3]));
+			__m128 dy = _mm_sub_ps(py, _mm_set1_ps(centers[j * 3 + 1]));
+			__m128 dz = _mm_sub_ps(pz, _mm_set1_ps(centers[j * 3 + 2]));
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			__m128 closer = _mm_cmplt_ps(distance, best_distance);
+			best_distance = _mm_min_ps(distance, best_distance);
+			__m128i mask = _mm_castps_si128(closer);
+			best = _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi32(int32_t(j))), _mm_andnot_si128(mask, best));
+		}
+		_mm_storeu_ps(distances + i, best_distance);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(nearest + i), best);
+	}
+	for (; i < count; ++i){
+		uint32_t best = 0;
+		float best_distance = 0;
+		for (size_t j = 0; j < center_count; ++j){
+			float dx = x[i] - centers[j * 3], dy = y[i] - centers[j * 3 + 1], dz = z[i] - centers[j * 3 + 2];
+			float distance = dx * dx + dy * dy + dz * dz;
+			if (j == 0 || distance < best_distance){
+				best = j;
+				best_distance = distance;
+			}
+		}
+		nearest[i] = best;
+		distances[i] = best_distance;
+	}
+}
+#endif
+
+const QuantizerKernels* quantizer_kernels_sse2()
+{
+#if defined(GPICK_SIMD_SSE2)
+	static const QuantizerKernels kernels = {"sse2", nearest};
+	return &kernels;
+#else
+	return nullptr;
+#endif
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "QuantizerKernels.h"
+
+static void nearest(const ColorSpan *points, const float *centers, size_t center_count, uint32_t *nearest, float *distances)
+{
+	for (size_t i = 0; i < points->count; ++i){
+		float x = points->component[0][i], y = points->component[1][i], z = points->component[2][i];
+		uint32_t best = 0;
+		float best_distance = 0;
+		for (size_t j = 0; j < center_count; ++j){
+			float dx = x - centers[j * 3], dy = y - centers[j * 3 + 1], dz = z - centers[j * 3 + 2];
+			float distance = dx * dx + dy * dy + dz * dz;
+			if (j == 0 || distance < best_distance){
+				best = j;
+				best_distance = distance;
+			}
+		}
+		nearest[i] = best;
+		distances[i] = best_distance;
+	}
+}
+
+const QuantizerKernels* quantizer_kernels_scalar()
+{
+	static const QuantizerKernels kernels = {"scalar", nearest};
+	return &kernels;
+}
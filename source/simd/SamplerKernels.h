@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SIMD_SAMPLER_KERNELS_H_
+#define GPICK_SIMD_SAMPLER_KERNELS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** \file source/simd/SamplerKernels.h
+ * \brief Tables of screen sampling kernels compiled for different instruction sets.
+ */
+
+/** Maximum pixel count of a single weighted sum call. Keeps 32-bit partial sums from overflowing. */
+const size_t SAMPLER_KERNEL_MAX_COUNT = 512;
+
+/**
+ * Add weighted 8-bit RGB pixels into sums.
+ * @param[in] pixels Packed RGB pixels.
+ * @param[in] weights Pixel weights in [0, 32767] range, repeated for each channel.
+ * @param[in] count Pixel count, at most SAMPLER_KERNEL_MAX_COUNT.
+ * @param[in,out] sums Red, green and blue sums.
+ */
+typedef void (*SamplerWeightedSumKernel)(const uint8_t *pixels, const uint16_t *weights, size_t count, uint64_t sums[3]);
+
+/** \struct SamplerKernels
+ * \brief Sampling kernels for one instruction set.
+ */
+typedef struct SamplerKernels{
+	const char *name; /**< Instruction set name */
+	SamplerWeightedSumKernel weighted_sum;
+}SamplerKernels;
+
+/**
+ * Get portable scalar kernels.
+ * @return Kernel table.
+ */
+const SamplerKernels* sampler_kernels_scalar();
+
+/**
+ * Get SSE2 kernels.
+ * @return Kernel table or nullptr, when kernels were not compiled in.
+ */
+const SamplerKernels* sampler_kernels_sse2();
+
+#endif /* GPICK_SIMD_SAMPLER_KERNELS_H_ */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SamplerKernels.h"
+#include "Vector.h"
+
+#if defined(GPICK_SIMD_SSE2)
+static inline void multiply_add(__m128i pixels, __m128i weights, __m128i &low, __m128i &high)
+{
+	__m128i product_low = _mm_mullo_epi16(pixels, weights);
+	__m128i product_high = _mm_mulhi_epu16(pixels, weights);
+	low = _mm_add_epi32(low, _mm_unpacklo_epi16(product_low, product_high));
+	high = _mm_add_epi32(high, _mm_unpackhi_epi16(product_low, product_high));
+}
+static void weighted_sum(const uint8_t *pixels, const uint16_t *weights, size_t count, uint64_t sums[3])
+{
+	// 8 pixels (24 values) are processed per iteration. Lane i of accumulator k always holds channel (k * 4 + i) % 3
+	__m128i zero = _mm_setzero_si128();
+	__m128i accumulators[6] = {zero, zero, zero, zero, zero, zero};
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8, pixels += 24, weights += 24){
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+		__m128i tail = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels + 16));
+		multiply_add(_mm_unpacklo_epi8(bytes, zero), _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights)), accumulators[0], accumulators[1]);
+		multiply_add(_mm_unpackhi_epi8(bytes, zero), _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + 8)), accumulators[2], accumulators[3]);
+		multiply_add(_mm_unpacklo_epi8(tail, zero), _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + 16)), accumulators[4], accumulators[5]);
+	}
+	uint32_t lanes[24];
+	for (int k = 0; k < 6; ++k){
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + k * 4), accumulators[k]);
+	}
+	uint32_t channels[3] = {0, 0, 0};
+	for (int k = 0; k < 24; ++k){
+		channels[k % 3] += lanes[k];
+	}
+	for (; i < count; ++i, pixels += 3, weights += 3){
+		channels[0] += pixels[0] * uint32_t(weights[0]);
+		channels[1] += pixels[1] * uint32_t(weights[1]);
+		channels[2] += pixels[2] * uint32_t(weights[2]);
+	}
+	sums[0] += channels[0];
+	sums[1] += channels[1];
+	sums[2] += channels[2];
+}
+#endif
+
+const SamplerKernels* sampler_kernels_sse2()
+{
+#if defined(GPICK_SIMD_SSE2)
+	static const SamplerKernels kernels = {"sse2", weighted_sum};
+	return &kernels;
+#else
+	return nullptr;
+#endif
+}
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_SIMD_VECTOR_H_
+#define GPICK_SIMD_VECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#ifdef _MSC_VER
+#include <math.h>
+#endif
+
+// Instruction sets enabled by compiler flags of the translation unit including this header
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GPICK_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_1__)
+#define GPICK_SIMD_SSE4_1
+#include <smmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define GPICK_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__AVX512F__)
+#define GPICK_SIMD_AVX512
+#include <immintrin.h>
+#endif
+
+/** \file source/simd/Vector.h
+ * \brief Thin wrappers around scalar and SIMD float registers used by templated color kernels.
+ *
+ * Every wrapper provides the same set of operations, so that a kernel written once can be instantiated for any instruction set.
+ * Wrappers live in an anonymous namespace: each translation unit including this header gets its own copy compiled with its
+ * own instruction set flags, which prevents the linker from merging, for example, an AVX2 instance into SSE2 code.
+ */
+
+namespace simd {
+namespace {
+
+/** \struct Scalar
+ * \brief Single float value. Used for scalar fallback and for processing tails of color spans.
+ */
+struct Scalar{
+	typedef bool Mask;
+	static const size_t width = 1;
+	float v;
+	Scalar(){}
+	Scalar(float value): v(value) {}
+	static Scalar load(const float *p){ return Scalar(*p); }
+	void store(float *p) const { *p = v; }
+};
+inline Scalar operator+(Scalar a, Scalar b){ return a.v + b.v; }
+inline Scalar operator-(Scalar a, Scalar b){ return a.v - b.v; }
+inline Scalar operator*(Scalar a, Scalar b){ return a.v * b.v; }
+inline Scalar operator/(Scalar a, Scalar b){ return a.v / b.v; }
+inline bool operator<(Scalar a, Scalar b){ return a.v < b.v; }
+inline bool operator>(Scalar a, Scalar b){ return a.v > b.v; }
+inline bool operator<=(Scalar a, Scalar b){ return a.v <= b.v; }
+inline bool operator>=(Scalar a, Scalar b){ return a.v >= b.v; }
+inline bool operator==(Scalar a, Scalar b){ return a.v == b.v; }
+inline bool operator!=(Scalar a, Scalar b){ return a.v != b.v; }
+inline Scalar select(bool mask, Scalar a, Scalar b){ return mask ? a : b; }
+inline Scalar min(Scalar a, Scalar b){ return a.v < b.v ? a : b; }
+inline Scalar max(Scalar a, Scalar b){ return a.v > b.v ? a : b; }
+// Builtins are expanded in place, unlike inline std functions, which could be merged with copies compiled for other instruction sets.
+// MSVC has no such builtins, but treats C functions as intrinsics or calls them from the runtime library.
+#ifdef _MSC_VER
+inline Scalar sqrt(Scalar a){ return sqrtf(a.v); }
+inline Scalar abs(Scalar a){ return fabsf(a.v); }
+inline Scalar floor(Scalar a){ return floorf(a.v); }
+#else
+inline Scalar sqrt(Scalar a){ return __builtin_sqrtf(a.v); }
+inline Scalar abs(Scalar a){ return __builtin_fabsf(a.v); }
+inline Scalar floor(Scalar a){ return __builtin_floorf(a.v); }
+#endif
+/**
+ * Split positive normal value into mantissa and exponent.
+ * @param[in] x Value.
+ * @param[out] exponent Exponent, so that x = mantissa * 2^exponent.
+ * @return Mantissa in [0.5, 1) range.
+ */
+inline Scalar split_exponent(Scalar x, Scalar &exponent)
+{
+	uint32_t bits;
+	memcpy(&bits, &x.v, sizeof(bits));
+	exponent = float(int32_t(bits >> 23) - 126);
+	bits = (bits & 0x807fffff) | 0x3f000000;
+	float mantissa;
+	memcpy(&mantissa, &bits, sizeof(mantissa));
+	return mantissa;
+}
+/**
+ * Calculate 2^n for integral n in [-126, 127] range.
+ */
+inline Scalar exp2i(Scalar n)
+{
+	uint32_t bits = uint32_t(int32_t(n.v) + 127) << 23;
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+#if defined(GPICK_SIMD_SSE2)
+/** \struct Float4
+ * \brief Four float values in a SSE register.
+ */
+struct Float4{
+	struct Mask{
+		__m128 v;
+		Mask(__m128 value): v(value) {}
+	};
+	static const size_t width = 4;
+	__m128 v;
+	Float4(){}
+	Float4(__m128 value): v(value) {}
+	Float4(float value): v(_mm_set1_ps(value)) {}
+	static Float4 load(const float *p){ return _mm_loadu_ps(p); }
+	void store(float *p) const { _mm_storeu_ps(p, v); }
+};
+inline Float4 operator+(Float4 a, Float4 b){ return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b){ return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b){ return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator/(Float4 a, Float4 b){ return _mm_div_ps(a.v, b.v); }
+inline Float4::Mask operator<(Float4 a, Float4 b){ return _mm_cmplt_ps(a.v, b.v); }
+inline Float4::Mask operator>(Float4 a, Float4 b){ return _mm_cmpgt_ps(a.v, b.v); }
+inline Float4::Mask operator<=(Float4 a, Float4 b){ return _mm_cmple_ps(a.v, b.v); }
+inline Float4::Mask operator>=(Float4 a, Float4 b){ return _mm_cmpge_ps(a.v, b.v); }
+inline Float4::Mask operator==(Float4 a, Float4 b){ return _mm_cmpeq_ps(a.v, b.v); }
+inline Float4::Mask operator!=(Float4 a, Float4 b){ return _mm_cmpneq_ps(a.v, b.v); }
+inline Float4::Mask operator&&(Float4::Mask a, Float4::Mask b){ return _mm_and_ps(a.v, b.v); }
+inline Float4::Mask operator||(Float4::Mask a, Float4::Mask b){ return _mm_or_ps(a.v, b.v); }
+inline Float4 select(Float4::Mask mask, Float4 a, Float4 b)
+{
+#if defined(GPICK_SIMD_SSE4_1)
+	return _mm_blendv_ps(b.v, a.v, mask.v);
+#else
+	return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+#endif
+}
+inline Float4 min(Float4 a, Float4 b){ return _mm_min_ps(a.v, b.v); }
+inline Float4 max(Float4 a, Float4 b){ return _mm_max_ps(a.v, b.v); }
+inline Float4 sqrt(Float4 a){ return _mm_sqrt_ps(a.v); }
+inline Float4 abs(Float4 a){ return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline Float4 floor(Float4 a)
+{
+#if defined(GPICK_SIMD_SSE4_1)
+	return _mm_floor_ps(a.v);
+#else
+	__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+	return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.0f)));
+#endif
+}
+inline Float4 split_exponent(Float4 x, Float4 &exponent)
+{
+	__m128i bits = _mm_castps_si128(x.v);
+	exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+	return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x807fffff)), _mm_set1_epi32(0x3f000000)));
+}
+inline Float4 exp2i(Float4 n)
+{
+	return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n.v), _mm_set1_epi32(127)), 23));
+}
+#endif
+
+#if defined(GPICK_SIMD_AVX2)
+/** \struct Float8
+ * \brief Eight float values in an AVX register.
+ */
+struct Float8{
+	struct Mask{
+		__m256 v;
+		Mask(__m256 value): v(value) {}
+	};
+	static const size_t width = 8;
+	__m256 v;
+	Float8(){}
+	Float8(__m256 value): v(value) {}
+	Float8(float value): v(_mm256_set1_ps(value)) {}
+	static Float8 load(const float *p){ return _mm256_loadu_ps(p); }
+	void store(float *p) const { _mm256_storeu_ps(p, v); }
+};
+inline Float8 operator+(Float8 a, Float8 b){ return _mm256_add_ps(a.v, b.v); }
+inline Float8 operator-(Float8 a, Float8 b){ return _mm256_sub_ps(a.v, b.v); }
+inline Float8 operator*(Float8 a, Float8 b){ return _mm256_mul_ps(a.v, b.v); }
+inline Float8 operator/(Float8 a, Float8 b){ return _mm256_div_ps(a.v, b.v); }
+inline Float8::Mask operator<(Float8 a, Float8 b){ return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline Float8::Mask operator>(Float8 a, Float8 b){ return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline Float8::Mask operator<=(Float8 a, Float8 b){ return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+inline Float8::Mask operator>=(Float8 a, Float8 b){ return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+inline Float8::Mask operator==(Float8 a, Float8 b){ return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ); }
+inline Float8::Mask operator!=(Float8 a, Float8 b){ return _mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ); }
+inline Float8::Mask operator&&(Float8::Mask a, Float8::Mask b){ return _mm256_and_ps(a.v, b.v); }
+inline Float8::Mask operator||(Float8::Mask a, Float8::Mask b){ return _mm256_or_ps(a.v, b.v); }
+inline Float8 select(Float8::Mask mask, Float8 a, Float8 b){ return _mm256_blendv_ps(b.v, a.v, mask.v); }
+inline Float8 min(Float8 a, Float8 b){ return _mm256_min_ps(a.v, b.v); }
+inline Float8 max(Float8 a, Float8 b){ return _mm256_max_ps(a.v, b.v); }
+inline Float8 sqrt(Float8 a){ return _mm256_sqrt_ps(a.v); }
+inline Float8 abs(Float8 a){ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+inline Float8 floor(Float8 a){ return _mm256_floor_ps(a.v); }
+inline Float8 split_exponent(Float8 x, Float8 &exponent)
+{
+	__m256i bits = _mm256_castps_si256(x.v);
+	exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+	return _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x807fffff)), _mm256_set1_epi32(0x3f000000)));
+}
+inline Float8 exp2i(Float8 n)
+{
+	return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n.v), _mm256_set1_epi32(127)), 23));
+}
+#endif
+
+#if defined(GPICK_SIMD_AVX512)
+/** \struct Float16
+ * \brief Sixteen float values in an AVX-512 register.
+ */
+struct Float16{
+	struct Mask{
+		__mmask16 v;
+		Mask(__mmask16 value): v(value) {}
+	};
+	static const size_t width = 16;
+	__m512 v;
+	Float16(){}
+	Float16(__m512 value): v(value) {}
+	Float16(float value): v(_mm512_set1_ps(value)) {}
+	static Float16 load(const float *p){ return _mm512_loadu_ps(p); }
+	void store(float *p) const { _mm512_storeu_ps(p, v); }
+};
+inline Float16 operator+(Float16 a, Float16 b){ return _mm512_add_ps(a.v, b.v); }
+inline Float16 operator-(Float16 a, Float16 b){ return _mm512_sub_ps(a.v, b.v); }
+inline Float16 operator*(Float16 a, Float16 b){ return _mm512_mul_ps(a.v, b.v); }
+inline Float16 operator/(Float16 a, Float16 b){ return _mm512_div_ps(a.v, b.v); }
+inline Float16::Mask operator<(Float16 a, Float16 b){ return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+inline Float16::Mask operator>(Float16 a, Float16 b){ return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ); }
+inline Float16::Mask operator<=(Float16 a, Float16 b){ return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ); }
+inline Float16::Mask operator>=(Float16 a, Float16 b){ return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ); }
+inline Float16::Mask operator==(Float16 a, Float16 b){ return _mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ); }
+inline Float16::Mask operator!=(Float16 a, Float16 b){ return _mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_UQ); }
+inline Float16::Mask operator&&(Float16::Mask a, Float16::Mask b){ return __mmask16(a.v & b.v); }
+inline Float16::Mask operator||(Float16::Mask a, Float16::Mask b){ return __mmask16(a.v | b.v); }
+inline Float16 select(Float16::Mask mask, Float16 a, Float16 b){ return _mm512_mask_blend_ps(mask.v, b.v, a.v); }
+inline Float16 min(Float16 a, Float16 b){ return _mm512_min_ps(a.v, b.v); }
+inline Float16 max(Float16 a, Float16 b){ return _mm512_max_ps(a.v, b.v); }
+inline Float16 sqrt(Float16 a){ return _mm512_sqrt_ps(a.v); }
+inline Float16 abs(Float16 a){ return _mm512_abs_ps(a.v); }
+inline Float16 floor(Float16 a){ return _mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+inline Float16 split_exponent(Float16 x, Float16 &exponent)
+{
+	__m512i bits = _mm512_castps_si512(x.v);
+	exponent = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+	return _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x807fffff)), _mm512_set1_epi32(0x3f000000)));
+}
+inline Float16 exp2i(Float16 n)
+{
+	return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvttps_epi32(n.v), _mm512_set1_epi32(127)), 23));
+}
+#endif
+
+}
+}
+
+#endif /* GPICK_SIMD_VECTOR_H_ */
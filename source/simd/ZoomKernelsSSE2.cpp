@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2009-2016, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ZoomKernels.h"
+#include "Vector.h"
+
+#if defined(GPICK_SIMD_SSE2)
+static void expand_row(const uint8_t *pixels, const uint16_t *runs, size_t count, uint32_t *destination)
+{
+	// each pixel is written 4 at a time, overlapping stores are overwritten by the next pixel
+	for (size_t i = 0; i < count; ++i, pixels += 3){
+		__m128i value = _mm_set1_epi32(0xff000000 | (uint32_t(pixels[0]) << 16) | (uint32_t(pixels[1]) << 8) | pixels[2]);
+		uint32_t *end = destination + runs[i];
+		uint32_t *position = destination;
+		do{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(position), value);
+			position += 4;
+		}while (position < end);
+		destination = end;
+	}
+}
+#endif
+
+const ZoomKernels* zoom_kernels_sse2()
+{
+#if defined(GPICK_SIMD_SSE2)
+	static const ZoomKernels kernels = {"sse2", expand_row};
+	return &kernels;
+#else
+	return nullptr;
+#endif
+}
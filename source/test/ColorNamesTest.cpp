@@ -0,0 +1,146 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE color_names
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
+#include "Color.h"
+#include "color_names/ColorNames.h"
+using namespace std;
+
+struct ColorNamesFixture
+{
+	ColorNames *color_names;
+	mt19937 random;
+	ColorNamesFixture():
+		random(1)
+	{
+		color_init();
+		char filename[] = "/tmp/gpick_color_names_XXXXXX";
+		int fd = mkstemp(filename);
+		BOOST_REQUIRE(fd != -1);
+		close(fd);
+		{
+			ofstream file(filename);
+			uniform_int_distribution<int> component(0, 255);
+			for (int i = 0; i < 2000; i++){
+				file << component(random) << " " << component(random) << " " << component(random) << " Color " << i << "\n";
+			}
+		}
+		color_names = color_names_new();
+		BOOST_REQUIRE_EQUAL(color_names_load_from_file(color_names, filename), 0);
+		unlink(filename);
+	}
+	~ColorNamesFixture()
+	{
+		color_names_destroy(color_names);
+	}
+	Color random_color()
+	{
+		uniform_real_distribution<float> component(0, 1);
+		Color color;
+		color_set(&color, component(random), component(random), component(random));
+		return color;
+	}
+	vector<float> brute_force(const Color *color)
+	{
+		Color query;
+		color_rgb_to_lab_d50(color, &query);
+		vector<float> distances;
+		// distance is not symmetric, named color is the reference color like in color names search
+		for (size_t i = 0; i < color_names->color_count; i++)
+			distances.push_back(color_distance_lch(&color_names->colors[i].color, &query));
+		sort(distances.begin(), distances.end());
+		return distances;
+	}
+	static Color quantize(const Color *color)
+	{
+		Color result;
+		for (int i = 0; i < 3; i++)
+			result.ma[i] = int(color->ma[i] * 255 + 0.5f) / 255.0f;
+		return result;
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(color_names, ColorNamesFixture)
+
+BOOST_AUTO_TEST_CASE(nearest)
+{
+	for (int i = 0; i < 1000; i++){
+		Color color = random_color();
+		vector<float> expected = brute_force(&color);
+		ColorNameMatch match;
+		BOOST_REQUIRE_EQUAL(color_names_find_nearest(color_names, &color, 1, &match), 1);
+		BOOST_CHECK_SMALL(match.distance - expected[0], 1e-4f);
+	}
+}
+BOOST_AUTO_TEST_CASE(k_nearest)
+{
+	const size_t k = 8;
+	for (int i = 0; i < 200; i++){
+		Color color = random_color();
+		vector<float> expected = brute_force(&color);
+		ColorNameMatch matches[k];
+		BOOST_REQUIRE_EQUAL(color_names_find_nearest(color_names, &color, k, matches), k);
+		for (size_t j = 0; j < k; j++){
+			BOOST_CHECK_SMALL(matches[j].distance - expected[j], 1e-4f);
+			if (j > 0) BOOST_CHECK(matches[j - 1].distance <= matches[j].distance);
+		}
+	}
+}
+BOOST_AUTO_TEST_CASE(cache)
+{
+	vector<Color> colors;
+	for (int i = 0; i < 500; i++)
+		colors.push_back(random_color());
+	vector<string> expected(colors.size()), expected_postfix(colors.size());
+	color_names_get_batch(color_names, &colors.front(), colors.size(), false, &expected.front());
+	color_names_get_batch(color_names, &colors.front(), colors.size(), true, &expected_postfix.front());
+	uint64_t lookups, hits, previous_lookups, previous_hits;
+	color_names_get_cache_statistics(color_names, &previous_lookups, &previous_hits);
+	for (size_t i = 0; i < colors.size(); i++){
+		// random colors are not quantized to the same 24-bit color, so the first lookup of each is a miss
+		BOOST_CHECK_EQUAL(color_names_get(color_names, &colors[i], false), expected[i]);
+		color_names_get_cache_statistics(color_names, &lookups, &hits);
+		BOOST_CHECK_EQUAL(lookups, previous_lookups + 1);
+		BOOST_CHECK_EQUAL(hits, previous_hits);
+		// hit returns name and distance of the first lookup, so imprecision postfix does not depend on the flag of the first lookup
+		BOOST_CHECK_EQUAL(color_names_get(color_names, &colors[i], true), expected_postfix[i]);
+		color_names_get_cache_statistics(color_names, &previous_lookups, &previous_hits);
+		BOOST_CHECK_EQUAL(previous_lookups, lookups + 1);
+		BOOST_CHECK_EQUAL(previous_hits, hits + 1);
+	}
+	// cached results are found for the quantized color, so they match the nearest name of it
+	for (size_t i = 0; i < colors.size(); i++){
+		Color quantized = quantize(&colors[i]);
+		ColorNameMatch match;
+		BOOST_REQUIRE_EQUAL(color_names_find_nearest(color_names, &quantized, 1, &match), 1);
+		BOOST_CHECK_EQUAL(color_names_get(color_names, &colors[i], false), match.name);
+	}
+	// filling the cache with many other colors evicts old entries, which must be found again with the same result
+	for (int i = 0; i < 20000; i++){
+		Color color = random_color();
+		color_names_get(color_names, &color, false);
+	}
+	color_names_get_cache_statistics(color_names, &previous_lookups, &previous_hits);
+	for (size_t i = 0; i < colors.size(); i++)
+		BOOST_CHECK_EQUAL(color_names_get(color_names, &colors[i], false), expected[i]);
+	color_names_get_cache_statistics(color_names, &lookups, &hits);
+	BOOST_CHECK_EQUAL(lookups, previous_lookups + colors.size());
+	BOOST_CHECK(hits - previous_hits < colors.size());
+}
+BOOST_AUTO_TEST_CASE(empty)
+{
+	ColorNames *empty = color_names_new();
+	Color color = random_color();
+	ColorNameMatch match;
+	BOOST_CHECK_EQUAL(color_names_find_nearest(empty, &color, 1, &match), 0);
+	BOOST_CHECK_EQUAL(color_names_get(empty, &color, true), "");
+	color_names_destroy(empty);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
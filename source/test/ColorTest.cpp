@@ -0,0 +1,157 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE color
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <cmath>
+#include "Color.h"
+#include "ColorBatch.h"
+#include "simd/Dispatch.h"
+using namespace std;
+
+struct ColorFixture
+{
+	vector<Color> colors;
+	ColorFixture()
+	{
+		color_init();
+		const int steps = 17;
+		for (int r = 0; r < steps; r++){
+			for (int g = 0; g < steps; g++){
+				for (int b = 0; b < steps; b++){
+					Color color;
+					color_set(&color, r / float(steps - 1), g / float(steps - 1), b / float(steps - 1));
+					colors.push_back(color);
+				}
+			}
+		}
+	}
+	static float difference(float a, float b, float period)
+	{
+		float d = fabs(a - b);
+		if (period > 0 && d > period / 2) d = period - d;
+		return d;
+	}
+	void check(void (*batch)(const ColorSpan*, ColorSpan*), void (*single)(const Color*, Color*), const vector<Color> &input, const float tolerance[3], const float period[3])
+	{
+		for (int instruction_set = 0; instruction_set < DISPATCH_INSTRUCTION_SET_COUNT; instruction_set++){
+			if (!dispatch_is_supported(DispatchInstructionSet(instruction_set))) continue;
+			dispatch_set_limit(DispatchInstructionSet(instruction_set));
+			ColorSpan *span = color_span_new(input.size());
+			color_span_load(&input.front(), input.size(), span);
+			batch(span, span);
+			vector<Color> output(input.size());
+			color_span_store(span, &output.front());
+			color_span_destroy(span);
+			for (size_t i = 0; i < input.size(); i++){
+				Color expected;
+				single(&input[i], &expected);
+				for (int j = 0; j < 3; j++){
+					BOOST_CHECK_SMALL(difference(output[i].ma[j], expected.ma[j], period[j]), tolerance[j]);
+				}
+			}
+		}
+		dispatch_set_limit(DispatchInstructionSet(DISPATCH_INSTRUCTION_SET_COUNT - 1));
+	}
+	void check_distance(void (*batch)(const ColorSpan*, const Color*, float*), float (*single)(const Color*, const Color*), const vector<Color> &input, float tolerance)
+	{
+		for (int instruction_set = 0; instruction_set < DISPATCH_INSTRUCTION_SET_COUNT; instruction_set++){
+			if (!dispatch_is_supported(DispatchInstructionSet(instruction_set))) continue;
+			dispatch_set_limit(DispatchInstructionSet(instruction_set));
+			ColorSpan *span = color_span_new(input.size());
+			color_span_load(&input.front(), input.size(), span);
+			vector<float> distances(input.size());
+			for (size_t i = 0; i < input.size(); i += 97){
+				batch(span, &input[i], &distances.front());
+				for (size_t j = 0; j < input.size(); j++){
+					BOOST_CHECK_SMALL(distances[j] - single(&input[j], &input[i]), tolerance);
+				}
+			}
+			color_span_destroy(span);
+		}
+		dispatch_set_limit(DispatchInstructionSet(DISPATCH_INSTRUCTION_SET_COUNT - 1));
+	}
+	vector<Color> convert(void (*single)(const Color*, Color*))
+	{
+		vector<Color> result(colors.size());
+		for (size_t i = 0; i < colors.size(); i++)
+			single(&colors[i], &result[i]);
+		return result;
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(batch, ColorFixture)
+
+BOOST_AUTO_TEST_CASE(hsv)
+{
+	const float tolerance[3] = {1e-5f, 1e-5f, 1e-5f}, period[3] = {1, 0, 0};
+	check(color_batch_rgb_to_hsv, color_rgb_to_hsv, colors, tolerance, period);
+	check(color_batch_hsv_to_rgb, color_hsv_to_rgb, convert(color_rgb_to_hsv), tolerance, period);
+}
+BOOST_AUTO_TEST_CASE(hsl)
+{
+	const float tolerance[3] = {1e-5f, 1e-5f, 1e-5f}, period[3] = {1, 0, 0};
+	check(color_batch_rgb_to_hsl, color_rgb_to_hsl, colors, tolerance, period);
+	check(color_batch_hsl_to_rgb, color_hsl_to_rgb, convert(color_rgb_to_hsl), tolerance, period);
+}
+BOOST_AUTO_TEST_CASE(linear)
+{
+	const float tolerance[3] = {1e-5f, 1e-5f, 1e-5f}, period[3] = {0, 0, 0};
+	check(color_batch_rgb_get_linear, color_rgb_get_linear, colors, tolerance, period);
+	check(color_batch_linear_get_rgb, color_linear_get_rgb, colors, tolerance, period);
+}
+BOOST_AUTO_TEST_CASE(lab)
+{
+	const float tolerance[3] = {1e-3f, 1e-3f, 1e-3f}, period[3] = {0, 0, 0};
+	check(color_batch_rgb_to_lab_d50, color_rgb_to_lab_d50, colors, tolerance, period);
+	check(color_batch_lab_to_rgb_d50, color_lab_to_rgb_d50, convert(color_rgb_to_lab_d50), tolerance, period);
+}
+BOOST_AUTO_TEST_CASE(lch)
+{
+	const float tolerance[3] = {1e-3f, 1e-3f, 1e-2f}, period[3] = {0, 0, 360};
+	vector<Color> chromatic;
+	for (size_t i = 0; i < colors.size(); i++){
+		Color lch;
+		color_rgb_to_lch_d50(&colors[i], &lch);
+		if (lch.lch.C > 1) chromatic.push_back(colors[i]);
+	}
+	check(color_batch_rgb_to_lch_d50, color_rgb_to_lch_d50, chromatic, tolerance, period);
+	check(color_batch_lch_to_rgb_d50, color_lch_to_rgb_d50, convert(color_rgb_to_lch_d50), tolerance, period);
+}
+
+BOOST_AUTO_TEST_CASE(distance)
+{
+	check_distance(color_batch_distance, color_distance, colors, 1e-5f);
+	check_distance(color_batch_distance_lch, color_distance_lch, convert(color_rgb_to_lab_d50), 1e-2f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_CASE(transfer_tables)
+{
+	color_init();
+	vector<Color> colors;
+	for (int i = 0; i < 256; i++){
+		Color color;
+		color_set(&color, i, (i * 7) & 0xff, 0xff - i);
+		colors.push_back(color);
+	}
+	for (int i = 0; i <= 10000; i++){
+		Color color;
+		color_set(&color, i / 10000.0f, (i * i % 10007) / 10007.0f, 1 - i / 10000.0f);
+		colors.push_back(color);
+	}
+	for (size_t i = 0; i < colors.size(); i++){
+		Color fast_linear, exact_linear, fast_rgb, exact_rgb;
+		color_set_transfer_mode(COLOR_TRANSFER_FAST);
+		color_rgb_get_linear(&colors[i], &fast_linear);
+		color_linear_get_rgb(&colors[i], &fast_rgb);
+		color_set_transfer_mode(COLOR_TRANSFER_EXACT);
+		color_rgb_get_linear(&colors[i], &exact_linear);
+		color_linear_get_rgb(&colors[i], &exact_rgb);
+		for (int j = 0; j < 3; j++){
+			BOOST_CHECK_SMALL(fast_linear.ma[j] - exact_linear.ma[j], 2e-6f);
+			BOOST_CHECK_SMALL(fast_rgb.ma[j] - exact_rgb.ma[j], 2e-6f);
+		}
+	}
+	color_set_transfer_mode(COLOR_TRANSFER_FAST);
+}
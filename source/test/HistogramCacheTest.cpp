@@ -0,0 +1,176 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE histogram_cache
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "HistogramCache.h"
+using namespace std;
+
+struct HistogramCacheFixture
+{
+	string directory;
+	string image;
+	ColorHistogram *histogram;
+	HistogramCacheKey key;
+	HistogramCacheFixture()
+	{
+		char name[] = "/tmp/gpick_histogram_cache_XXXXXX";
+		BOOST_REQUIRE(mkdtemp(name));
+		directory = name;
+		image = directory + "/image.bin";
+		mt19937 random(1);
+		uniform_int_distribution<int> component(0, 255);
+		vector<uint8_t> pixels(300 * 200 * 3);
+		for (auto &value: pixels)
+			value = component(random);
+		ofstream(image, ios::binary).write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+		histogram = color_histogram_new();
+		color_histogram_add_rows(histogram, pixels.data(), 300, 200, 300 * 3, 3);
+		BOOST_REQUIRE(histogram_cache_get_key(image.c_str(), &key, nullptr));
+	}
+	~HistogramCacheFixture()
+	{
+		color_histogram_destroy(histogram);
+		vector<string> names = list();
+		for (auto &name: names)
+			unlink((directory + "/" + name).c_str());
+		unlink(image.c_str());
+		rmdir(directory.c_str());
+	}
+	vector<string> list()
+	{
+		vector<string> names;
+		DIR *dir = opendir(directory.c_str());
+		if (!dir) return names;
+		while (dirent *entry = readdir(dir)){
+			string name = entry->d_name;
+			if (name != "." && name != ".." && name != "image.bin")
+				names.push_back(name);
+		}
+		closedir(dir);
+		return names;
+	}
+	string entry_path(const HistogramCacheKey &entry_key)
+	{
+		return directory + "/" + entry_key.hash + ".hst";
+	}
+	void set_modification_time(const string &path, time_t time)
+	{
+		struct utimbuf times;
+		times.actime = times.modtime = time;
+		BOOST_REQUIRE_EQUAL(utime(path.c_str(), &times), 0);
+	}
+	static bool same(const ColorHistogram *a, const ColorHistogram *b)
+	{
+		return color_histogram_get_pixel_count(a) == color_histogram_get_pixel_count(b) && memcmp(color_histogram_get_bins(a), color_histogram_get_bins(b), sizeof(ColorHistogramBin) * COLOR_HISTOGRAM_SIZE) == 0;
+	}
+	bool load(const HistogramCacheKey &entry_key)
+	{
+		ColorHistogram *loaded = color_histogram_new();
+		bool result = histogram_cache_load(directory.c_str(), &entry_key, loaded);
+		if (result)
+			BOOST_CHECK(same(loaded, histogram));
+		else
+			BOOST_CHECK_EQUAL(color_histogram_get_pixel_count(loaded), 0);
+		color_histogram_destroy(loaded);
+		return result;
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(histogram_cache, HistogramCacheFixture)
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+	BOOST_CHECK_EQUAL(strlen(key.hash), 64);
+	BOOST_CHECK_EQUAL(key.size, 300 * 200 * 3);
+	BOOST_CHECK(!load(key));
+	BOOST_REQUIRE(histogram_cache_store(directory.c_str(), &key, histogram, 1 << 30));
+	BOOST_CHECK(load(key));
+	// only the entry is left, temporary file is renamed
+	vector<string> names = list();
+	BOOST_REQUIRE_EQUAL(names.size(), 1);
+	BOOST_CHECK_EQUAL(names[0], string(key.hash) + ".hst");
+}
+BOOST_AUTO_TEST_CASE(cancelled_key)
+{
+	atomic<bool> cancelled(true);
+	HistogramCacheKey cancelled_key;
+	BOOST_CHECK(!histogram_cache_get_key(image.c_str(), &cancelled_key, &cancelled));
+}
+BOOST_AUTO_TEST_CASE(stale_entries)
+{
+	BOOST_REQUIRE(histogram_cache_store(directory.c_str(), &key, histogram, 1 << 30));
+	// entry of a file with the same contents, but different size or modification time is not used
+	HistogramCacheKey other = key;
+	other.size++;
+	BOOST_CHECK(!load(other));
+	other = key;
+	other.modification_time++;
+	BOOST_CHECK(!load(other));
+	BOOST_CHECK(load(key));
+	// entries written by a different version are not used
+	{
+		fstream file(entry_path(key), ios::in | ios::out | ios::binary);
+		uint32_t version;
+		file.seekg(8);
+		file.read(reinterpret_cast<char*>(&version), sizeof(version));
+		version++;
+		file.seekp(8);
+		file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	}
+	BOOST_CHECK(!load(key));
+	// truncated entries are not used
+	BOOST_REQUIRE(histogram_cache_store(directory.c_str(), &key, histogram, 1 << 30));
+	struct stat entry_stat;
+	BOOST_REQUIRE_EQUAL(stat(entry_path(key).c_str(), &entry_stat), 0);
+	BOOST_REQUIRE_EQUAL(truncate(entry_path(key).c_str(), entry_stat.st_size - 1), 0);
+	BOOST_CHECK(!load(key));
+}
+BOOST_AUTO_TEST_CASE(eviction)
+{
+	vector<HistogramCacheKey> keys;
+	for (int i = 0; i < 5; i++){
+		HistogramCacheKey entry_key = key;
+		snprintf(entry_key.hash, sizeof(entry_key.hash), "entry%d", i);
+		BOOST_REQUIRE(histogram_cache_store(directory.c_str(), &entry_key, histogram, 1 << 30));
+		set_modification_time(entry_path(entry_key), 1000 + i);
+		keys.push_back(entry_key);
+	}
+	struct stat entry_stat;
+	BOOST_REQUIRE_EQUAL(stat(entry_path(keys[0]).c_str(), &entry_stat), 0);
+	uint64_t entry_size = entry_stat.st_size;
+	// file left by an interrupted write is evicted like an entry
+	string interrupted = directory + "/entry9.abcdef.hst";
+	ofstream(interrupted) << "partial";
+	set_modification_time(interrupted, 500);
+	// loading an entry makes it the most recently used one
+	BOOST_CHECK(load(keys[0]));
+	HistogramCacheKey new_key = key;
+	strcpy(new_key.hash, "entry5");
+	BOOST_REQUIRE(histogram_cache_store(directory.c_str(), &new_key, histogram, entry_size * 3));
+	BOOST_CHECK(load(new_key));
+	BOOST_CHECK(load(keys[0]));
+	BOOST_CHECK(load(keys[4]));
+	for (int i = 1; i < 4; i++)
+		BOOST_CHECK(!load(keys[i]));
+	BOOST_CHECK(access(interrupted.c_str(), F_OK) != 0);
+	BOOST_CHECK_EQUAL(list().size(), 3);
+}
+BOOST_AUTO_TEST_CASE(empty_histogram)
+{
+	color_histogram_destroy(histogram);
+	histogram = color_histogram_new();
+	BOOST_REQUIRE(histogram_cache_store(directory.c_str(), &key, histogram, 1 << 30));
+	BOOST_CHECK(load(key));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,43 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE name_search
+#include <boost/test/unit_test.hpp>
+#include "NameSearch.h"
+#include <string>
+using namespace std;
+
+struct NameSearchFixture{
+	NameSearch *name_search;
+	NameSearchFixture(){
+		const char *names[] = {"Dark blue", "Blue", "Light sky blue", "Blush", "Red", "Orange red", "Bluish green"};
+		name_search = name_search_new();
+		for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++){
+			name_search_add(name_search, names[i], i);
+		}
+		name_search_build(name_search);
+	}
+	~NameSearchFixture(){
+		name_search_destroy(name_search);
+	}
+	string first(const char *query){
+		NameSearchMatch match;
+		if (name_search_find(name_search, query, 1, &match) == 0) return "";
+		return match.name;
+	}
+};
+BOOST_FIXTURE_TEST_CASE(prefix, NameSearchFixture)
+{
+	BOOST_CHECK_EQUAL(first("b"), "Blue");
+	BOOST_CHECK_EQUAL(first("BLU"), "Blue");
+	BOOST_CHECK_EQUAL(first("blus"), "Blush");
+	BOOST_CHECK_EQUAL(first("sky"), "Light sky blue");
+	BOOST_CHECK_EQUAL(first("orange r"), "Orange red");
+	NameSearchMatch matches[10];
+	BOOST_CHECK_EQUAL(name_search_find(name_search, "red", 10, matches), 2);
+}
+BOOST_FIXTURE_TEST_CASE(fuzzy, NameSearchFixture)
+{
+	BOOST_CHECK_EQUAL(first("bleu"), "Blue");
+	BOOST_CHECK_EQUAL(first("oragne"), "Orange red");
+	BOOST_CHECK_EQUAL(first("xyz"), "");
+	BOOST_CHECK_EQUAL(first(""), "");
+}
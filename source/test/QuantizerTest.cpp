@@ -0,0 +1,197 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE quantizer
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <string.h>
+#include "Color.h"
+#include "ColorBatch.h"
+#include "ColorHistogram.h"
+#include "ColorOctree.h"
+#include "Quantizer.h"
+#include "simd/QuantizerKernels.h"
+using namespace std;
+
+struct QuantizerFixture
+{
+	mt19937 random;
+	QuantizerFixture():
+		random(1)
+	{
+		color_init();
+	}
+	vector<uint8_t> random_image(int width, int height, int channels)
+	{
+		// pixels are grouped around a few colors, so that histograms have both dense and empty areas
+		uniform_int_distribution<int> component(0, 255), center(0, 7), offset(-20, 20);
+		int centers[8][3];
+		for (int i = 0; i < 8; i++){
+			for (int j = 0; j < 3; j++)
+				centers[i][j] = component(random);
+		}
+		vector<uint8_t> pixels(size_t(width) * height * channels);
+		for (size_t i = 0; i < pixels.size(); i += channels){
+			int c = center(random);
+			for (int j = 0; j < channels; j++)
+				pixels[i + j] = j < 3 ? uint8_t(min(max(centers[c][j] + offset(random), 0), 255)) : 255;
+		}
+		return pixels;
+	}
+	static bool same_bins(const ColorHistogram *a, const ColorHistogram *b)
+	{
+		return memcmp(color_histogram_get_bins(a), color_histogram_get_bins(b), sizeof(ColorHistogramBin) * COLOR_HISTOGRAM_SIZE) == 0;
+	}
+	static bool same_colors(const vector<Color> &a, const vector<Color> &b, float tolerance)
+	{
+		if (a.size() != b.size()) return false;
+		for (size_t i = 0; i < a.size(); i++){
+			for (int j = 0; j < 3; j++){
+				if (fabs(a[i].ma[j] - b[i].ma[j]) > tolerance) return false;
+			}
+		}
+		return true;
+	}
+	static void sort_colors(vector<Color> &colors)
+	{
+		sort(colors.begin(), colors.end(), [](const Color &a, const Color &b){
+			return lexicographical_compare(a.ma, a.ma + 3, b.ma, b.ma + 3);
+		});
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(quantizer, QuantizerFixture)
+
+BOOST_AUTO_TEST_CASE(histogram_bands)
+{
+	const int width = 611, height = 1031;
+	for (int channels = 3; channels <= 4; channels++){
+		vector<uint8_t> pixels = random_image(width, height, channels);
+		int rowstride = width * channels;
+		ColorHistogram *serial = color_histogram_new(), *bands = color_histogram_new(), *merged = color_histogram_new(), *part = color_histogram_new();
+		color_histogram_add_rows(serial, pixels.data(), width, height, rowstride, channels);
+		color_histogram_add_image(bands, pixels.data(), width, height, rowstride, channels);
+		BOOST_CHECK(same_bins(serial, bands));
+		BOOST_CHECK_EQUAL(color_histogram_get_pixel_count(bands), uint64_t(width) * height);
+		// merging histograms of two parts of the image gives the histogram of the whole image
+		color_histogram_add_rows(merged, pixels.data(), width, 100, rowstride, channels);
+		color_histogram_add_rows(part, pixels.data() + 100 * rowstride, width, height - 100, rowstride, channels);
+		color_histogram_merge(merged, part);
+		BOOST_CHECK(same_bins(serial, merged));
+		BOOST_CHECK_EQUAL(color_histogram_get_pixel_count(merged), uint64_t(width) * height);
+		color_histogram_destroy(serial);
+		color_histogram_destroy(bands);
+		color_histogram_destroy(merged);
+		color_histogram_destroy(part);
+	}
+}
+BOOST_AUTO_TEST_CASE(octree_reduce)
+{
+	uniform_real_distribution<float> component(0, 1);
+	ColorOctree *reduced = color_octree_new(5), *full = color_octree_new(5);
+	for (int i = 0; i < 20000; i++){
+		Color color;
+		color_set(&color, component(random), component(random), component(random));
+		color_octree_add(reduced, &color);
+		color_octree_add(full, &color);
+	}
+	const uint32_t reduced_colors = 200;
+	color_octree_reduce(reduced, reduced_colors);
+	BOOST_CHECK(color_octree_get_node_count(reduced) < color_octree_get_node_count(full));
+	const uint32_t counts[] = {1, 2, 8, 16, 50, 128, 200};
+	for (auto count: counts){
+		vector<Color> reduced_result, full_result;
+		color_octree_get_colors(reduced, count, reduced_result);
+		color_octree_get_colors(full, count, full_result);
+		BOOST_CHECK(reduced_result.size() <= count);
+		BOOST_CHECK(same_colors(reduced_result, full_result, 1e-6f));
+	}
+	// octree is not modified by getting colors, so the same query gives the same result again
+	vector<Color> first, second;
+	color_octree_get_colors(full, 16, first);
+	color_octree_get_colors(full, 16, second);
+	BOOST_CHECK(same_colors(first, second, 0));
+	color_octree_destroy(reduced);
+	color_octree_destroy(full);
+}
+BOOST_AUTO_TEST_CASE(box_sums)
+{
+	// each box of a palette with as many colors as there are non-empty bins contains a single bin, so palette colors are exact bin means
+	uniform_int_distribution<int> index(0, COLOR_HISTOGRAM_SIZE - 1), count(1, 1000), offset(0, 7);
+	const QuantizerType types[] = {QUANTIZER_MEDIAN_CUT, QUANTIZER_WU};
+	for (int iteration = 0; iteration < 20; iteration++){
+		ColorHistogram *histogram = color_histogram_new();
+		vector<Color> expected;
+		Color mean;
+		color_zero(&mean);
+		uint64_t total = 0;
+		for (int i = 0; i < 12; i++){
+			int bin_index = index(random);
+			if (color_histogram_get_bins(histogram)[bin_index].count) continue;
+			int position[3] = {(bin_index >> (COLOR_HISTOGRAM_BITS * 2)) & 31, (bin_index >> COLOR_HISTOGRAM_BITS) & 31, bin_index & 31};
+			ColorHistogramBin bin;
+			bin.count = count(random);
+			bin.sum_squares = 0;
+			Color color;
+			for (int j = 0; j < 3; j++){
+				int value = (position[j] << 3) + offset(random);
+				bin.sum[j] = bin.count * value;
+				bin.sum_squares += bin.count * value * value;
+				color.ma[j] = value / 255.0f;
+				mean.ma[j] += bin.sum[j] / 255.0f;
+			}
+			total += bin.count;
+			color_histogram_add_bin(histogram, bin_index, &bin);
+			expected.push_back(color);
+		}
+		sort_colors(expected);
+		for (auto type: types){
+			Quantizer *quantizer = quantizer_new(type);
+			quantizer_set_histogram(quantizer, histogram);
+			vector<Color> result;
+			quantizer_get_colors(quantizer, expected.size(), result);
+			sort_colors(result);
+			BOOST_CHECK(same_colors(result, expected, 1e-5f));
+			// a single box contains the whole histogram
+			quantizer_get_colors(quantizer, 1, result);
+			BOOST_REQUIRE_EQUAL(result.size(), 1);
+			for (int j = 0; j < 3; j++)
+				BOOST_CHECK_SMALL(result[0].ma[j] - mean.ma[j] / total, 1e-5f);
+			quantizer_destroy(quantizer);
+		}
+		color_histogram_destroy(histogram);
+	}
+}
+BOOST_AUTO_TEST_CASE(kmeans_kernels)
+{
+	const QuantizerKernels *scalar = quantizer_kernels_scalar(), *sse2 = quantizer_kernels_sse2();
+	if (!sse2) return;
+	uniform_real_distribution<float> component(-100, 100);
+	const size_t point_count = 1003;
+	vector<Color> colors(point_count);
+	for (auto &color: colors)
+		color_set(&color, component(random), component(random), component(random));
+	ColorSpan *points = color_span_new(point_count);
+	color_span_load(colors.data(), point_count, points);
+	const size_t center_counts[] = {1, 3, 16, 33};
+	for (auto center_count: center_counts){
+		vector<float> centers(center_count * 3);
+		for (auto &value: centers)
+			value = component(random);
+		// duplicate center checks that the first center wins when distances are equal
+		if (center_count > 2)
+			copy(centers.begin(), centers.begin() + 3, centers.end() - 3);
+		vector<uint32_t> scalar_nearest(point_count), sse2_nearest(point_count);
+		vector<float> scalar_distances(point_count), sse2_distances(point_count);
+		scalar->nearest(points, centers.data(), center_count, scalar_nearest.data(), scalar_distances.data());
+		sse2->nearest(points, centers.data(), center_count, sse2_nearest.data(), sse2_distances.data());
+		for (size_t i = 0; i < point_count; i++){
+			BOOST_CHECK_EQUAL(scalar_nearest[i], sse2_nearest[i]);
+			BOOST_CHECK_CLOSE(scalar_distances[i], sse2_distances[i], 1e-3);
+		}
+	}
+	color_span_destroy(points);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
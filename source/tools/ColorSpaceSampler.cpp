@@ -19,6 +19,7 @@
 #include "ColorSpaceSampler.h"
 #include "../ColorList.h"
 #include "../ColorObject.h"
+#include "../ColorBatch.h"
 #include "../GlobalState.h"
 #include "../Internationalisation.h"
 #include "../DynvHelpers.h"
@@ -69,6 +70,10 @@ class ColorSpaceSamplerNameAssigner: public ToolColorNameAssigner
 		{
 			ToolColorNameAssigner::assign(color_object, color);
 		}
+		void assign(ColorObject **color_objects, const Color *colors, size_t count)
+		{
+			ToolColorNameAssigner::assign(color_objects, colors, count);
+		}
 		virtual std::string getToolSpecificName(ColorObject *color_object, const Color *color)
 		{
 			m_stream.str("");
@@ -108,42 +113,45 @@ static void calc(ColorSpaceSamplerArgs *args, bool preview, size_t limit)
 			}
 		}
 	}
-	Color t;
+	if (value_count == 0)
+		return;
+	ColorSpan *span = color_span_new(value_count);
+	color_span_load(&values.front(), value_count, span);
+	switch (args->color_space){
+		case 1:
+			color_batch_hsv_to_rgb(span, span);
+			break;
+		case 2:
+			color_batch_hsl_to_rgb(span, span);
+			break;
+		case 3:
+			for (size_t i = 0; i < value_count; i++){
+				span->component[0][i] *= 100;
+				span->component[1][i] = (span->component[1][i] - 0.5f) * 290;
+				span->component[2][i] = (span->component[2][i] - 0.5f) * 290;
+			}
+			color_batch_lab_to_rgb_d50(span, span);
+			break;
+		case 4:
+			for (size_t i = 0; i < value_count; i++){
+				span->component[0][i] *= 100;
+				span->component[1][i] *= 136;
+				span->component[2][i] *= 360;
+			}
+			color_batch_lch_to_rgb_d50(span, span);
+			break;
+	}
+	if (args->linearization)
+		color_batch_linear_get_rgb(span, span);
+	color_span_store(span, &values.front());
+	color_span_destroy(span);
+	vector<ColorObject*> color_objects(value_count);
 	for (size_t i = 0; i < value_count; i++){
-		if (preview){
-			if (limit <= 0) return;
-			limit--;
-		}
-		switch (args->color_space){
-			case 0:
-				color_copy(&values[i], &t);
-				break;
-			case 1:
-				color_hsv_to_rgb(&values[i], &t);
-				break;
-			case 2:
-				color_hsl_to_rgb(&values[i], &t);
-				break;
-			case 3:
-				color_copy(&values[i], &t);
-				t.lab.L *= 100;
-				t.lab.a = (t.lab.a - 0.5) * 290;
-				t.lab.b = (t.lab.b - 0.5) * 290;
-				color_lab_to_rgb_d50(&t, &t);
-				break;
-			case 4:
-				color_copy(&values[i], &t);
-				t.lch.L *= 100;
-				t.lch.C *= 136;
-				t.lch.h *= 360;
-				color_lch_to_rgb_d50(&t, &t);
-				break;
-		}
-		if (args->linearization)
-			color_linear_get_rgb(&t, &t);
-		color_rgb_normalize(&t);
-		ColorObject *color_object = color_list_new_color_object(color_list, &t);
-		name_assigner.assign(color_object, &t);
+		color_rgb_normalize(&values[i]);
+		color_objects[i] = color_list_new_color_object(color_list, &values[i]);
+	}
+	name_assigner.assign(&color_objects.front(), &values.front(), value_count);
+	for (auto color_object: color_objects){
 		color_list_add_color_object(color_list, color_object, 1);
 		color_object->release();
 	}
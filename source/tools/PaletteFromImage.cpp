@@ -25,58 +25,92 @@
 #include "../ToolColorNaming.h"
 #include "../DynvHelpers.h"
 #include "../Internationalisation.h"
+#include "../Paths.h"
+#include "../ColorHistogram.h"
+#include "../ImageHistogram.h"
+#include "../HistogramCache.h"
+#include "../Quantizer.h"
 #include <string.h>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <sstream>
-#include <stack>
 #include <string>
+#include <thread>
+#include <vector>
 using namespace std;
 
 /** \file PaletteFromImage.cpp
  * \brief
  */
 
-/** \struct Node
- * \brief Node is a cube in space with color information
- *
- * Each node can b
- */
-typedef struct Node{
-	uint32_t n_pixels; /**< Number of colors in current Node and its children */
-	uint32_t n_pixels_in; /**< Number of colors in current Node */
-	float color[3]; /**< Sum of color values */
-	float distance; /**< Squared distances from Node center of colors in Node */
-	Node *child[8]; /**< Pointers to child Nodes */
-	Node *parent; /**< Pointer to parent Node */
-}Node;
-
-/** \struct Cube
- * \brief Cube structure holds all information necessary to define cube size and position in space
- */
-typedef struct Cube{
-	float x; /**< X position */
-	float w; /**< Width */
-	float y; /**< Y position */
-	float h; /**< Height */
-	float z; /**< Z position */
-	float d; /**< Depth */
-}Cube;
+/** Every PREVIEW_STRIDE-th pixel of every PREVIEW_STRIDE-th row is counted into the preview histogram while image is decoded */
+const int PREVIEW_STRIDE = 4;
+/** Minimal time between preview updates in microseconds */
+const int64_t PREVIEW_INTERVAL = 250000;
+
+struct PaletteFromImageJob;
 
 typedef struct PaletteFromImageArgs{
 	GtkWidget *file_browser;
 	GtkWidget *range_colors;
+	GtkWidget *engine;
 	GtkWidget *merge_threshold;
 	GtkWidget *preview_expander;
 	string filename;
 	uint32_t n_colors;
+	QuantizerType engine_type;
 	string previous_filename;
-	Node *previous_node;
+	ColorHistogram *previous_histogram;
+	bool histogram_final; /**< False while previous_histogram is missing or only approximate, and image is being loaded */
+	PaletteFromImageJob *job; /**< Background loading of previous_filename */
+	Quantizer *quantizer; /**< Quantizer prepared for previous_histogram */
+	QuantizerType quantizer_type;
+	string cache_directory;
+	int32_t cache_size; /**< Histogram cache size in MiB. Cache is disabled when zero */
 	ColorList *color_list;
 	ColorList *preview_color_list;
 	struct dynvSystem *params;
 	GlobalState* gs;
 }PaletteFromImageArgs;
 
+/** \struct PaletteFromImageJob
+ * \brief Image loading in a background thread.
+ *
+ * Cached histogram is delivered when histogram cache has the image. Otherwise the image is decoded once: subsampled preview
+ * histograms are delivered while it is being decoded, at most one every PREVIEW_INTERVAL and only after the previous one was
+ * delivered, and then histogram of the full image, which is also stored in cache. Histograms are passed to main loop by idle
+ * handlers, which discard them when job was cancelled. Job is freed when the thread and all pending idle handlers release it.
+ */
+typedef struct PaletteFromImageJob{
+	atomic<int> references;
+	atomic<bool> cancelled; /**< Set in main loop when results are no longer needed */
+	string filename;
+	string cache_directory;
+	uint64_t cache_size; /**< Histogram cache size in bytes. Cache is disabled when zero */
+	atomic<bool> preview_pending; /**< Preview histogram was posted, but not delivered yet */
+	int64_t preview_time; /**< Monotonic time of the last preview update, only used by the thread */
+	PaletteFromImageArgs *args; /**< Only valid in main loop while job is not cancelled */
+}PaletteFromImageJob;
+
+/** \struct PaletteFromImageResult
+ * \brief Histogram passed from background thread to main loop.
+ */
+typedef struct PaletteFromImageResult{
+	PaletteFromImageJob *job;
+	ColorHistogram *histogram; /**< Loaded histogram or nullptr if loading failed */
+	bool final; /**< True when histogram is of the full image or loading failed */
+	string error;
+}PaletteFromImageResult;
+
+/** Labels of quantizer engines, indexed by QuantizerType */
+static const char *engine_labels[QUANTIZER_COUNT] = {
+	N_("Octree"),
+	N_("Median cut"),
+	N_("Wu"),
+	N_("k-means in Lab"),
+};
+
 class PaletteColorNameAssigner: public ToolColorNameAssigner {
 	protected:
 		stringstream m_stream;
@@ -94,296 +128,211 @@ class PaletteColorNameAssigner: public ToolColorNameAssigner {
 			m_index = index;
 			ToolColorNameAssigner::assign(color_object, color);
 		}
+		void assign(ColorObject **color_objects, const Color *colors, size_t count, const char *filename)
+		{
+			m_filename = filename;
+			m_index = 0;
+			ToolColorNameAssigner::assign(color_objects, colors, count);
+		}
 		virtual std::string getToolSpecificName(ColorObject *color_object, const Color *color)
 		{
 			m_stream.str("");
-			m_stream << m_filename << " #" << m_index;
+			m_stream << m_filename << " #" << m_index++;
 			return m_stream.str();
 		}
 };
 
-/**
- * Allocate and initialize a new node with specified parent
- * @param[in] parent Parent node
- * @return New node
- */
-static Node* node_new(Node *parent){
-	Node *n = new Node;
-	n->color[0] = n->color[1] = n->color[2] = 0;
-	n->distance = 0;
-	n->n_pixels = 0;
-	n->n_pixels_in = 0;
-	n->parent = parent;
-	for (int i = 0; i < 8; i++){
-		n->child[i] = 0;
-	}
-	return n;
+static void calc(PaletteFromImageArgs *args, bool preview, int limit);
+
+static void job_release(PaletteFromImageJob *job){
+	if (--job->references == 0)
+		delete job;
 }
 
 /**
- * Deallocate node and its children
- * @param[in] node Node to deallocate
+ * Cancel background loading. Histograms, which were not delivered yet, are discarded.
+ * @param[in] args Dialog data.
  */
-static void node_delete(Node *node){
-	for (int i = 0; i < 8; i++){
-		if (node->child[i]){
-			node_delete(node->child[i]);
-		}
-	}
-
-	delete node;
+static void job_cancel(PaletteFromImageArgs *args){
+	if (!args->job) return;
+	args->job->cancelled = true;
+	job_release(args->job);
+	args->job = nullptr;
 }
 
 /**
- * Copy node and assing new parent
- * @param[in] node Node to copy
- * @param[in] parent Parent of copied node
- * @return A copy of node
+ * Replace histogram of the last image. Quantizer prepared for the old histogram is destroyed.
+ * @param[in] args Dialog data.
+ * @param[in] histogram New histogram or nullptr. Ownership is transferred to args.
+ * @param[in] final True if histogram will not be replaced by a more accurate one.
  */
-static Node* node_copy(Node *node, Node *parent){
-	Node *n = node_new(0);
-	memcpy(n, node, sizeof(Node));
-	n->parent = parent;
-
-	for (int i = 0; i < 8; i++){
-		if (node->child[i]){
-			n->child[i] = node_copy(node->child[i], n);
-		}else{
-			n->child[i] = 0;
-		}
+static void set_histogram(PaletteFromImageArgs *args, ColorHistogram *histogram, bool final){
+	if (args->quantizer){
+		quantizer_destroy(args->quantizer);
+		args->quantizer = nullptr;
 	}
-	return n;
+	if (args->previous_histogram)
+		color_histogram_destroy(args->previous_histogram);
+	args->previous_histogram = histogram;
+	args->histogram_final = final;
 }
 
-/**
- * Get the number of nodes with available color information in them
- * @param[in] node Start from this node
- * @return Number of nodes with available color information in them
- */
-static uint32_t node_count_leafs(Node *node){
-	uint32_t r = 0;
-	if (node->n_pixels_in) r++;
-	for (int i = 0; i < 8; i++){
-		if (node->child[i])
-			r += node_count_leafs(node->child[i]);
+static gboolean job_deliver(PaletteFromImageResult *result){
+	PaletteFromImageJob *job = result->job;
+	if (!result->final)
+		job->preview_pending = false;
+	if (!job->cancelled){
+		PaletteFromImageArgs *args = job->args;
+		if (!result->error.empty())
+			cout << result->error << endl;
+		set_histogram(args, result->histogram, result->final);
+		result->histogram = nullptr;
+		if (result->final)
+			job_cancel(args);
+		color_list_remove_all(args->preview_color_list);
+		calc(args, true, 100);
 	}
-	return r;
+	if (result->histogram) color_histogram_destroy(result->histogram);
+	job_release(job);
+	delete result;
+	return false;
 }
 
-/**
- * Call callback on all nodes with available color information in them
- * @param[in] node Start from this node
- * @param[in] leaf_cb Callback function
- * @param[in] userdata User supplied pointer which is passed when calling callback
- */
-static void node_leaf_callback(Node *node, void (*leaf_cb)(Node* node, void* userdata), void* userdata){
-	if (node->n_pixels_in > 0) leaf_cb(node, userdata);
-
-	for (int i = 0; i < 8; i++){
-		if (node->child[i])
-			node_leaf_callback(node->child[i], leaf_cb, userdata);
-	}
+static void job_post(PaletteFromImageJob *job, ColorHistogram *histogram, bool final, const GError *error){
+	PaletteFromImageResult *result = new PaletteFromImageResult;
+	job->references++;
+	result->job = job;
+	result->histogram = histogram;
+	result->final = final;
+	if (error) result->error = error->message;
+	g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, (GSourceFunc)job_deliver, result, (GDestroyNotify)nullptr);
 }
 
 /**
- * Merge node information into its parent node
- * @param[in] node Node to merge
+ * Post a copy of preview histogram, unless the previous one is still pending or was posted recently.
  */
-static void node_prune(Node *node){
-
-	for (int i = 0; i < 8; i++){
-		if (node->child[i]){
-			node_prune(node->child[i]);
-			node->child[i] = 0;
-
-		}
-	}
-
-	if (node->parent){
-		node->parent->n_pixels_in += node->n_pixels_in;
-
-		node->parent->color[0] += node->color[0];
-		node->parent->color[1] += node->color[1];
-		node->parent->color[2] += node->color[2];
-	}
-
-	node_delete(node);
-}
-
-typedef struct PruneData{
-	float threshold;
-	float min_distance;
-	uint32_t n_colors;
-	uint32_t n_colors_target;
-
-	Node *prune_node;
-	uint32_t distant_nodes;
-}PruneData;
-
-static bool node_prune_threshold(Node *node, PruneData *prune_data){
-	if (node->distance <= prune_data->threshold){
-		uint32_t colors_removed = node_count_leafs(node);
-		node_prune(node);
-		prune_data->n_colors -= colors_removed;
-		return true;
-	}
-
-	if (node->distance < prune_data->min_distance){
-		prune_data->min_distance = node->distance;
-	}
-
-	uint32_t n = node->n_pixels_in;
-
-	for (int i = 0; i < 8; i++){
-		if (node->child[i]){
-			if (node_prune_threshold(node->child[i], prune_data)){
-				node->child[i] = 0;
-			}
-		}
-	}
-
-	if (node->n_pixels_in > 0 && n == 0) prune_data->n_colors++;
-
-	return false;
+static void job_preview(const ColorHistogram *preview, void *userdata){
+	PaletteFromImageJob *job = static_cast<PaletteFromImageJob*>(userdata);
+	int64_t now = g_get_monotonic_time();
+	if (job->preview_pending || now - job->preview_time < PREVIEW_INTERVAL) return;
+	job->preview_time = now;
+	job->preview_pending = true;
+	ColorHistogram *histogram = color_histogram_new();
+	color_histogram_merge(histogram, preview);
+	job_post(job, histogram, false, nullptr);
 }
 
-static void node_reduce(Node *node, uint32_t colors){
-	PruneData prune_data;
-	prune_data.n_colors = node_count_leafs(node);
-	prune_data.n_colors_target = colors;
-	prune_data.threshold = 0;
-
-	while (prune_data.n_colors > colors){
-		prune_data.min_distance = node->distance;
-
-		if (node_prune_threshold(node, &prune_data)) break;
-
-		prune_data.threshold = prune_data.min_distance;
+static void job_run(PaletteFromImageJob *job){
+	ColorHistogram *histogram = color_histogram_new();
+	HistogramCacheKey key;
+	bool cached = job->cache_size > 0 && histogram_cache_get_key(job->filename.c_str(), &key, &job->cancelled);
+	if (cached && histogram_cache_load(job->cache_directory.c_str(), &key, histogram)){
+		job_post(job, histogram, true, nullptr);
+		job_release(job);
+		return;
 	}
-}
-
-static void node_update(Node *node, Color *color, Cube *cube, uint32_t max_depth){
-	Cube new_cube;
-
-	new_cube.w = cube->w / 2;
-	new_cube.h = cube->h / 2;
-	new_cube.d = cube->d / 2;
-
-	node->n_pixels++;
-
-	node->distance += (color->xyz.x - (cube->x + new_cube.w)) * (color->xyz.x - (cube->x + new_cube.w)) +
-		(color->xyz.y - (cube->y + new_cube.h)) * (color->xyz.y - (cube->y + new_cube.h)) +
-		(color->xyz.z - (cube->z + new_cube.d)) * (color->xyz.z - (cube->z + new_cube.d));
-
-	if (!max_depth){
-		node->n_pixels_in++;
-
-		node->color[0] += color->xyz.x;
-		node->color[1] += color->xyz.y;
-		node->color[2] += color->xyz.z;
-
+	ImageHistogramPreview preview;
+	preview.stride = PREVIEW_STRIDE;
+	preview.update = job_preview;
+	preview.userdata = job;
+	// the first preview is posted after an interval, so small images are only delivered once
+	job->preview_time = g_get_monotonic_time();
+	GError *error = nullptr;
+	bool result = image_histogram_load_cancellable(job->filename.c_str(), histogram, &job->cancelled, &preview, &error);
+	if (result){
+		if (cached)
+			histogram_cache_store(job->cache_directory.c_str(), &key, histogram, job->cache_size);
+		job_post(job, histogram, true, nullptr);
 	}else{
-		int x, y, z;
-
-		if (color->xyz.x - cube->x < new_cube.w)
-			x = 0;
-		else
-			x = 1;
-
-		if (color->xyz.y - cube->y < new_cube.h)
-			y = 0;
-		else
-			y = 1;
-
-		if (color->xyz.z - cube->z < new_cube.d)
-			z = 0;
-		else
-			z = 1;
-
-		new_cube.x = cube->x + new_cube.w * x;
-		new_cube.y = cube->y + new_cube.h * y;
-		new_cube.z = cube->z + new_cube.d * z;
-
-		int i = x | (y<<1) | (z<<2);
-
-		if (!node->child[i])
-			node->child[i] = node_new(node);
-
-		node->n_pixels++;
-
-		node_update(node->child[x | (y<<1) | (z<<2)], color, &new_cube, max_depth - 1);
+		color_histogram_destroy(histogram);
+		if (!job->cancelled)
+			job_post(job, nullptr, true, error);
 	}
+	if (error) g_error_free(error);
+	job_release(job);
 }
 
-static void leaf_cb(Node *node, void *userdata){
-	list<Color> *l = static_cast<list<Color>*>(userdata);
+/**
+ * Get color histogram of the image for preview. Image is loaded in a background thread and preview is updated each time a more
+ * accurate histogram is loaded. Histogram of the last image is kept, so changing color count or engine does not process the image again.
+ * @param[in] args Dialog data.
+ * @param[in] filename Image file name.
+ * @return Most accurate histogram loaded so far, owned by args, or nullptr.
+ */
+static ColorHistogram* get_preview_histogram(PaletteFromImageArgs *args, const char *filename){
+	if (args->previous_filename == filename)
+		return args->previous_histogram;
 
-	Color c;
-	c.xyz.x = node->color[0] / node->n_pixels_in;
-	c.xyz.y = node->color[1] / node->n_pixels_in;
-	c.xyz.z = node->color[2] / node->n_pixels_in;
+	job_cancel(args);
+	set_histogram(args, nullptr, false);
+	args->previous_filename = filename;
 
-	l->push_back(c);
+	PaletteFromImageJob *job = new PaletteFromImageJob;
+	job->references = 2; // one for args, one for the thread
+	job->cancelled = false;
+	job->preview_pending = false;
+	job->preview_time = 0;
+	job->filename = filename;
+	job->cache_directory = args->cache_directory;
+	job->cache_size = uint64_t(args->cache_size) * 1024 * 1024;
+	job->args = args;
+	args->job = job;
+	std::thread(job_run, job).detach();
+	return nullptr;
 }
 
-static Node* process_image(PaletteFromImageArgs *args, const char *filename, Node* node){
-
-	if (args->previous_filename == filename){
-		if (args->previous_node)
-			return node_copy(args->previous_node, 0);
-		else
-			return 0;
-	}
+/**
+ * Get color histogram of the full image. When background loading has not finished yet, it is cancelled and histogram is loaded from cache
+ * or image is decoded in main loop.
+ * @param[in] args Dialog data.
+ * @param[in] filename Image file name.
+ * @return Histogram owned by args or nullptr if image could not be loaded.
+ */
+static ColorHistogram* get_histogram(PaletteFromImageArgs *args, const char *filename){
+	if (args->previous_filename == filename && args->histogram_final)
+		return args->previous_histogram;
 
+	job_cancel(args);
+	set_histogram(args, nullptr, true);
 	args->previous_filename = filename;
-	if (args->previous_node){
-		node_delete(args->previous_node);
-		args->previous_node = 0;
-	}
 
-	GError *error = nullptr;
-	GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(filename, &error);
-	if (error){
-		cout << error->message << endl;
-		g_error_free(error);
-		return 0;
+	ColorHistogram *histogram = color_histogram_new();
+	HistogramCacheKey key;
+	bool cached = args->cache_size > 0 && histogram_cache_get_key(filename, &key, nullptr);
+	if (!cached || !histogram_cache_load(args->cache_directory.c_str(), &key, histogram)){
+		GError *error = nullptr;
+		if (!image_histogram_load(filename, histogram, &error)){
+			if (error){
+				cout << error->message << endl;
+				g_error_free(error);
+			}
+			color_histogram_destroy(histogram);
+			return nullptr;
+		}
+		if (cached)
+			histogram_cache_store(args->cache_directory.c_str(), &key, histogram, uint64_t(args->cache_size) * 1024 * 1024);
 	}
+	set_histogram(args, histogram, true);
+	return histogram;
+}
 
-	int channels = gdk_pixbuf_get_n_channels(pixbuf);
-	int width = gdk_pixbuf_get_width(pixbuf);
-	int height = gdk_pixbuf_get_height(pixbuf);
-	int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
-	guchar *image_data = gdk_pixbuf_get_pixels(pixbuf);
-	guchar *ptr = image_data;
-
-	Cube cube;
-	cube.x = 0;
-	cube.y = 0;
-	cube.z = 0;
-	cube.w = 1;
-	cube.h = 1;
-	cube.d = 1;
-
-	Color color;
-
-	args->previous_node = node_new(0);
-
-	for (int y = 0; y < height; y++){
-		ptr = image_data + rowstride * y;
-		for (int x = 0; x < width; x++){
-
-			color.xyz.x = ptr[0] / 255.0;
-			color.xyz.y = ptr[1] / 255.0;
-			color.xyz.z = ptr[2] / 255.0;
-
-			node_update(args->previous_node, &color, &cube, 5);
-
-			ptr += channels;
-		}
+/**
+ * Get quantizer of the selected engine, prepared for histogram.
+ * @param[in] args Dialog data.
+ * @param[in] histogram Histogram returned by process_image.
+ * @return Quantizer owned by args.
+ */
+static Quantizer* get_quantizer(PaletteFromImageArgs *args, ColorHistogram *histogram){
+	if (args->quantizer && args->quantizer_type != args->engine_type){
+		quantizer_destroy(args->quantizer);
+		args->quantizer = nullptr;
+	}
+	if (!args->quantizer){
+		args->quantizer = quantizer_new(args->engine_type);
+		args->quantizer_type = args->engine_type;
+		quantizer_set_histogram(args->quantizer, histogram);
 	}
-	g_object_unref(pixbuf);
-	node_reduce(args->previous_node, 200);
-	return node_copy(args->previous_node, 0);
+	return args->quantizer;
 }
 
 static void get_settings(PaletteFromImageArgs *args){
@@ -397,10 +346,14 @@ static void get_settings(PaletteFromImageArgs *args){
 	}
 
 	args->n_colors = gtk_spin_button_get_value(GTK_SPIN_BUTTON(args->range_colors));
+	int engine = gtk_combo_box_get_active(GTK_COMBO_BOX(args->engine));
+	args->engine_type = engine >= 0 && engine < QUANTIZER_COUNT ? QuantizerType(engine) : QUANTIZER_OCTREE;
 }
 
 static void save_settings(PaletteFromImageArgs *args){
 	dynv_set_int32(args->params, "colors", args->n_colors);
+	dynv_set_int32(args->params, "engine", args->engine_type);
+	dynv_set_int32(args->params, "cache_size", args->cache_size);
 	gchar *current_folder = gtk_file_chooser_get_current_folder(GTK_FILE_CHOOSER(args->file_browser));
 	if (current_folder){
 		dynv_set_string(args->params, "current_folder", current_folder);
@@ -415,12 +368,11 @@ static void save_settings(PaletteFromImageArgs *args){
 
 static void calc(PaletteFromImageArgs *args, bool preview, int limit){
 
-	Node *root_node = 0;
-	int index = 0;
+	ColorHistogram *histogram = nullptr;
 	gchar *name = g_path_get_basename(args->filename.c_str());
 	PaletteColorNameAssigner name_assigner(args->gs);
 	if (!args->filename.empty())
-		root_node = process_image(args, args->filename.c_str(), root_node);
+		histogram = preview ? get_preview_histogram(args, args->filename.c_str()) : get_histogram(args, args->filename.c_str());
 
 	ColorList *color_list;
 
@@ -429,20 +381,18 @@ static void calc(PaletteFromImageArgs *args, bool preview, int limit){
 	else
 		color_list = args->gs->getColorList();
 
-	list<Color> tmp_list;
-
-	if (root_node){
-		node_reduce(root_node, args->n_colors);
-		node_leaf_callback(root_node, leaf_cb, &tmp_list);
-		node_delete(root_node);
+	vector<Color> colors;
+	if (histogram)
+		quantizer_get_colors(get_quantizer(args, histogram), args->n_colors, colors);
+	vector<ColorObject*> color_objects;
+	for (auto &color: colors){
+		color_objects.push_back(color_list_new_color_object(color_list, &color));
 	}
-
-	for (list<Color>::iterator i = tmp_list.begin(); i != tmp_list.end(); i++){
-		ColorObject *color_object = color_list_new_color_object(color_list, &(*i));
-		name_assigner.assign(color_object, &(*i), name, index);
+	if (!colors.empty())
+		name_assigner.assign(&color_objects.front(), &colors.front(), colors.size(), name);
+	for (auto color_object: color_objects){
 		color_list_add_color_object(color_list, color_object, 1);
 		color_object->release();
-		index++;
 	}
 }
 
@@ -458,7 +408,8 @@ static gchar* format_threshold_value_cb(GtkScale *scale, gdouble value){
 
 static void destroy_cb(GtkWidget* widget, PaletteFromImageArgs *args){
 
-	if (args->previous_node) node_delete(args->previous_node);
+	job_cancel(args);
+	set_histogram(args, nullptr, true);
 
 	color_list_destroy(args->preview_color_list);
 	dynv_system_release(args->params);
@@ -496,7 +447,15 @@ void tools_palette_from_image_show(GtkWindow* parent, GlobalState* gs)
 	args->previous_filename = "";
 	args->gs = gs;
 	args->params = dynv_get_dynv(args->gs->getSettings(), "gpick.tools.palette_from_image");
-	args->previous_node = 0;
+	args->previous_histogram = nullptr;
+	args->histogram_final = true;
+	args->job = nullptr;
+	args->quantizer = nullptr;
+	args->quantizer_type = QUANTIZER_OCTREE;
+	gchar *cache_directory = build_config_path("histogram_cache");
+	args->cache_directory = cache_directory;
+	g_free(cache_directory);
+	args->cache_size = std::max(dynv_get_int32_wd(args->params, "cache_size", 32), 0);
 	GtkWidget *table, *table_m, *widget;
 	GtkWidget *dialog = gtk_dialog_new_with_buttons(_("Palette from image"), parent, GtkDialogFlags(GTK_DIALOG_DESTROY_WITH_PARENT), GTK_STOCK_CLOSE, GTK_RESPONSE_CLOSE, GTK_STOCK_ADD, GTK_RESPONSE_APPLY, nullptr);
 	gtk_window_set_default_size(GTK_WINDOW(dialog), dynv_get_int32_wd(args->params, "window.width", -1),
@@ -583,6 +542,16 @@ void tools_palette_from_image_show(GtkWindow* parent, GlobalState* gs)
 	g_signal_connect(G_OBJECT(args->range_colors), "value-changed", G_CALLBACK(update), args);
 	table_y++;
 
+	gtk_table_attach(GTK_TABLE(table), gtk_label_aligned_new(_("Engine:"),0,0,0,0),0,1,table_y,table_y+1,GtkAttachOptions(GTK_FILL),GTK_FILL,5,5);
+	args->engine = widget = gtk_combo_box_text_new();
+	for (int i = 0; i < QUANTIZER_COUNT; i++){
+		gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(widget), _(engine_labels[i]));
+	}
+	gtk_combo_box_set_active(GTK_COMBO_BOX(widget), dynv_get_int32_wd(args->params, "engine", QUANTIZER_OCTREE));
+	gtk_table_attach(GTK_TABLE(table), widget,1,3,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,3,3);
+	g_signal_connect(G_OBJECT(args->engine), "changed", G_CALLBACK(update), args);
+	table_y++;
+
 	ColorList* preview_color_list = nullptr;
 	gtk_table_attach(GTK_TABLE(table_m), args->preview_expander = palette_list_preview_new(gs, true, dynv_get_bool_wd(args->params, "show_preview", true), gs->getColorList(), &preview_color_list), 0, 1, table_m_y, table_m_y+1 , GtkAttachOptions(GTK_FILL | GTK_EXPAND), GtkAttachOptions(GTK_FILL | GTK_EXPAND), 5, 5);
 	table_m_y++;
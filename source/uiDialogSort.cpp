@@ -21,6 +21,7 @@
 #include "uiUtilities.h"
 #include "ColorList.h"
 #include "ColorObject.h"
+#include "ColorBatch.h"
 #include "MathUtil.h"
 #include "DynvHelpers.h"
 #include "GlobalState.h"
@@ -33,6 +34,7 @@
 #include <math.h>
 #include <sstream>
 #include <iostream>
+#include <vector>
 using namespace std;
 
 typedef struct DialogSortArgs{
@@ -51,192 +53,180 @@ typedef struct DialogSortArgs{
 	GlobalState* gs;
 }DialogSortArgs;
 
+typedef void (*ColorSpaceConversion)(const ColorSpan* a, ColorSpan* b);
+
 typedef struct SortType{
 	const char *name;
-	double (*get_value)(Color *color);
+	ColorSpaceConversion convert;
+	double (*get_value)(const Color *color);
 }SortType;
 
 typedef struct GroupType{
 	const char *name;
-	double (*get_group)(Color *color);
+	ColorSpaceConversion convert;
+	double (*get_group)(const Color *color);
 }GroupType;
 
-static double sort_rgb_red(Color *color)
+static double sort_rgb_red(const Color *color)
 {
 	return color->rgb.red;
 }
-static double sort_rgb_green(Color *color)
+static double sort_rgb_green(const Color *color)
 {
 	return color->rgb.green;
 }
-static double sort_rgb_blue(Color *color)
+static double sort_rgb_blue(const Color *color)
 {
 	return color->rgb.blue;
 }
-static double sort_rgb_grayscale(Color *color)
+static double sort_rgb_grayscale(const Color *color)
 {
 	return (color->rgb.red + color->rgb.green + color->rgb.blue) / 3.0;
 }
-static double sort_hsl_hue(Color *color)
+static double sort_hsl_hue(const Color *hsl)
 {
-	Color hsl;
-	color_rgb_to_hsl(color, &hsl);
-	return hsl.hsl.hue;
+	return hsl->hsl.hue;
 }
-static double sort_hsl_saturation(Color *color)
+static double sort_hsl_saturation(const Color *hsl)
 {
-	Color hsl;
-	color_rgb_to_hsl(color, &hsl);
-	return hsl.hsl.saturation;
+	return hsl->hsl.saturation;
 }
-static double sort_hsl_lightness(Color *color)
+static double sort_hsl_lightness(const Color *hsl)
 {
-	Color hsl;
-	color_rgb_to_hsl(color, &hsl);
-	return hsl.hsl.lightness;
+	return hsl->hsl.lightness;
 }
-static double sort_lab_lightness(Color *color)
+static double sort_lab_lightness(const Color *lab)
 {
-	Color lab;
-	color_rgb_to_lab_d50(color, &lab);
-	return lab.lab.L;
+	return lab->lab.L;
 }
-static double sort_lab_a(Color *color)
+static double sort_lab_a(const Color *lab)
 {
-	Color lab;
-	color_rgb_to_lab_d50(color, &lab);
-	return lab.lab.a;
+	return lab->lab.a;
 }
-static double sort_lab_b(Color *color)
+static double sort_lab_b(const Color *lab)
 {
-	Color lab;
-	color_rgb_to_lab_d50(color, &lab);
-	return lab.lab.b;
+	return lab->lab.b;
 }
-static double sort_lch_lightness(Color *color)
+static double sort_lch_lightness(const Color *lch)
 {
-	Color lch;
-	color_rgb_to_lch_d50(color, &lch);
-	return lch.lch.L;
+	return lch->lch.L;
 }
-static double sort_lch_chroma(Color *color)
+static double sort_lch_chroma(const Color *lch)
 {
-	Color lch;
-	color_rgb_to_lch_d50(color, &lch);
-	return lch.lch.C;
+	return lch->lch.C;
 }
-static double sort_lch_hue(Color *color)
+static double sort_lch_hue(const Color *lch)
 {
-	Color lch;
-	color_rgb_to_lch_d50(color, &lch);
-	return lch.lch.h;
+	return lch->lch.h;
 }
 
 const SortType sort_types[] = {
-	{N_("RGB Red"), sort_rgb_red},
-	{N_("RGB Green"), sort_rgb_green},
-	{N_("RGB Blue"), sort_rgb_blue},
-	{N_("RGB Grayscale"), sort_rgb_grayscale},
-	{N_("HSL Hue"), sort_hsl_hue},
-	{N_("HSL Saturation"), sort_hsl_saturation},
-	{N_("HSL Lightness"), sort_hsl_lightness},
-	{N_("Lab Lightness"), sort_lab_lightness},
-	{N_("Lab A"), sort_lab_a},
-	{N_("Lab B"), sort_lab_b},
-	{N_("LCh Lightness"), sort_lch_lightness},
-	{N_("LCh Chroma"), sort_lch_chroma},
-	{N_("LCh Hue"), sort_lch_hue},
+	{N_("RGB Red"), nullptr, sort_rgb_red},
+	{N_("RGB Green"), nullptr, sort_rgb_green},
+	{N_("RGB Blue"), nullptr, sort_rgb_blue},
+	{N_("RGB Grayscale"), nullptr, sort_rgb_grayscale},
+	{N_("HSL Hue"), color_batch_rgb_to_hsl, sort_hsl_hue},
+	{N_("HSL Saturation"), color_batch_rgb_to_hsl, sort_hsl_saturation},
+	{N_("HSL Lightness"), color_batch_rgb_to_hsl, sort_hsl_lightness},
+	{N_("Lab Lightness"), color_batch_rgb_to_lab_d50, sort_lab_lightness},
+	{N_("Lab A"), color_batch_rgb_to_lab_d50, sort_lab_a},
+	{N_("Lab B"), color_batch_rgb_to_lab_d50, sort_lab_b},
+	{N_("LCh Lightness"), color_batch_rgb_to_lch_d50, sort_lch_lightness},
+	{N_("LCh Chroma"), color_batch_rgb_to_lch_d50, sort_lch_chroma},
+	{N_("LCh Hue"), color_batch_rgb_to_lch_d50, sort_lch_hue},
 };
 
-static double group_rgb_red(Color *color)
+static double group_rgb_red(const Color *color)
 {
 	return color->rgb.red;
 }
-static double group_rgb_green(Color *color)
+static double group_rgb_green(const Color *color)
 {
 	return color->rgb.green;
 }
-static double group_rgb_blue(Color *color)
+static double group_rgb_blue(const Color *color)
 {
 	return color->rgb.blue;
 }
-static double group_rgb_grayscale(Color *color)
+static double group_rgb_grayscale(const Color *color)
 {
 	return (color->rgb.red + color->rgb.green + color->rgb.blue) / 3.0;
 }
-static double group_hsl_hue(Color *color)
+static double group_hsl_hue(const Color *hsl)
 {
-	Color hsl;
-	color_rgb_to_hsl(color, &hsl);
-	return hsl.hsl.hue;
+	return hsl->hsl.hue;
 }
-static double group_hsl_saturation(Color *color)
+static double group_hsl_saturation(const Color *hsl)
 {
-	Color hsl;
-	color_rgb_to_hsl(color, &hsl);
-	return hsl.hsl.saturation;
+	return hsl->hsl.saturation;
 }
-static double group_hsl_lightness(Color *color)
+static double group_hsl_lightness(const Color *hsl)
 {
-	Color hsl;
-	color_rgb_to_hsl(color, &hsl);
-	return hsl.hsl.lightness;
+	return hsl->hsl.lightness;
 }
-static double group_lab_lightness(Color *color)
+static double group_lab_lightness(const Color *lab)
 {
-	Color lab;
-	color_rgb_to_lab_d50(color, &lab);
-	return lab.lab.L / 100.0;
+	return lab->lab.L / 100.0;
 }
-static double group_lab_a(Color *color)
+static double group_lab_a(const Color *lab)
 {
-	Color lab;
-	color_rgb_to_lab_d50(color, &lab);
-	return (lab.lab.a + 145) / 290.0;
+	return (lab->lab.a + 145) / 290.0;
 }
-static double group_lab_b(Color *color)
+static double group_lab_b(const Color *lab)
 {
-	Color lab;
-	color_rgb_to_lab_d50(color, &lab);
-	return (lab.lab.b + 145) / 290.0;
+	return (lab->lab.b + 145) / 290.0;
 }
-static double group_lch_lightness(Color *color)
+static double group_lch_lightness(const Color *lch)
 {
-	Color lch;
-	color_rgb_to_lch_d50(color, &lch);
-	return lch.lch.L / 100.0;
+	return lch->lch.L / 100.0;
 }
-static double group_lch_chroma(Color *color)
+static double group_lch_chroma(const Color *lch)
 {
-	Color lch;
-	color_rgb_to_lch_d50(color, &lch);
-	return lch.lch.C / 136.0;
+	return lch->lch.C / 136.0;
 }
-static double group_lch_hue(Color *color)
+static double group_lch_hue(const Color *lch)
 {
-	Color lch;
-	color_rgb_to_lch_d50(color, &lch);
-	return lch.lch.h / 360.0;
+	return lch->lch.h / 360.0;
 }
 
 const GroupType group_types[] = {
-	{N_("None"), nullptr},
-	{N_("RGB Red"), group_rgb_red},
-	{N_("RGB Green"), group_rgb_green},
-	{N_("RGB Blue"), group_rgb_blue},
-	{N_("RGB Grayscale"), group_rgb_grayscale},
-	{N_("HSL Hue"), group_hsl_hue},
-	{N_("HSL Saturation"), group_hsl_saturation},
-	{N_("HSL Lightness"), group_hsl_lightness},
-	{N_("Lab Lightness"), group_lab_lightness},
-	{N_("Lab A"), group_lab_a},
-	{N_("Lab B"), group_lab_b},
-	{N_("LCh Lightness"), group_lch_lightness},
-	{N_("LCh Chroma"), group_lch_chroma},
-	{N_("LCh Hue"), group_lch_hue},
+	{N_("None"), nullptr, nullptr},
+	{N_("RGB Red"), nullptr, group_rgb_red},
+	{N_("RGB Green"), nullptr, group_rgb_green},
+	{N_("RGB Blue"), nullptr, group_rgb_blue},
+	{N_("RGB Grayscale"), nullptr, group_rgb_grayscale},
+	{N_("HSL Hue"), color_batch_rgb_to_hsl, group_hsl_hue},
+	{N_("HSL Saturation"), color_batch_rgb_to_hsl, group_hsl_saturation},
+	{N_("HSL Lightness"), color_batch_rgb_to_hsl, group_hsl_lightness},
+	{N_("Lab Lightness"), color_batch_rgb_to_lab_d50, group_lab_lightness},
+	{N_("Lab A"), color_batch_rgb_to_lab_d50, group_lab_a},
+	{N_("Lab B"), color_batch_rgb_to_lab_d50, group_lab_b},
+	{N_("LCh Lightness"), color_batch_rgb_to_lch_d50, group_lch_lightness},
+	{N_("LCh Chroma"), color_batch_rgb_to_lch_d50, group_lch_chroma},
+	{N_("LCh Hue"), color_batch_rgb_to_lch_d50, group_lch_hue},
 };
 
-
+/**
+ * Convert all colors at once into color space required by sort or group type and calculate their values.
+ */
+static void get_values(const vector<Color> &colors, ColorSpaceConversion convert, double (*get_value)(const Color *color), vector<double> &values)
+{
+	vector<Color> converted;
+	if (convert && !colors.empty()){
+		converted.resize(colors.size());
+		ColorSpan *span = color_span_new(colors.size());
+		color_span_load(&colors.front(), colors.size(), span);
+		convert(span, span);
+		color_span_store(span, &converted.front());
+		color_span_destroy(span);
+	}else{
+		converted = colors;
+	}
+	values.resize(colors.size());
+	for (size_t i = 0; i < colors.size(); i++){
+		values[i] = get_value(&converted[i]);
+	}
+}
 
 typedef struct Node{
 	uint32_t n_values;
@@ -458,48 +448,47 @@ static void calc(DialogSortArgs *args, bool preview, int limit){
 	const GroupType *group = &group_types[group_type];
 	const SortType *sort = &sort_types[sort_type];
 
-	Color in;
+	vector<ColorObject*> color_objects;
+	vector<Color> colors;
+	int tmp_limit = limit;
+	for (ColorList::iter i = args->selected_color_list->colors.begin(); i != args->selected_color_list->colors.end(); ++i){
+		color_objects.push_back(*i);
+		colors.push_back((*i)->getColor());
+		if (preview){
+			if (tmp_limit <= 0)
+				break;
+			tmp_limit--;
+		}
+	}
+
+	vector<double> sort_values, group_values;
+	get_values(colors, sort->convert, sort->get_value, sort_values);
+
 	Node *group_nodes = node_new(0);
 	Range range;
 	range.x = 0;
 	range.w = 1;
-	int tmp_limit = limit;
 	if (group->get_group){
-		for (ColorList::iter i = args->selected_color_list->colors.begin(); i != args->selected_color_list->colors.end(); ++i){
-			in = (*i)->getColor();
-			node_update(group_nodes, &range, group->get_group(&in), 8);
-			if (preview){
-				if (tmp_limit <= 0)
-					break;
-				tmp_limit--;
-			}
+		get_values(colors, group->convert, group->get_group, group_values);
+		for (size_t i = 0; i < group_values.size(); i++){
+			node_update(group_nodes, &range, group_values[i], 8);
 		}
 	}
 
 	node_reduce(group_nodes, group_sensitivity / 100.0, max_groups);
 
-	tmp_limit = limit;
-	for (ColorList::iter i = args->selected_color_list->colors.begin(); i != args->selected_color_list->colors.end(); ++i){
-		in = (*i)->getColor();
-
+	for (size_t i = 0; i < color_objects.size(); i++){
 		uintptr_t node_ptr = 0;
 		if (group->get_group){
-			node_ptr = reinterpret_cast<uintptr_t>(node_find(group_nodes, &range, group->get_group(&in)));
-		}
-		grouped_sorted_colors[node_ptr].insert(std::pair<double, ColorObject*>(sort->get_value(&in), *i));
-
-		if (preview){
-			if (tmp_limit <= 0)
-				break;
-			tmp_limit--;
+			node_ptr = reinterpret_cast<uintptr_t>(node_find(group_nodes, &range, group_values[i]));
 		}
+		grouped_sorted_colors[node_ptr].insert(std::pair<double, ColorObject*>(sort_values[i], color_objects[i]));
 	}
 
 	node_delete(group_nodes);
 
 	for (GroupedSortedColors::iterator i = grouped_sorted_colors.begin(); i != grouped_sorted_colors.end(); ++i){
-		in = (*(*i).second.begin()).second->getColor();
-		sorted_groups.insert(std::pair<double, uintptr_t>(sort->get_value(&in), (*i).first));
+		sorted_groups.insert(std::pair<double, uintptr_t>((*(*i).second.begin()).first, (*i).first));
 	}
 
 	if (reverse_groups){